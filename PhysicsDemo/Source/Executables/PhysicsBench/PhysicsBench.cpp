@@ -0,0 +1,1875 @@
+#include "Math/Camera.h"
+#include "Math/Geometry.h"
+#include "Math/MathTypes.h"
+#include "Math/Random.h"
+
+#include "Systems/Entity.h"
+#include "Systems/Collision.h"
+#include "Systems/ColliderTree.h"
+#include "Systems/Components.h"
+#include "Systems/Constraints.h"
+#include "Systems/Contacts.h"
+#include "Systems/Islands.h"
+#include "Systems/Kernels.h"
+#include "Systems/RenderSnapshot.h"
+#include "Systems/Simulation.h"
+#include "Systems/Worlds.h"
+
+#include "Platform/CommandLine.h"
+#include "Platform/CpuFeatures.h"
+#include "Platform/JobSystem.h"
+#include "Platform/StepScheduler.h"
+#include "Platform/TripleBuffer.h"
+
+#include "Visual/GeometryGraph.h"
+#include "Visual/VertexCache.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <ctime>
+#include <functional>
+#include <limits>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+namespace jm::Bench
+{
+	constexpr f32 FixedTick_Period = 1.f / 120.f; //s
+	constexpr math::vector3_f32 wind_force = { 0.f, 0.f, 0.f };
+	constexpr math::vector3_f32 wall_boundaries_min = { -1000.f, 0.f, -1000.f };
+	constexpr math::vector3_f32 wall_boundaries_max = { 1000.f, 2000.f, 1000.f };
+	constexpr math::vector3_f32 scatter_min = { -50.f, 1.f, -50.f };
+	constexpr math::vector3_f32 scatter_max = { 50.f, 100.f, 50.f };
+
+	struct Parameters
+	{
+		std::string Filter{};
+		std::string OutputPath{};
+		f64 MinTime = 0.2; //s per benchmark
+		uSize Threads = 1;
+		bool Help = false;
+	};
+
+	struct Scene
+	{
+		cstring Name;
+		uSize Size;
+		uSize Bodies;
+		std::function<void(entity_registry&)> Create;
+		bool Linked = false; //every body is held by constraints and moves in the constraint solve
+	};
+
+	//state a stage needs that is not part of the measured work
+	struct Fixture
+	{
+		entity_registry& Registry;
+		Platform::JobSystem& Jobs;
+		collider_set Colliders{};
+		std::vector<math::ray3<f32>> Rays{};
+		uSize RayIndex = 0;
+		render_snapshot Snapshot{};
+		render_instances Instances{};
+		uSize Size = 0; //the scene's size, for stages that make their own work instead of reading the registry
+	};
+
+	struct Stage
+	{
+		cstring Name;
+		std::function<void(Fixture&)> Setup;
+		std::function<void(Fixture&)> Run;
+		uSize MaxBodies = std::numeric_limits<uSize>::max(); //skip scenes too large for quadratic stages
+		cstring Scene = nullptr; //only run on scenes of this name, scenes without bodies are only run by stages naming them
+		bool FreeBodies = false; //skip linked scenes, the stage would time an empty pass
+	};
+
+	struct Result
+	{
+		std::string Name;
+		cstring Stage;
+		cstring Scene;
+		uSize Size;
+		uSize Bodies;
+		uSize Iterations;
+		f64 NanosecondsPerIteration;
+		f64 NanosecondsPerBody;
+	};
+
+	std::vector<Scene> MakeScenes()
+	{
+		std::vector<Scene> scenes;
+		for (uSize count : { 1000, 10000 })
+		{
+			scenes.push_back({ "spheres", count, count, [count](entity_registry& registry) { CreateSphereWorld(registry, count, scatter_min, scatter_max); } });
+		}
+		for (uSize size : { 32, 100 })
+		{
+			scenes.push_back({ "cloth", size, size * size, [size](entity_registry& registry) { CreateClothWorld(registry, size, { -0.5f * size, 500.f, -0.5f * size }); }, true });
+		}
+		for (uSize length : { 100, 1000 })
+		{
+			scenes.push_back({ "ropes", length, 10 * length, [length](entity_registry& registry) { CreateRopeWorld(registry, 10, length, { -10.f, 1.f, 0.f }); }, true });
+		}
+		for (uSize count : { 1000, 10000 })
+		{
+			scenes.push_back({ "mixed", count, count, [count](entity_registry& registry) { CreateMixedWorld(registry, count, scatter_min, scatter_max); } });
+		}
+		for (uSize count : { 1000, 10000, 100000, 1000000 })
+		{
+			//constant density, so broadphase cost should grow with the count and not with crowding
+			const f32 halfWidth = std::cbrt(f32(count));
+			scenes.push_back({ "sphere_field", count, count, [count, halfWidth](entity_registry& registry)
+				{
+					CreateSphereWorld(registry, count, { -halfWidth, 1.f, -halfWidth }, { halfWidth, 1.f + 2.f * halfWidth, halfWidth });
+				} });
+		}
+		for (uSize count : { 1000, 10000 })
+		{
+			//one sphere per unit cube, dense enough that most spheres touch several others
+			const f32 halfWidth = 0.5f * std::cbrt(f32(count));
+			scenes.push_back({ "pile", count, count, [count, halfWidth](entity_registry& registry)
+				{
+					CreateSphereWorld(registry, count, { -halfWidth, 1.f, -halfWidth }, { halfWidth, 1.f + 2.f * halfWidth, halfWidth });
+				} });
+		}
+		for (uSize ropes : { 100, 1000 })
+		{
+			//disconnected ropes, every one is its own island
+			scenes.push_back({ "rope_field", ropes, 20 * ropes, [ropes](entity_registry& registry) { CreateRopeWorld(registry, ropes, 20, { -f32(ropes), 1.f, 0.f }); }, true });
+		}
+		for (uSize columns : { 16, 64 })
+		{
+			//four high stacks spaced apart, each settles into its own island
+			scenes.push_back({ "stacks", columns, 4 * columns * columns, [columns](entity_registry& registry)
+				{
+					CreateStackWorld(registry, columns, 4, { -f32(columns), 0.f, -f32(columns) });
+				} });
+		}
+		for (uSize subdivisions : { 16, 64, 256 })
+		{
+			//no bodies, the size is how many sections each side of the cube mesh is split into
+			scenes.push_back({ "cube", subdivisions, 0, [](entity_registry&) {} });
+		}
+		return scenes;
+	}
+
+	void Step(entity_registry& registry, collider_set& colliders)
+	{
+		colliders = build_colliders(registry);
+		resolve_collisions(registry, colliders, FixedTick_Period);
+		integrate(registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+	}
+
+	//the glm integration the angular kernels replaced, one body at a time through a rotation matrix built from angle and axis
+	void IntegrateAngularReference(entity_registry& registry, f32 delta_time)
+	{
+		const f32 damping = std::exp(-0.06f * delta_time); //the angular damping rate in Simulation.cpp
+		for (auto&& [entity, spatial, angular, pinned] : registry.view<spatial3_component, rotational_body3_component, pinned_component>(entt::exclude<sleeping_component>).each())
+		{
+			if (pinned.isPinned)
+			{
+				continue;
+			}
+
+			const math::matrix33_f32 rotationMatrix = math::rotation_matrix3(spatial.orientation);
+			const math::matrix33_f32 inverse_inertia_world = rotationMatrix * math::diagonal_matrix3(angular.inverse_inertia) * transpose(rotationMatrix);
+			const math::vector3_f32 acceleration = inverse_inertia_world * angular.applied_torque;
+			math::euler_integration(angular.velocity, acceleration, delta_time);
+			angular.velocity *= damping;
+			const math::quaternion_f32 spin = math::get_spin(spatial.orientation, angular.velocity);
+			math::euler_integration(spatial.orientation, spin, delta_time);
+			spatial.orientation = normalize(spatial.orientation);
+		}
+	}
+
+	render_view GetView(math::camera3<f32> const& camera)
+	{
+		return make_render_view(camera.get_perspective_transform(), camera.get_view_transform());
+	}
+
+	//from above the middle of a scene towards one corner, so most of it is out of view
+	render_view const& GetCornerView()
+	{
+		static const render_view view = GetView(math::camera3<f32>({ 0.f, 5.f, 0.f }, { -1.f, 4.f, -1.f }, 45.f, 16.f / 9.f));
+		return view;
+	}
+
+	std::vector<Stage> MakeStages()
+	{
+		auto noSetup = [](Fixture&) {};
+		auto buildColliders = [](Fixture& fixture) { fixture.Colliders = build_colliders(fixture.Registry); };
+
+		return {
+			{ "linear", noSetup, [](Fixture& fixture)
+				{
+					integrate_linear(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+				}, std::numeric_limits<uSize>::max(), nullptr, true },
+			{ "linear_scalar", [](Fixture& fixture) { get_linear_batch(fixture.Registry).level = Platform::SimdLevel::Scalar; }, [](Fixture& fixture)
+				{
+					integrate_linear(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+				}, std::numeric_limits<uSize>::max(), nullptr, true },
+			{ "linear_sse4", [](Fixture& fixture) { get_linear_batch(fixture.Registry).level = Platform::SimdLevel::SSE4; }, [](Fixture& fixture)
+				{
+					integrate_linear(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+				}, std::numeric_limits<uSize>::max(), nullptr, true },
+			{ "linear_verlet", noSetup, [](Fixture& fixture)
+				{
+					integrate_linear<math::position_verlet>(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+				}, std::numeric_limits<uSize>::max(), nullptr, true },
+			{ "linear_rk4", noSetup, [](Fixture& fixture)
+				{
+					integrate_linear<math::runge_kutta4>(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+				}, std::numeric_limits<uSize>::max(), nullptr, true },
+			{ "angular", noSetup, [](Fixture& fixture)
+				{
+					integrate_angular(fixture.Registry, FixedTick_Period);
+				} },
+			{ "angular_scalar", [](Fixture& fixture) { get_angular_batch(fixture.Registry).level = Platform::SimdLevel::Scalar; }, [](Fixture& fixture)
+				{
+					integrate_angular(fixture.Registry, FixedTick_Period);
+				} },
+			{ "angular_reference", noSetup, [](Fixture& fixture)
+				{
+					IntegrateAngularReference(fixture.Registry, FixedTick_Period);
+				} },
+			{ "constraints", noSetup, [](Fixture& fixture)
+				{
+					relax_constraints(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+				} },
+			{ "constraints_iterations", [](Fixture& fixture)
+				{
+					//the cost of the old relaxation, one step of twelve iterations, against the default twelve substeps of one
+					constraint_store& store = get_constraint_store(fixture.Registry);
+					store.substeps = 1;
+					store.iterations = 12;
+				}, [](Fixture& fixture)
+				{
+					relax_constraints(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+				} },
+			{ "constraints_islands", [](Fixture& fixture) { set_island_jobs(fixture.Registry, &fixture.Jobs); }, [](Fixture& fixture)
+				{
+					relax_constraints(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+				} },
+			{ "capture_snapshot", [](Fixture& fixture) { store_previous_transforms(fixture.Registry); }, [](Fixture& fixture)
+				{
+					//what the simulation thread adds to each tick to hand a frame over
+					capture_render_snapshot(fixture.Registry, fixture.Snapshot);
+				} },
+			{ "build_instances", [](Fixture& fixture)
+				{
+					store_previous_transforms(fixture.Registry);
+					capture_render_snapshot(fixture.Registry, fixture.Snapshot);
+				}, [](Fixture& fixture)
+				{
+					//what the render thread does with a snapshot before a frame's instanced draws
+					build_render_instances(fixture.Snapshot, 0.5f, fixture.Instances);
+				} },
+			{ "build_instances_culled", [](Fixture& fixture)
+				{
+					store_previous_transforms(fixture.Registry);
+					capture_render_snapshot(fixture.Registry, fixture.Snapshot);
+				}, [](Fixture& fixture)
+				{
+					build_render_instances(fixture.Snapshot, 0.5f, GetCornerView(), fixture.Instances);
+				} },
+			{ "build_colliders", noSetup, [](Fixture& fixture)
+				{
+					fixture.Colliders = build_colliders(fixture.Registry);
+				} },
+			{ "broadphase_all_pairs", buildColliders, [](Fixture& fixture)
+				{
+					volatile uSize pairs = find_candidates_all_pairs(fixture.Colliders).sphere_spheres.size();
+					static_cast<void>(pairs);
+				}, 100000 },
+			{ "broadphase_spatial_hash", buildColliders, [](Fixture& fixture)
+				{
+					volatile uSize pairs = find_candidates_spatial_hash(fixture.Colliders).sphere_spheres.size();
+					static_cast<void>(pairs);
+				} },
+			{ "broadphase_dynamic_tree", [](Fixture& fixture)
+				{
+					fixture.Colliders = build_colliders(fixture.Registry);
+					update_collider_tree(fixture.Registry, get_collider_tree(fixture.Registry)); //initial insertion is not part of the tick
+				}, [](Fixture& fixture)
+				{
+					volatile uSize pairs = find_candidates_dynamic_tree(fixture.Registry, fixture.Colliders).sphere_spheres.size();
+					static_cast<void>(pairs);
+				} },
+			{ "tree_tick", [](Fixture& fixture)
+				{
+					update_collider_tree(fixture.Registry, get_collider_tree(fixture.Registry));
+				}, [](Fixture& fixture)
+				{
+					//bodies move every iteration so refits and reinsertions are measured too
+					integrate_linear(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+					collider_tree& tree = get_collider_tree(fixture.Registry);
+					update_collider_tree(fixture.Registry, tree);
+					volatile uSize pairs = find_tree_pairs(tree).size();
+					static_cast<void>(pairs);
+				} },
+			{ "broadphase_sweep_and_prune", [](Fixture& fixture)
+				{
+					fixture.Colliders = build_colliders(fixture.Registry);
+					find_candidates_sweep_and_prune(fixture.Registry, fixture.Colliders); //initial sort is not part of the tick
+				}, [](Fixture& fixture)
+				{
+					volatile uSize pairs = find_candidates_sweep_and_prune(fixture.Registry, fixture.Colliders).sphere_spheres.size();
+					static_cast<void>(pairs);
+				}, 100000 }, //a single axis sweep is quadratic in the slab width on uniform 3d fields
+			{ "sap_tick", [](Fixture& fixture)
+				{
+					fixture.Colliders = build_colliders(fixture.Registry);
+					find_candidates_sweep_and_prune(fixture.Registry, fixture.Colliders);
+				}, [](Fixture& fixture)
+				{
+					//bodies move every iteration so the insertion sort has swaps to do
+					integrate_linear(fixture.Registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+					fixture.Colliders = build_colliders(fixture.Registry);
+					volatile uSize pairs = find_candidates_sweep_and_prune(fixture.Registry, fixture.Colliders).sphere_spheres.size();
+					static_cast<void>(pairs);
+				}, 100000 }, //a single axis sweep is quadratic in the slab width on uniform 3d fields
+			{ "resolve_collisions", buildColliders, [](Fixture& fixture)
+				{
+					resolve_collisions(fixture.Registry, fixture.Colliders, FixedTick_Period);
+				} },
+			{ "step", noSetup, [](Fixture& fixture)
+				{
+					Step(fixture.Registry, fixture.Colliders);
+				} },
+			{ "step_islands", [](Fixture& fixture) { set_island_jobs(fixture.Registry, &fixture.Jobs); }, [](Fixture& fixture)
+				{
+					Step(fixture.Registry, fixture.Colliders);
+				} },
+			{ "settled_step", [](Fixture& fixture)
+				{
+					//two seconds is enough for resting scenes to fall asleep, the rest keep moving
+					for (int tick = 0; tick < 240; ++tick)
+					{
+						Step(fixture.Registry, fixture.Colliders);
+					}
+				}, [](Fixture& fixture)
+				{
+					Step(fixture.Registry, fixture.Colliders);
+				}, 100000 },
+			{ "ray_cast", [](Fixture& fixture)
+				{
+					fixture.Colliders = build_colliders(fixture.Registry);
+					fixture.Rays.resize(64);
+					for (auto& ray : fixture.Rays)
+					{
+						ray.origin = 200.f * math::random::unit_sphere<f32>();
+						ray.direction = normalize(-ray.origin + 10.f * math::random::unit_ball<f32>());
+					}
+				}, [](Fixture& fixture)
+				{
+					math::ray3<f32> const& ray = fixture.Rays[fixture.RayIndex++ % fixture.Rays.size()];
+					volatile bool hit = ray_cast(fixture.Colliders, ray).has_value();
+					static_cast<void>(hit);
+				} },
+			{ "ray_cast_tree", [](Fixture& fixture)
+				{
+					update_collider_tree(fixture.Registry, get_collider_tree(fixture.Registry)); //initial insertion is not part of the pick
+					fixture.Rays.resize(64);
+					for (auto& ray : fixture.Rays)
+					{
+						ray.origin = 200.f * math::random::unit_sphere<f32>();
+						ray.direction = normalize(-ray.origin + 10.f * math::random::unit_ball<f32>());
+					}
+				}, [](Fixture& fixture)
+				{
+					math::ray3<f32> const& ray = fixture.Rays[fixture.RayIndex++ % fixture.Rays.size()];
+					volatile bool hit = ray_cast(fixture.Registry, ray).has_value();
+					static_cast<void>(hit);
+				} },
+			{ "subdivide_cube", noSetup, [](Fixture& fixture)
+				{
+					//the cube mesh the renderer generates, with every side split into Size sections
+					volatile u32 triangles = Visual::Subdivide(Visual::CubeGeometry(2.f), fixture.Size, false).GetTriangleCount();
+					static_cast<void>(triangles);
+				}, std::numeric_limits<uSize>::max(), "cube" },
+		};
+	}
+
+	u64 PairKey(collider_pair const& pair)
+	{
+		return (u64(pair.first) << 32) | pair.second;
+	}
+
+	std::vector<u64> SortedPairKeys(std::vector<collider_pair> const& pairs)
+	{
+		std::vector<u64> result;
+		result.reserve(pairs.size());
+		for (collider_pair const& pair : pairs)
+		{
+			result.push_back(PairKey(pair));
+		}
+		std::sort(result.begin(), result.end());
+		return result;
+	}
+
+	bool ContainsPairKey(std::vector<u64> const& sortedKeys, u64 value)
+	{
+		return std::binary_search(sortedKeys.begin(), sortedKeys.end(), value);
+	}
+
+	//counts candidate pairs the reference does not report, and reference pairs the narrowphase would hit that the candidates miss
+	void CountDisagreements(collider_set const& colliders, collision_candidates const& reference, collision_candidates const& candidates, uSize& extra, uSize& missed)
+	{
+		const std::vector<u64> referenceSpheres = SortedPairKeys(reference.sphere_spheres);
+		const std::vector<u64> referenceBoxes = SortedPairKeys(reference.sphere_boxes);
+		const std::vector<u64> referenceBoxPairs = SortedPairKeys(reference.box_boxes);
+		const std::vector<u64> candidateSpheres = SortedPairKeys(candidates.sphere_spheres);
+		const std::vector<u64> candidateBoxes = SortedPairKeys(candidates.sphere_boxes);
+		const std::vector<u64> candidateBoxPairs = SortedPairKeys(candidates.box_boxes);
+
+		for (u64 value : candidateSpheres)
+		{
+			extra += !ContainsPairKey(referenceSpheres, value);
+		}
+		for (u64 value : candidateBoxes)
+		{
+			extra += !ContainsPairKey(referenceBoxes, value);
+		}
+		for (u64 value : candidateBoxPairs)
+		{
+			extra += !ContainsPairKey(referenceBoxPairs, value);
+		}
+		for (collider_pair const& pair : reference.sphere_spheres)
+		{
+			missed += math::intersects(colliders.spheres[pair.first].sphere, colliders.spheres[pair.second].sphere) && !ContainsPairKey(candidateSpheres, PairKey(pair));
+		}
+		for (collider_pair const& pair : reference.sphere_boxes)
+		{
+			missed += math::intersects(colliders.spheres[pair.first].sphere, colliders.boxes[pair.second].box) && !ContainsPairKey(candidateBoxes, PairKey(pair));
+		}
+		for (collider_pair const& pair : reference.box_boxes)
+		{
+			contact_manifold manifold;
+			missed += collide(colliders.boxes[pair.first].box, colliders.boxes[pair.second].box, manifold) && !ContainsPairKey(candidateBoxPairs, PairKey(pair));
+		}
+	}
+
+	//every broadphase may only report pairs the all pairs reference reports, and must report every pair the narrowphase would hit
+	bool VerifyCandidates(cstring name, collider_set const& colliders, collision_candidates const& candidates)
+	{
+		uSize extra = 0;
+		uSize missed = 0;
+		for (std::vector<collider_pair> const* pairs : { &candidates.sphere_spheres, &candidates.sphere_boxes, &candidates.box_boxes })
+		{
+			const std::vector<u64> keys = SortedPairKeys(*pairs);
+			extra += std::adjacent_find(keys.begin(), keys.end()) != keys.end();
+		}
+		CountDisagreements(colliders, find_candidates_all_pairs(colliders), candidates, extra, missed);
+
+		if (extra != 0 || missed != 0)
+		{
+			std::fprintf(stderr, "%s broadphase disagrees with all_pairs (%zu duplicate or unknown pairs, %zu colliding pairs missed)!\n", name, extra, missed);
+		}
+		return extra == 0 && missed == 0;
+	}
+
+	//the tree has to hold exactly one leaf per live collider, and agree with the stateless hash on every pair the narrowphase would hit
+	//the hash bounds boxes by spheres and the tree by AABBs, so the tree may only report a subset of the hash pairs
+	bool VerifyTreeMatchesHash(cstring name, entity_registry& registry, collider_set const& colliders)
+	{
+		const collision_candidates tree = find_candidates_dynamic_tree(registry, colliders);
+		uSize extra = 0;
+		uSize missed = 0;
+		CountDisagreements(colliders, find_candidates_spatial_hash(colliders), tree, extra, missed);
+
+		uSize leaves = 0;
+		uSize deadLeaves = 0;
+		for (collider_tree_node const& node : get_collider_tree(registry).nodes)
+		{
+			if (node.height == 0)
+			{
+				++leaves;
+				deadLeaves += !registry.valid(node.entity) || !registry.all_of<collidable_component>(node.entity);
+			}
+		}
+
+		bool passed = VerifyCandidates(name, colliders, tree);
+		if (leaves != colliders.spheres.size() + colliders.boxes.size() || deadLeaves != 0)
+		{
+			std::fprintf(stderr, "%s holds %zu leaves (%zu dead) for %zu colliders!\n", name, leaves, deadLeaves, colliders.spheres.size() + colliders.boxes.size());
+			passed = false;
+		}
+		if (extra != 0 || missed != 0)
+		{
+			std::fprintf(stderr, "%s disagrees with spatial_hash (%zu pairs the hash does not report, %zu colliding pairs missed)!\n", name, extra, missed);
+			passed = false;
+		}
+		return passed;
+	}
+
+	bool VerifyBroadphases()
+	{
+		entity_registry registry;
+		CreateMixedWorld(registry, 4000, { -20.f, 1.f, -20.f }, { 20.f, 41.f, 20.f });
+		const collider_set colliders = build_colliders(registry);
+
+		bool matches = VerifyCandidates("spatial_hash", colliders, find_candidates_spatial_hash(colliders));
+		matches = VerifyCandidates("dynamic_tree", colliders, find_candidates_dynamic_tree(registry, colliders)) && matches;
+		matches = VerifyCandidates("sweep_and_prune", colliders, find_candidates_sweep_and_prune(registry, colliders)) && matches;
+
+		//move everything, the tree has to reinsert what left its fat bounds and the sweep re-sort, and both still agree
+		for (int tick = 0; tick < 30; ++tick)
+		{
+			integrate_linear(registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+			integrate_angular(registry, FixedTick_Period);
+		}
+		const collider_set moved = build_colliders(registry);
+		matches = VerifyCandidates("dynamic_tree (moved)", moved, find_candidates_dynamic_tree(registry, moved)) && matches;
+		matches = VerifyCandidates("sweep_and_prune (moved)", moved, find_candidates_sweep_and_prune(registry, moved)) && matches;
+
+		//destroyed bodies must leave the tree and recycled entity slots must not alias their old proxies
+		std::vector<entity_id> doomed;
+		for (entity_id entity : registry.view<collidable_component>())
+		{
+			if (uSize(entt::to_entity(entity)) % 7 == 0)
+			{
+				doomed.push_back(entity);
+			}
+		}
+		registry.destroy(doomed.begin(), doomed.end());
+		uSize stripped = 0;
+		for (entity_id entity : registry.view<collidable_component, sphere_shape_component>())
+		{
+			if (stripped++ % 11 == 0)
+			{
+				registry.remove<collidable_component>(entity);
+			}
+		}
+		const collider_set culled = build_colliders(registry);
+		matches = VerifyTreeMatchesHash("dynamic_tree (destroyed)", registry, culled) && matches;
+		matches = VerifyCandidates("sweep_and_prune (destroyed)", culled, find_candidates_sweep_and_prune(registry, culled)) && matches;
+
+		CreateMixedWorld(registry, doomed.size(), { -20.f, 1.f, -20.f }, { 20.f, 41.f, 20.f });
+		const collider_set recreated = build_colliders(registry);
+		matches = VerifyTreeMatchesHash("dynamic_tree (recreated)", registry, recreated) && matches;
+		matches = VerifyCandidates("sweep_and_prune (recreated)", recreated, find_candidates_sweep_and_prune(registry, recreated)) && matches;
+
+		//a row along x turned into a row along z has to move the sweep onto z
+		entity_registry row;
+		CreateSphereWorld(row, 1000, { -200.f, 1.f, -2.f }, { 200.f, 5.f, 2.f });
+		const collider_set alongX = build_colliders(row);
+		matches = VerifyCandidates("sweep_and_prune (row)", alongX, find_candidates_sweep_and_prune(row, alongX)) && matches;
+		for (auto&& [entity, spatial] : row.view<spatial3_component>().each())
+		{
+			std::swap(spatial.position.x, spatial.position.z);
+		}
+		const collider_set alongZ = build_colliders(row);
+		matches = VerifyCandidates("sweep_and_prune (turned row)", alongZ, find_candidates_sweep_and_prune(row, alongZ)) && matches;
+		if (row.ctx().get<sweep_and_prune>().axis != 2)
+		{
+			std::fprintf(stderr, "sweep_and_prune kept axis %d after the colliders turned onto z!\n", row.ctx().get<sweep_and_prune>().axis);
+			matches = false;
+		}
+		return matches;
+	}
+
+	//overlap and ray queries against going over every leaf and every collider, then all three walks down a tree far taller than balancing allows
+	bool VerifyTreeQueries()
+	{
+		entity_registry registry;
+		CreateMixedWorld(registry, 4000, { -20.f, 1.f, -20.f }, { 20.f, 41.f, 20.f });
+		const collider_set colliders = build_colliders(registry);
+		find_candidates_dynamic_tree(registry, colliders); //fills the tree and points its proxies at these colliders
+		collider_tree& tree = get_collider_tree(registry);
+
+		uSize overlapMismatches = 0;
+		for (int query = 0; query < 200; ++query)
+		{
+			const math::vector3_f32 centre = math::vector3_f32{ 0.f, 21.f, 0.f } + 25.f * math::random::unit_ball<f32>();
+			const math::vector3_f32 half = { math::random::scalar(0.5f, 3.f), math::random::scalar(0.5f, 3.f), math::random::scalar(0.5f, 3.f) };
+			const math::aabb3<f32> bounds{ centre - half, centre + half };
+			std::vector<entity_id> found;
+			query_overlaps(tree, bounds, [&found](entity_id entity) { found.push_back(entity); });
+			std::vector<entity_id> expected;
+			for (collider_tree_node const& node : tree.nodes)
+			{
+				if (node.height == 0 && math::intersects(node.bounds, bounds))
+				{
+					expected.push_back(node.entity);
+				}
+			}
+			std::sort(found.begin(), found.end());
+			std::sort(expected.begin(), expected.end());
+			overlapMismatches += found != expected;
+		}
+
+		uSize rayMismatches = 0;
+		uSize hits = 0;
+		for (int query = 0; query < 500; ++query)
+		{
+			math::ray3<f32> ray;
+			ray.origin = query % 2 == 0 ? 60.f * math::random::unit_sphere<f32>() : math::vector3_f32{ 0.f, 21.f, 0.f } + 20.f * math::random::unit_ball<f32>();
+			ray.direction = normalize(math::vector3_f32{ 0.f, 21.f, 0.f } - ray.origin + 15.f * math::random::unit_ball<f32>());
+			const entity_pick throughTree = ray_cast(registry, ray);
+			const entity_pick everySphere = ray_cast(colliders, ray);
+			hits += everySphere.has_value();
+			rayMismatches += throughTree.has_value() != everySphere.has_value() ||
+				(everySphere && (throughTree->entity != everySphere->entity || throughTree->offset != everySphere->offset));
+		}
+
+		bool passed = true;
+		if (overlapMismatches != 0 || rayMismatches != 0 || hits == 0)
+		{
+			std::fprintf(stderr, "the tree answered %zu of 200 overlap queries and %zu of 500 ray casts (%zu hits) differently from going over everything!\n", overlapMismatches, rayMismatches, hits);
+			passed = false;
+		}
+
+		//a tick that creates and destroys nothing keeps the collider order, so the proxies are not pointed at the set again
+		const size_t reindexes = tree.collider_reindexes;
+		find_candidates_dynamic_tree(registry, build_colliders(registry));
+		if (tree.collider_reindexes != reindexes)
+		{
+			std::fprintf(stderr, "the tree reindexed %zu times for a collider set that did not change!\n", tree.collider_reindexes - reindexes);
+			passed = false;
+		}
+
+		//a sphere created after the last tick is picked before the broadphase has seen it, and not once it is destroyed
+		const entity_id added = registry.create();
+		registry.emplace<spatial3_component>(added, math::vector3_f32{ 0.f, 200.f, 0.f }, math::quaternion_f32(1.f, 0.f, 0.f, 0.f));
+		registry.emplace<sphere_shape_component>(added, 2.f);
+		registry.emplace<collidable_component>(added);
+		const math::ray3<f32> down{ { 0.f, 300.f, 0.f }, { 0.f, -1.f, 0.f } };
+		const entity_pick addedPick = ray_cast(registry, down);
+		registry.destroy(added);
+		const entity_pick destroyedPick = ray_cast(registry, down);
+		if (!addedPick || addedPick->entity != added || (destroyedPick && destroyedPick->entity == added))
+		{
+			std::fprintf(stderr, "a ray cast missed a sphere created since the last tick, or hit it after it was destroyed!\n");
+			passed = false;
+		}
+
+		//a chain of 100 branches, each with a leaf on the left, so every walk has to hold more than 64 nodes at once
+		constexpr u32 chainLeaves = 101;
+		collider_tree chain;
+		for (u32 idx = 0; idx < chainLeaves; ++idx)
+		{
+			collider_tree_node leaf;
+			leaf.bounds = { { f32(idx), 0.f, 0.f }, { f32(idx) + 1.f, 1.f, 1.f } };
+			leaf.entity = static_cast<entity_id>(idx);
+			chain.nodes.push_back(leaf);
+		}
+		u32 below = chainLeaves - 1;
+		for (u32 idx = chainLeaves - 1; idx-- > 0;)
+		{
+			collider_tree_node branch;
+			branch.left = below;
+			branch.right = idx;
+			branch.bounds = math::merge(chain.nodes[below].bounds, chain.nodes[idx].bounds);
+			branch.height = chain.nodes[below].height + 1;
+			chain.nodes[below].parent = static_cast<u32>(chain.nodes.size());
+			chain.nodes[idx].parent = static_cast<u32>(chain.nodes.size());
+			below = static_cast<u32>(chain.nodes.size());
+			chain.nodes.push_back(branch);
+		}
+		chain.root = below;
+		for (u32 idx = 0; idx < chainLeaves; ++idx)
+		{
+			chain.moving_leaves.push_back(idx);
+		}
+
+		uSize overlapped = 0;
+		query_overlaps(chain, chain.nodes[chain.root].bounds, [&overlapped](entity_id) { ++overlapped; });
+		uSize crossed = 0;
+		query_ray(chain, { { -1.f, 0.5f, 0.5f }, { 1.f, 0.f, 0.f } }, math::infinity<f32>(), [&crossed](entity_id, f32 t_max) { ++crossed; return t_max; });
+		const uSize touching = find_tree_pairs(chain).size(); //neighbours share a face
+		if (chain.nodes[chain.root].height != i32(chainLeaves - 1) || overlapped != chainLeaves || crossed != chainLeaves || touching != chainLeaves - 1)
+		{
+			std::fprintf(stderr, "a tree of height %d gave %zu overlaps, %zu ray leaves and %zu pairs, expected %u, %u and %u!\n", chain.nodes[chain.root].height, overlapped, crossed, touching, chainLeaves, chainLeaves, chainLeaves - 1);
+			passed = false;
+		}
+		return passed;
+	}
+
+	bool NearlyEqual(math::vector3_f32 const& a, math::vector3_f32 const& b, f32 tolerance)
+	{
+		return glm::all(glm::lessThanEqual(glm::abs(a - b), math::vector3_f32(tolerance)));
+	}
+
+	//a box resting face on on a wider one gives the four corners of the top box's face at the overlap depth, whichever way round the pair is,
+	//crossed edges give one point between them, and a sphere whose centre is inside a box leaves through the nearest face
+	bool VerifyManifolds()
+	{
+		constexpr f32 Tolerance = 1e-4f;
+		bool passed = true;
+		contact_manifold manifold;
+
+		//the top box is turned about y and sits 0.02 into the bottom one, its face fits inside the bottom box's face
+		const math::matrix33_f32 turned = math::quat_to_mat(math::angleAxis(0.5f, math::vector3_f32{ 0.f, 1.f, 0.f }));
+		const math::box3<f32> bottom{ { 0.f, 0.f, 0.f }, { 1.f, 0.5f, 1.f }, math::matrix33_f32(1.f) };
+		const math::box3<f32> top{ { 0.2f, 0.98f, 0.1f }, { 0.5f, 0.5f, 0.5f }, turned };
+		for (bool swapped : { false, true })
+		{
+			const bool hit = swapped ? collide(top, bottom, manifold) : collide(bottom, top, manifold);
+			const math::vector3_f32 up = swapped ? math::vector3_f32{ 0.f, -1.f, 0.f } : math::vector3_f32{ 0.f, 1.f, 0.f };
+			uSize wrongPoints = 0;
+			for (u32 idx = 0; idx < manifold.point_count; ++idx)
+			{
+				contact_point const& point = manifold.points[idx];
+				const math::vector3_f32 local = glm::transpose(turned) * (point.position - top.position);
+				const bool corner = std::abs(std::abs(local.x) - 0.5f) < Tolerance && std::abs(std::abs(local.z) - 0.5f) < Tolerance;
+				const bool unique = std::count_if(manifold.points, manifold.points + manifold.point_count, [&](contact_point const& other) { return other.feature == point.feature; }) == 1;
+				wrongPoints += !corner || !unique || std::abs(point.depth - 0.02f) > Tolerance || std::abs(point.position.y - 0.49f) > Tolerance;
+			}
+			if (!hit || manifold.point_count != 4 || !NearlyEqual(manifold.normal, up, Tolerance) || wrongPoints != 0)
+			{
+				std::fprintf(stderr, "a box resting face on%s gave %u points (%zu wrong) along (%f, %f, %f)!\n", swapped ? " (swapped)" : "", manifold.point_count, wrongPoints, manifold.normal.x, manifold.normal.y, manifold.normal.z);
+				passed = false;
+			}
+		}
+
+		//a cube on its edge along z under a cube on its edge along x, 0.02 apart in overlap
+		const f32 halfDiagonal = 0.5f * std::sqrt(2.f);
+		const math::box3<f32> lower{ { 0.f, 0.f, 0.f }, math::vector3_f32{ 0.5f }, math::quat_to_mat(math::angleAxis(0.25f * math::pi<f32>(), math::vector3_f32{ 0.f, 0.f, 1.f })) };
+		const math::box3<f32> upper{ { 0.f, 2.f * halfDiagonal - 0.02f, 0.f }, math::vector3_f32{ 0.5f }, math::quat_to_mat(math::angleAxis(0.25f * math::pi<f32>(), math::vector3_f32{ 1.f, 0.f, 0.f })) };
+		if (!collide(lower, upper, manifold) || manifold.point_count != 1 || (manifold.points[0].feature & 0x80000000u) == 0 ||
+			!NearlyEqual(manifold.normal, { 0.f, 1.f, 0.f }, Tolerance) || std::abs(manifold.points[0].depth - 0.02f) > Tolerance ||
+			!NearlyEqual(manifold.points[0].position, { 0.f, halfDiagonal - 0.01f, 0.f }, Tolerance))
+		{
+			std::fprintf(stderr, "crossed edges gave %u points, the first %f deep with feature %08x, along (%f, %f, %f)!\n", manifold.point_count, manifold.points[0].depth, manifold.points[0].feature, manifold.normal.x, manifold.normal.y, manifold.normal.z);
+			passed = false;
+		}
+
+		//the centre is 0.15 below the box's local +y face and further from every other, the normal points from the sphere into the box
+		const math::matrix33_f32 tilted = math::quat_to_mat(math::angleAxis(0.7f, normalize(math::vector3_f32{ 1.f, 2.f, 3.f })));
+		const math::box3<f32> slab{ { 1.f, 2.f, 3.f }, { 1.f, 0.5f, 2.f }, tilted };
+		const math::sphere3<f32> inside{ slab.position + tilted * math::vector3_f32{ 0.3f, 0.35f, -0.5f }, 0.2f };
+		const math::vector3_f32 face = slab.position + tilted * math::vector3_f32{ 0.3f, 0.5f, -0.5f };
+		if (!collide(inside, slab, manifold) || manifold.point_count != 1 || !NearlyEqual(manifold.normal, -tilted[1], Tolerance) ||
+			std::abs(manifold.points[0].depth - 0.35f) > Tolerance || !NearlyEqual(manifold.points[0].position, face + 0.175f * tilted[1], Tolerance))
+		{
+			std::fprintf(stderr, "a sphere inside a box gave %u points %f deep along (%f, %f, %f)!\n", manifold.point_count, manifold.points[0].depth, manifold.normal.x, manifold.normal.y, manifold.normal.z);
+			passed = false;
+		}
+		return passed;
+	}
+
+	//a box dropped turned onto a pinned one comes to rest flat on top of it, which only the box against box manifold can do
+	bool VerifyBoxStacking()
+	{
+		entity_registry registry;
+		collider_set colliders;
+		auto add_box = [&registry](math::vector3_f32 const& position, math::quaternion_f32 const& orientation, bool pinned)
+			{
+				const entity_id entity = registry.create();
+				const math::vector3_f32 extents{ 0.5f };
+				registry.emplace<spatial3_component>(entity, position, orientation);
+				registry.emplace<linear_body3_component>(entity, math::vector3_f32{}, 2.f);
+				registry.emplace<rotational_body3_component>(entity, math::vector3_f32{}, math::get_box_inertia(2.f, 2.f * extents));
+				registry.emplace<box_shape_component>(entity, extents);
+				registry.emplace<collidable_component>(entity);
+				registry.emplace<pinned_component>(entity, pinned);
+				return entity;
+			};
+		add_box({ 0.f, 2.f, 0.f }, math::quaternion_f32(1.f, 0.f, 0.f, 0.f), true);
+		const entity_id dropped = add_box({ 0.1f, 3.6f, -0.1f }, math::angleAxis(0.3f, math::vector3_f32{ 0.f, 1.f, 0.f }), false);
+		for (int tick = 0; tick < 360; ++tick)
+		{
+			Step(registry, colliders);
+		}
+
+		//resting on a face, the body's y axis is vertical one way or the other, and the contacts hold it within the slop
+		spatial3_component const& spatial = registry.get<spatial3_component>(dropped);
+		const math::matrix33_f32 axes = math::quat_to_mat(spatial.orientation);
+		const f32 upright = std::max({ std::abs(axes[0].y), std::abs(axes[1].y), std::abs(axes[2].y) });
+		const f32 speed = length(registry.get<linear_body3_component>(dropped).velocity);
+		if (std::abs(spatial.position.y - 3.f) > 0.02f || upright < 0.999f || speed > 0.05f)
+		{
+			std::fprintf(stderr, "a box dropped on a box came to %f high (3 expected), %f upright and moving at %f!\n", spatial.position.y, upright, speed);
+			return false;
+		}
+		return true;
+	}
+
+	//resting stacks fall asleep, a falling sphere wakes only the stack it lands on, and changing the wind wakes everything
+	bool VerifySleeping()
+	{
+		entity_registry registry;
+		collider_set colliders;
+		CreateStackWorld(registry, 8, 4, { 0.f, 0.f, 0.f });
+		const u32 bodies = 8 * 8 * 4;
+		for (int tick = 0; tick < 120; ++tick)
+		{
+			Step(registry, colliders);
+		}
+		island_state const& state = get_island_state(registry);
+		bool passed = state.sleeping_bodies == bodies;
+		if (!passed)
+		{
+			std::fprintf(stderr, "only %u of %u resting bodies fell asleep!\n", state.sleeping_bodies, bodies);
+		}
+
+		CreateStackWorld(registry, 1, 1, { 0.f, 5.f, 0.f }); //1.5 above the first stack, lands after about 65 ticks
+		for (int tick = 0; tick < 90; ++tick)
+		{
+			Step(registry, colliders);
+		}
+		if (state.sleeping_bodies != bodies - 4)
+		{
+			std::fprintf(stderr, "a falling sphere should wake the 4 bodies of one stack, %u of %u are asleep!\n", state.sleeping_bodies, bodies);
+			passed = false;
+		}
+
+		colliders = build_colliders(registry);
+		resolve_collisions(registry, colliders, FixedTick_Period);
+		integrate(registry, FixedTick_Period, { 1.f, 0.f, 0.f }, wall_boundaries_min, wall_boundaries_max);
+		if (state.sleeping_bodies != 0)
+		{
+			std::fprintf(stderr, "a change of wind left %u bodies asleep!\n", state.sleeping_bodies);
+			passed = false;
+		}
+		return passed;
+	}
+
+	//copies in insertion order, so both registries iterate their views the same way
+	template <typename Component>
+	void CopyComponents(entity_registry const& source, entity_registry& target)
+	{
+		auto const* storage = source.storage<Component>(); //null when no entity ever had one
+		if (storage == nullptr)
+		{
+			return;
+		}
+		for (auto it = storage->entt::sparse_set::rbegin(); it != storage->entt::sparse_set::rend(); ++it)
+		{
+			if constexpr (std::is_empty_v<Component>)
+			{
+				target.emplace<Component>(*it);
+			}
+			else
+			{
+				target.emplace<Component>(*it, storage->get(*it));
+			}
+		}
+	}
+
+	//false when the target could not give out the same entity ids
+	bool CopyWorld(entity_registry const& source, entity_registry& target)
+	{
+		auto const* entities = source.storage<entity_id>();
+		for (auto it = entities->rbegin(); it != entities->rend(); ++it)
+		{
+			if (source.valid(*it) && target.create(*it) != *it)
+			{
+				return false;
+			}
+		}
+		CopyComponents<spatial3_component>(source, target);
+		CopyComponents<linear_body3_component>(source, target);
+		CopyComponents<rotational_body3_component>(source, target);
+		CopyComponents<sphere_shape_component>(source, target);
+		CopyComponents<box_shape_component>(source, target);
+		CopyComponents<collidable_component>(source, target);
+		CopyComponents<pinned_component>(source, target);
+		CopyComponents<constraint_component_rigid>(source, target);
+		return true;
+	}
+
+	//every counter here lives on the stack and is gone the moment its wait returns, so a worker still touching one after its last Finish shows up under -fsanitize=address or thread
+	bool VerifyJobCounters()
+	{
+		Platform::JobSystem jobs(4);
+		uSize wrongSums = 0;
+		for (int round = 0; round < 2000; ++round)
+		{
+			std::atomic<uSize> sum = 0;
+			jobs.ParallelFor(64, 1, [&sum](uSize begin, uSize end)
+				{
+					for (uSize idx = begin; idx < end; ++idx)
+					{
+						sum.fetch_add(idx, std::memory_order_relaxed);
+					}
+				});
+			wrongSums += sum.load() != 64 * 63 / 2;
+		}
+
+		//child counters drain into a parent that is itself on the stack of the waiting thread
+		uSize wrongNested = 0;
+		for (int round = 0; round < 500; ++round)
+		{
+			std::atomic<uSize> ran = 0;
+			Platform::JobCounter parent;
+			for (int group = 0; group < 4; ++group)
+			{
+				jobs.Run(parent, [&jobs, &parent, &ran]()
+					{
+						Platform::JobCounter child(&parent);
+						for (int job = 0; job < 8; ++job)
+						{
+							jobs.Run(child, [&ran]() { ran.fetch_add(1, std::memory_order_relaxed); });
+						}
+						jobs.Wait(child);
+					});
+			}
+			jobs.Wait(parent);
+			wrongNested += ran.load() != 32;
+		}
+
+		if (wrongSums != 0 || wrongNested != 0)
+		{
+			std::fprintf(stderr, "%zu of 2000 parallel fors and %zu of 500 nested waits returned before all of their jobs ran!\n", wrongSums, wrongNested);
+		}
+		return wrongSums == 0 && wrongNested == 0;
+	}
+
+	//islands never share a movable body, so solving them as jobs must give exactly the serial result
+	bool VerifyIslandJobs()
+	{
+		Platform::JobSystem jobs(4);
+		entity_registry serial;
+		CreateRopeWorld(serial, 256, 10, { -256.f, 1.f, 0.f }); //enough links for several constraint batches
+		CreateSphereWorld(serial, 2000, { -30.f, 1.f, -30.f }, { 30.f, 11.f, 30.f });
+		entity_registry parallel;
+		if (!CopyWorld(serial, parallel))
+		{
+			std::fprintf(stderr, "could not copy the island test world!\n");
+			return false;
+		}
+		set_island_jobs(parallel, &jobs);
+
+		collider_set colliders;
+		for (int tick = 0; tick < 60; ++tick)
+		{
+			Step(serial, colliders);
+			Step(parallel, colliders);
+		}
+
+		uSize mismatches = 0;
+		for (auto&& [entity, spatial, linear] : serial.view<const spatial3_component, const linear_body3_component>().each())
+		{
+			spatial3_component const& other = parallel.get<spatial3_component>(entity);
+			mismatches += std::memcmp(&spatial.position, &other.position, sizeof(spatial.position)) != 0 ||
+				std::memcmp(&linear.velocity, &parallel.get<linear_body3_component>(entity).velocity, sizeof(linear.velocity)) != 0;
+		}
+		if (mismatches != 0)
+		{
+			std::fprintf(stderr, "island jobs moved %zu bodies differently from the serial solve!\n", mismatches);
+		}
+		return mismatches == 0;
+	}
+
+	//every kernel the cpu supports must move the bodies exactly as the scalar one does, with walls hit from every side
+	template <typename Integrator>
+	bool VerifyLinearKernels()
+	{
+		const math::vector3_f32 wallMin = { -5.f, 0.f, -5.f };
+		const math::vector3_f32 wallMax = { 5.f, 10.f, 5.f };
+		entity_registry source;
+		CreateSphereWorld(source, 1001, { -6.f, -1.f, -6.f }, { 6.f, 11.f, 6.f }); //not a whole number of lane groups, some start outside
+		for (auto&& [entity, linear] : source.view<linear_body3_component>().each())
+		{
+			linear.velocity = 20.f * math::random::unit_ball<f32>();
+			linear.applied_force = 50.f * math::random::unit_ball<f32>();
+		}
+
+		bool passed = true;
+		for (Platform::SimdLevel level : { Platform::SimdLevel::SSE4, Platform::SimdLevel::AVX2 })
+		{
+			if (level > Platform::GetSupportedSimdLevel())
+			{
+				continue;
+			}
+
+			entity_registry reference;
+			entity_registry vector;
+			if (!CopyWorld(source, reference) || !CopyWorld(source, vector))
+			{
+				std::fprintf(stderr, "could not copy the linear kernel test world!\n");
+				return false;
+			}
+			get_linear_batch(reference).level = Platform::SimdLevel::Scalar;
+			get_linear_batch(vector).level = level;
+			for (int tick = 0; tick < 240; ++tick)
+			{
+				const math::vector3_f32 wind = { tick < 120 ? 30.f : -30.f, 0.f, 5.f };
+				integrate_linear<Integrator>(reference, FixedTick_Period, wind, wallMin, wallMax);
+				integrate_linear<Integrator>(vector, FixedTick_Period, wind, wallMin, wallMax);
+			}
+
+			uSize mismatches = 0;
+			for (auto&& [entity, spatial, linear] : reference.view<const spatial3_component, const linear_body3_component>().each())
+			{
+				mismatches += std::memcmp(&spatial.position, &vector.get<spatial3_component>(entity).position, sizeof(spatial.position)) != 0 ||
+					std::memcmp(&linear.velocity, &vector.get<linear_body3_component>(entity).velocity, sizeof(linear.velocity)) != 0;
+			}
+			if (mismatches != 0)
+			{
+				std::fprintf(stderr, "the %s linear kernel moved %zu bodies differently from the scalar one with %s!\n", Platform::GetSimdLevelName(level), mismatches, Integrator::name);
+				passed = false;
+			}
+		}
+		return passed;
+	}
+
+	//the batches only rebuild on component signals, so a body unpinned through patch has to start moving on the next tick
+	bool VerifyPinnedPatch()
+	{
+		entity_registry registry;
+		CreateRopeWorld(registry, 1, 1, { 0.f, 10.f, 0.f }); //one pinned sphere
+		const entity_id sphere = registry.view<pinned_component>().front();
+		integrate_linear<math::symplectic_euler>(registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+		const math::vector3_f32 pinnedAt = registry.get<spatial3_component>(sphere).position;
+
+		registry.patch<pinned_component>(sphere, [](pinned_component& pinned) { pinned.isPinned = false; });
+		registry.get<linear_body3_component>(sphere).velocity = {}; //spheres start with a random velocity, let gravity decide
+		integrate_linear<math::symplectic_euler>(registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+		if (registry.get<spatial3_component>(sphere).position.y >= pinnedAt.y)
+		{
+			std::fprintf(stderr, "a body unpinned through patch stayed where it was pinned!\n");
+			return false;
+		}
+		return true;
+	}
+
+	//the quaternion kernels may only differ from the matrix integration by rounding, on bodies with uneven inertia under torque
+	bool VerifyAngularKernels()
+	{
+		entity_registry source;
+		for (int i = 0; i < 1001; ++i)
+		{
+			const entity_id entity = source.create();
+			source.emplace<spatial3_component>(entity, math::vector3_f32{}, math::random::unit_quaternion<f32>());
+			const math::vector3_f32 inertia = { math::random::scalar(0.1f, 2.f), math::random::scalar(0.1f, 2.f), math::random::scalar(0.1f, 2.f) };
+			source.emplace<rotational_body3_component>(entity, 10.f * math::random::unit_ball<f32>(), inertia).applied_torque = 5.f * math::random::unit_ball<f32>();
+			source.emplace<pinned_component>(entity, false);
+		}
+
+		entity_registry reference;
+		if (!CopyWorld(source, reference))
+		{
+			std::fprintf(stderr, "could not copy the angular kernel test world!\n");
+			return false;
+		}
+		for (int tick = 0; tick < 120; ++tick)
+		{
+			IntegrateAngularReference(reference, FixedTick_Period);
+		}
+
+		bool passed = true;
+		for (Platform::SimdLevel level : { Platform::SimdLevel::Scalar, Platform::SimdLevel::SSE4, Platform::SimdLevel::AVX2 })
+		{
+			if (level > Platform::GetSupportedSimdLevel())
+			{
+				continue;
+			}
+
+			entity_registry kernel;
+			if (!CopyWorld(source, kernel))
+			{
+				std::fprintf(stderr, "could not copy the angular kernel test world!\n");
+				return false;
+			}
+			get_angular_batch(kernel).level = level;
+			for (int tick = 0; tick < 120; ++tick)
+			{
+				integrate_angular(kernel, FixedTick_Period);
+			}
+
+			f32 worstOrientation = 0.f;
+			f32 worstVelocity = 0.f;
+			for (auto&& [entity, spatial, angular] : reference.view<const spatial3_component, const rotational_body3_component>().each())
+			{
+				//q and -q are the same rotation
+				worstOrientation = std::max(worstOrientation, 1.f - std::abs(dot(spatial.orientation, kernel.get<spatial3_component>(entity).orientation)));
+				worstVelocity = std::max(worstVelocity, length(angular.velocity - kernel.get<rotational_body3_component>(entity).velocity) / std::max(length(angular.velocity), 1.f));
+			}
+			if (worstOrientation > 1e-5f || worstVelocity > 1e-4f)
+			{
+				std::fprintf(stderr, "the %s angular kernel strays from the matrix integration (orientation %g, velocity %g)!\n", Platform::GetSimdLevelName(level), worstOrientation, worstVelocity);
+				passed = false;
+			}
+		}
+		return passed;
+	}
+
+	//a body falling from rest with a sideways push, against the closed form solution under gravity and linear damping
+	//at 60 Hz first order euler is visibly off, the second and fourth order integrators are not
+	template <typename Integrator>
+	f64 IntegratorError(f64 seconds, uSize rate)
+	{
+		constexpr f64 damping = 0.06; //the linear damping rate in Simulation.cpp
+		constexpr f64 gravity = -9.81;
+		const math::vector3_f32 start = { 0.f, 100.f, 0.f };
+		const math::vector3_f32 push = { 3.f, 20.f, -2.f };
+
+		entity_registry registry;
+		CreateSphereWorld(registry, 1, start, start);
+		for (auto&& [entity, linear] : registry.view<linear_body3_component>().each())
+		{
+			linear.velocity = push;
+		}
+		const uSize ticks = static_cast<uSize>(seconds * f64(rate));
+		for (uSize tick = 0; tick < ticks; ++tick)
+		{
+			integrate_linear<Integrator>(registry, 1.f / f32(rate), wind_force, wall_boundaries_min, wall_boundaries_max);
+		}
+
+		//v(t) = g / c + (v0 - g / c) e^-ct, and x(t) its integral
+		const f64 decay = std::exp(-damping * seconds);
+		f64 error = 0.0;
+		for (auto&& [entity, spatial] : registry.view<spatial3_component>().each())
+		{
+			for (int axis = 0; axis < 3; ++axis)
+			{
+				const f64 terminal = axis == 1 ? gravity / damping : 0.0;
+				const f64 expected = start[axis] + terminal * seconds + (push[axis] - terminal) * (1.0 - decay) / damping;
+				error = std::max(error, std::abs(f64(spatial.position[axis]) - expected));
+			}
+		}
+		return error;
+	}
+
+	bool VerifyIntegrators()
+	{
+		const f64 euler = IntegratorError<math::symplectic_euler>(2.0, 60);
+		const f64 verlet = IntegratorError<math::position_verlet>(2.0, 60);
+		const f64 rk4 = IntegratorError<math::runge_kutta4>(2.0, 60);
+		const bool passed = euler > 0.05 && verlet < 1e-3 && rk4 < 1e-3;
+		if (!passed)
+		{
+			std::fprintf(stderr, "integrators are off the closed form at 60 Hz (euler %g, verlet %g, rk4 %g)!\n", euler, verlet, rk4);
+		}
+		return passed && VerifyLinearKernels<math::symplectic_euler>() && VerifyLinearKernels<math::position_verlet>() && VerifyLinearKernels<math::runge_kutta4>();
+	}
+
+	//a body hanging from a pinned one on a compliant link settles where the link force carries its weight, extension = m g compliance
+	//compliance over the squared substep makes that the exact rest point of the solve, for any mix of substeps and iterations
+	f32 HangingExtensionError(u32 substeps, u32 iterations)
+	{
+		constexpr f32 compliance = 1e-3f; //a 1000 N/m spring
+		entity_registry registry;
+		CreateRopeWorld(registry, 1, 2, { 0.f, 100.f, 0.f }, compliance);
+		constraint_store& store = get_constraint_store(registry);
+		store.substeps = substeps;
+		store.iterations = iterations;
+
+		f32 expected = 0.f;
+		for (auto&& [entity, constraint] : registry.view<const constraint_component_rigid>().each())
+		{
+			//massB is the lower end, start it at rest where it should stay
+			linear_body3_component& hanging = registry.get<linear_body3_component>(constraint.massB);
+			expected = 9.81f * compliance / hanging.inverse_mass;
+			hanging.velocity = {};
+			registry.get<spatial3_component>(constraint.massB).position = registry.get<spatial3_component>(constraint.massA).position - math::vector3_f32{ 0.f, constraint.linkDistance + expected, 0.f };
+		}
+
+		f32 worst = 0.f;
+		for (int tick = 0; tick < 240; ++tick)
+		{
+			relax_constraints(registry, FixedTick_Period, wind_force, wall_boundaries_min, wall_boundaries_max);
+			for (auto&& [entity, constraint] : registry.view<const constraint_component_rigid>().each())
+			{
+				const f32 extension = length(registry.get<spatial3_component>(constraint.massA).position - registry.get<spatial3_component>(constraint.massB).position) - constraint.linkDistance;
+				worst = std::max(worst, std::abs(extension - expected) / expected);
+			}
+		}
+		return worst;
+	}
+
+	bool VerifyCompliance()
+	{
+		bool passed = true;
+		for (auto [substeps, iterations] : { std::pair<u32, u32>{ 4, 1 }, { 20, 1 }, { 4, 5 }, { 2, 10 } })
+		{
+			const f32 error = HangingExtensionError(substeps, iterations);
+			if (error > 1e-3f)
+			{
+				std::fprintf(stderr, "a compliant link stretched %.2f%% off m g compliance with %u substeps of %u iterations!\n", 100.f * error, substeps, iterations);
+				passed = false;
+			}
+		}
+		return passed;
+	}
+
+	//creates a world, runs one tick with its transforms kept and captures what a frame would draw of it
+	render_snapshot CaptureSteppedWorld(entity_registry& registry, std::function<void(entity_registry&)> const& create)
+	{
+		create(registry);
+		collider_set colliders;
+		store_previous_transforms(registry);
+		Step(registry, colliders);
+		render_snapshot snapshot;
+		capture_render_snapshot(registry, snapshot);
+		return snapshot;
+	}
+
+	//halfway through a tick that moves 2 along x and turns 90 degrees, a body is drawn 1 along and 45 degrees round,
+	//whichever sign the quaternions carry, and a stored transform is the one from before the tick
+	bool VerifyInterpolation()
+	{
+		const math::quaternion_f32 turn = math::angleAxis(0.5f * math::pi<f32>(), math::vector3_f32{ 0.f, 1.f, 0.f });
+		const spatial3_component from{ math::zero3, math::identityH };
+		bool passed = true;
+		for (const math::quaternion_f32 to : { turn, -turn })
+		{
+			const spatial3_component half = math::interpolate(from, spatial3_component{ { 2.f, 0.f, 0.f }, to }, 0.5f);
+			passed = passed && length(half.position - math::vector3_f32{ 1.f, 0.f, 0.f }) < 1e-6f && std::abs(math::angle(half.orientation) - 0.25f * math::pi<f32>()) < 1e-5f;
+		}
+		if (!passed)
+		{
+			std::fprintf(stderr, "interpolating half a tick does not land halfway!\n");
+		}
+
+		entity_registry registry;
+		std::vector<spatial3_component> before;
+		const render_snapshot snapshot = CaptureSteppedWorld(registry, [&before](entity_registry& world)
+			{
+				CreateSphereWorld(world, 100, { -5.f, 1.f, -5.f }, { 5.f, 6.f, 5.f });
+				for (auto&& [entity, shape, spatial] : world.view<const sphere_shape_component, const spatial3_component>().each())
+				{
+					before.push_back(spatial);
+				}
+			});
+
+		uSize mismatches = snapshot.spheres.size() == before.size() ? 0 : 1;
+		for (uSize index = 0; index < std::min(snapshot.spheres.size(), before.size()); ++index)
+		{
+			mismatches += std::memcmp(&snapshot.spheres[index].previous, &before[index], sizeof(spatial3_component)) != 0;
+		}
+		if (mismatches != 0)
+		{
+			std::fprintf(stderr, "%zu of %zu previous transforms are not from before the tick!\n", mismatches, before.size());
+			passed = false;
+		}
+		return passed;
+	}
+
+	//a reader on another thread must only ever see whole published values, in order, and end on the last one
+	//then a snapshot drawn at alpha 1 must match the registry it was captured from
+	bool VerifySnapshots()
+	{
+		struct Value
+		{
+			std::array<u64, 64> Words{}; //every word holds the same count, a torn value would mix two
+		};
+		constexpr u64 publishes = 200000;
+
+		Platform::TripleBuffer<Value> buffer;
+		std::thread writer([&buffer]()
+			{
+				for (u64 count = 1; count <= publishes; ++count)
+				{
+					buffer.GetWriteBuffer().Words.fill(count);
+					buffer.Publish();
+				}
+			});
+
+		u64 last = 0;
+		uSize torn = 0;
+		uSize backwards = 0;
+		while (last != publishes)
+		{
+			if (buffer.Acquire())
+			{
+				Value const& value = buffer.GetReadBuffer();
+				torn += std::any_of(value.Words.begin(), value.Words.end(), [&value](u64 word) { return word != value.Words[0]; });
+				backwards += value.Words[0] <= last;
+				last = value.Words[0];
+			}
+		}
+		writer.join();
+
+		bool passed = torn == 0 && backwards == 0;
+		if (!passed)
+		{
+			std::fprintf(stderr, "triple buffer handed over %zu torn and %zu stale values!\n", torn, backwards);
+		}
+
+		entity_registry registry;
+		const render_snapshot snapshot = CaptureSteppedWorld(registry, [](entity_registry& world)
+			{
+				CreateMixedWorld(world, 200, { -5.f, 1.f, -5.f }, { 5.f, 6.f, 5.f });
+				CreateRopeWorld(world, 4, 5, { 0.f, 1.f, 0.f });
+			});
+		uSize mismatches = snapshot.spheres.size() + snapshot.boxes.size() == registry.view<spatial3_component>().size() ? 0 : 1;
+		uSize index = 0;
+		for (auto&& [entity, shape, spatial] : registry.view<const sphere_shape_component, const spatial3_component>().each())
+		{
+			const math::matrix44_f32 expected = math::isometry_matrix3(spatial.position, spatial.orientation) * math::scale_matrix3(shape.radius);
+			const math::matrix44_f32 drawn = get_instance_matrix(snapshot.spheres[index++], 1.f);
+			for (int column = 0; column < 4; ++column)
+			{
+				mismatches += length(drawn[column] - expected[column]) > 1e-5f;
+			}
+		}
+		if (mismatches != 0)
+		{
+			std::fprintf(stderr, "a snapshot drawn at alpha 1 strays from the registry in %zu places!\n", mismatches);
+			passed = false;
+		}
+		return passed;
+	}
+
+	//instances come out as one run per shape in the order they are drawn, boxes before spheres and rectangles before disks,
+	//each the matrix its shape is drawn with, and building them again into the same instances does not allocate
+	bool VerifyInstances()
+	{
+		static_assert(sizeof(math::matrix44_f32) == 16 * sizeof(f32) && sizeof(math::matrix33_f32) == 9 * sizeof(f32), "instance buffers expect tightly packed matrices");
+
+		entity_registry registry;
+		const render_snapshot snapshot = CaptureSteppedWorld(registry, [](entity_registry& world)
+			{
+				CreateMixedWorld(world, 200, { -5.f, 1.f, -5.f }, { 5.f, 6.f, 5.f });
+				for (uSize index = 0; index < 10; ++index)
+				{
+					const spatial2_component spatial{ { f32(index), 1.f }, 0.1f * f32(index) };
+					entity_id entity = world.create();
+					world.emplace<spatial2_component>(entity, spatial);
+					if (index % 3 == 0)
+					{
+						world.emplace<rectangle_shape_component>(entity, math::vector2_f32{ 1.f, 0.5f });
+					}
+					else
+					{
+						world.emplace<disk_shape_component>(entity, 0.5f);
+					}
+				}
+			});
+		render_instances instances;
+		build_render_instances(snapshot, 0.5f, instances);
+
+		uSize mismatches = 0;
+		mismatches += instances.boxes != snapshot.boxes.size() || instances.spheres != snapshot.spheres.size() || instances.solids.size() != instances.boxes + instances.spheres;
+		mismatches += instances.rectangles != 4 || instances.disks != 6 || instances.flats.size() != instances.rectangles + instances.disks;
+		if (mismatches == 0)
+		{
+			for (uSize index = 0; index < instances.solids.size(); ++index)
+			{
+				render_instance const& instance = index < instances.boxes ? snapshot.boxes[index] : snapshot.spheres[index - instances.boxes];
+				mismatches += instances.solids[index] != get_instance_matrix(instance, 0.5f);
+			}
+			for (uSize index = 0; index < instances.flats.size(); ++index)
+			{
+				math::matrix33_f32 const& expected = index < instances.rectangles ? snapshot.rectangles[index] : snapshot.disks[index - instances.rectangles];
+				mismatches += instances.flats[index] != expected;
+			}
+		}
+
+		const math::matrix44_f32* solids = instances.solids.data();
+		const math::matrix33_f32* flats = instances.flats.data();
+		build_render_instances(snapshot, 0.5f, instances);
+		const bool reallocated = instances.solids.data() != solids || instances.flats.data() != flats;
+
+		if (mismatches != 0 || reallocated)
+		{
+			std::fprintf(stderr, "render instances are out of draw order in %zu places%s!\n", mismatches, reallocated ? " and reallocate when rebuilt" : "");
+			return false;
+		}
+		return true;
+	}
+
+	//a square 60 degree view has its side planes through the eye at 30 degrees to the view direction and its near plane in front,
+	//then random spheres culled at every level match math::intersects, and a culled build keeps exactly the visible bodies in order
+	bool VerifyCulling()
+	{
+		const math::vector3_f32 eye = { 0.f, 2.f, 10.f };
+		const math::camera3<f32> camera(eye, { 0.f, 2.f, 0.f }, 60.f, 1.f);
+		const math::frustum3<f32> frustum = GetView(camera).frustum;
+		bool passed = true;
+		for (uSize p = 0; p < 4; ++p)
+		{
+			math::plane3<f32> const& plane = frustum.planes[p];
+			passed = passed && std::abs(dot(plane.normal, camera.get_forward()) - 0.5f) < 1e-4f && std::abs(dot(plane.normal, eye) + plane.offset) < 1e-3f;
+		}
+		math::plane3<f32> const& nearPlane = frustum.planes[4];
+		passed = passed && length(nearPlane.normal - camera.get_forward()) < 1e-4f && std::abs(dot(nearPlane.normal, eye + 0.1f * camera.get_forward()) + nearPlane.offset) < 1e-4f;
+		for (auto [sphere, inside] : { std::pair{ math::sphere3<f32>{ { 0.f, 2.f, 0.f }, 0.5f }, true }, { { eye + math::vector3_f32{ 0.f, 0.f, 1.f }, 0.5f }, false }, { { { 100.f, 2.f, 0.f }, 1.f }, false } })
+		{
+			passed = passed && math::intersects(frustum, sphere) == inside;
+		}
+		const math::vector3_f32 pastLeft = math::vector3_f32{ 0.f, 2.f, 0.f } - (dot(frustum.planes[0].normal, math::vector3_f32{ 0.f, 2.f, 0.f }) + frustum.planes[0].offset + 0.5f) * frustum.planes[0].normal;
+		passed = passed && math::intersects(frustum, math::sphere3<f32>{ pastLeft, 1.f }) && !math::intersects(frustum, math::sphere3<f32>{ pastLeft, 0.25f });
+		if (!passed)
+		{
+			std::fprintf(stderr, "frustum planes do not bound the camera's view!\n");
+		}
+
+		std::vector<math::sphere3<f32>> spheres(10001);
+		uSize referenceInside = 0;
+		for (math::sphere3<f32>& sphere : spheres)
+		{
+			sphere = { 30.f * math::random::unit_ball<f32>(), math::random::scalar(0.f, 3.f) };
+			referenceInside += math::intersects(frustum, sphere);
+		}
+		for (Platform::SimdLevel level : { Platform::SimdLevel::Scalar, Platform::SimdLevel::SSE4, Platform::SimdLevel::AVX2 })
+		{
+			if (level > Platform::GetSupportedSimdLevel())
+			{
+				continue;
+			}
+
+			cull_batch batch;
+			batch.reset(spheres.size());
+			for (math::sphere3<f32> const& sphere : spheres)
+			{
+				batch.push_back(sphere.centre, sphere.radius);
+			}
+			const uSize inside = cull_spheres(batch, frustum, level);
+			uSize mismatches = inside == referenceInside ? 0 : 1;
+			for (uSize index = 0; index < spheres.size(); ++index)
+			{
+				mismatches += (batch.visible[index] != 0) != math::intersects(frustum, spheres[index]);
+			}
+			if (mismatches != 0)
+			{
+				std::fprintf(stderr, "the %s culling kernel disagrees with the scalar test %zu times!\n", Platform::GetSimdLevelName(level), mismatches);
+				passed = false;
+			}
+		}
+
+		entity_registry registry;
+		const render_snapshot snapshot = CaptureSteppedWorld(registry, [](entity_registry& world) { CreateMixedWorld(world, 500, { -5.f, 1.f, -5.f }, { 5.f, 6.f, 5.f }); });
+		const render_view corner = GetView(math::camera3<f32>({ 0.f, 3.f, 0.f }, { -5.f, 3.f, -5.f }, 45.f, 16.f / 9.f));
+		render_instances instances;
+		build_render_instances(snapshot, 0.5f, corner, instances);
+
+		//boxes in snapshot order, then the spheres of each level in snapshot order
+		std::vector<math::matrix44_f32> expected;
+		for (uSize pass = 0; pass <= sphere_lods.size(); ++pass)
+		{
+			std::vector<render_instance> const& shapes = pass == 0 ? snapshot.boxes : snapshot.spheres;
+			for (render_instance const& instance : shapes)
+			{
+				const math::sphere3<f32> bounds = { math::lerp(0.5f, instance.previous.position, instance.current.position), pass == 0 ? length(instance.scale) : instance.scale.x };
+				if (math::intersects(corner.frustum, bounds) && (pass == 0 || select_sphere_lod(get_screen_radius(corner, bounds.centre, bounds.radius)) == pass - 1))
+				{
+					expected.push_back(get_instance_matrix(instance, 0.5f));
+				}
+			}
+		}
+		if (instances.solids != expected || instances.culled + instances.solids.size() != snapshot.boxes.size() + snapshot.spheres.size() || instances.culled == 0 || instances.solids.empty())
+		{
+			std::fprintf(stderr, "a culled build keeps %zu and culls %zu bodies where %zu are in view!\n", instances.solids.size(), instances.culled, expected.size());
+			passed = false;
+		}
+		return passed;
+	}
+
+	//a unit sphere straight ahead covers 1 / (distance * tan(fov / 2)) of half the screen, and moving it away never picks a finer level,
+	//from the finest up close to the coarsest far off, with one sphere in each level's band drawn at exactly that level
+	bool VerifyLevelsOfDetail()
+	{
+		const math::camera3<f32> camera({ 0.f, 0.f, 0.f }, { 0.f, 0.f, -1.f }, 60.f, 1.f);
+		const render_view view = GetView(camera);
+		bool passed = std::abs(get_screen_radius(view, { 0.f, 0.f, -10.f }, 1.f) - 1.f / (10.f * std::tan(math::radians(30.f)))) < 1e-4f;
+
+		uSize previous = sphere_lods.size() - 1;
+		passed = passed && select_sphere_lod(get_screen_radius(view, { 0.f, 0.f, -1.f }, 1.f)) == previous;
+		for (f32 distance = 1.f; distance < 1000.f; distance *= 1.1f)
+		{
+			const uSize level = select_sphere_lod(get_screen_radius(view, { 0.f, 0.f, -distance }, 1.f));
+			passed = passed && level <= previous;
+			previous = level;
+		}
+		passed = passed && previous == 0;
+		if (!passed)
+		{
+			std::fprintf(stderr, "sphere levels of detail do not follow the screen radius!\n");
+		}
+
+		//a unit sphere straight ahead covers about 1.73 / distance, so each distance lands in one level, listed out of order
+		constexpr std::array<std::pair<f32, uSize>, 5> placed = { { { 40.f, 2 }, { 300.f, 0 }, { 5.f, 4 }, { 100.f, 1 }, { 10.f, 3 } } };
+		render_snapshot snapshot;
+		for (auto [distance, level] : placed)
+		{
+			const spatial3_component spatial{ { 0.f, 0.f, -distance }, math::identityH };
+			snapshot.spheres.push_back({ spatial, spatial, math::vector3_f32{ 1.f } });
+		}
+		render_instances instances;
+		build_render_instances(snapshot, 1.f, view, instances);
+		uSize misplaced = instances.spheres == placed.size() ? 0 : 1;
+		for (uSize index = 0; index < std::min(instances.levels.size(), placed.size()); ++index)
+		{
+			misplaced += instances.levels[index] != placed[index].second;
+		}
+		for (uSize level = 0; level < sphere_lods.size(); ++level)
+		{
+			misplaced += instances.sphere_counts[level] != 1;
+		}
+		if (misplaced != 0)
+		{
+			std::fprintf(stderr, "spheres at 5, 10, 40, 100 and 300 units are drawn at the wrong level %zu times!\n", misplaced);
+			passed = false;
+		}
+		return passed;
+	}
+
+	//every vertex's neighbours walking around it against the ones found by going over every side
+	template <typename TVertex>
+	bool VerifyNeighbours(cstring name, math::half_edge_mesh<TVertex> const& mesh)
+	{
+		std::vector<std::vector<u32>> expected(mesh.vertex_count());
+		for (u32 edge = 0; edge < mesh.half_edge_count(); ++edge)
+		{
+			expected[mesh.start(edge)].push_back(mesh.end(edge));
+			expected[mesh.end(edge)].push_back(mesh.start(edge));
+		}
+
+		for (u32 vertex = 0; vertex < mesh.vertex_count(); ++vertex)
+		{
+			std::ranges::sort(expected[vertex]);
+			expected[vertex].erase(std::unique(expected[vertex].begin(), expected[vertex].end()), expected[vertex].end());
+
+			std::vector<u32> neighbours;
+			mesh.for_each_neighbour(vertex, [&neighbours](u32 neighbour) { neighbours.push_back(neighbour); });
+			std::ranges::sort(neighbours);
+			if (neighbours != expected[vertex])
+			{
+				std::fprintf(stderr, "%s: vertex %u has %zu neighbours walking around it but %zu sides!\n", name, vertex, neighbours.size(), expected[vertex].size());
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//a subdivided cube is closed, so every side has a twin, and splitting each side of the cube into n sections
+	//leaves 6n^2 + 2 vertices shared between 12n^2 triangles, a subdivided square is open and walks stop at its edges
+	bool VerifyHalfEdgeMesh()
+	{
+		constexpr uSize n = 8;
+		const auto cube = Visual::Subdivide(Visual::CubeGeometry(2.f), n, false);
+		auto const& mesh = cube.GetMesh();
+
+		bool passed = mesh.vertex_count() == 6 * n * n + 2 && mesh.triangle_count() == 12 * n * n;
+		for (u32 edge = 0; edge < mesh.half_edge_count(); ++edge)
+		{
+			const u32 twin = mesh.twin(edge);
+			passed = passed && twin != mesh.invalid && mesh.twin(twin) == edge && mesh.start(twin) == mesh.end(edge) && mesh.end(twin) == mesh.start(edge);
+		}
+		if (!passed)
+		{
+			std::fprintf(stderr, "subdivided cube has %u vertices and %u triangles, or sides without twins!\n", mesh.vertex_count(), mesh.triangle_count());
+		}
+		passed = VerifyNeighbours("subdivided cube", mesh) && passed;
+
+		Visual::GeometryGraph_f32<2> square({ { -1.f, -1.f }, { 1.f, -1.f }, { 1.f, 1.f }, { -1.f, 1.f } });
+		square.AddQuadrangle({ 0, 1, 2, 3 });
+		const auto subdivided = Visual::Subdivide(square, n, false);
+		if (subdivided.GetMesh().vertex_count() != (n + 1) * (n + 1))
+		{
+			std::fprintf(stderr, "subdivided square has %u vertices!\n", subdivided.GetMesh().vertex_count());
+			passed = false;
+		}
+		passed = VerifyNeighbours("subdivided square", subdivided.GetMesh()) && passed;
+		return passed;
+	}
+
+	//the reordered index buffer holds the same triangles with the same winding, and misses the cache no more often than the order it was given,
+	//for the subdivided cube in generation order and with its triangles shuffled
+	bool VerifyVertexCache()
+	{
+		const auto cube = Visual::Subdivide(Visual::CubeGeometry(2.f), 16, false);
+		const u32 vertexCount = cube.GetMesh().vertex_count();
+		std::vector<u32> generated;
+		for (auto const& edge : cube.GetMesh().get_half_edges())
+		{
+			generated.push_back(edge.vertex);
+		}
+		std::vector<std::array<u32, 3>> triangles(generated.size() / 3);
+		for (uSize triangle = 0; triangle < triangles.size(); ++triangle)
+		{
+			triangles[triangle] = { generated[3 * triangle], generated[3 * triangle + 1], generated[3 * triangle + 2] };
+		}
+		math::random::core shuffler(7);
+		std::shuffle(triangles.begin(), triangles.end(), shuffler.engine());
+		std::vector<u32> shuffled;
+		for (std::array<u32, 3> const& triangle : triangles)
+		{
+			shuffled.insert(shuffled.end(), triangle.begin(), triangle.end());
+		}
+
+		auto sorted_triangles = [](std::vector<u32> const& indices)
+			{
+				std::vector<std::array<u32, 3>> result(indices.size() / 3);
+				for (uSize triangle = 0; triangle < result.size(); ++triangle)
+				{
+					result[triangle] = { indices[3 * triangle], indices[3 * triangle + 1], indices[3 * triangle + 2] };
+				}
+				std::sort(result.begin(), result.end());
+				return result;
+			};
+
+		bool passed = true;
+		for (auto [name, indices] : { std::pair{ "generated", generated }, { "shuffled", shuffled } })
+		{
+			std::vector<u32> optimized = indices;
+			Visual::OptimizeVertexCache(optimized, vertexCount);
+			const f32 before = Visual::GetAverageCacheMissRatio(indices, vertexCount);
+			const f32 after = Visual::GetAverageCacheMissRatio(optimized, vertexCount);
+			if (sorted_triangles(optimized) != sorted_triangles(indices) || after > before)
+			{
+				std::fprintf(stderr, "optimizing the %s cube changed its triangles or raised its cache miss ratio from %.3f to %.3f!\n", name, before, after);
+				passed = false;
+			}
+		}
+		return passed;
+	}
+
+	//frame times against the ticks they should buy, with a budget too large to matter and one that allows a single tick
+	bool VerifyScheduler()
+	{
+		constexpr f64 period = 1.0 / 120.0;
+		bool passed = true;
+		auto check = [&passed](cstring what, bool holds)
+		{
+			if (!holds)
+			{
+				std::fprintf(stderr, "step scheduler: %s!\n", what);
+				passed = false;
+			}
+		};
+
+		uSize ticks = 0;
+		const Platform::StepScheduler::TickTask tick = [&ticks]() { ++ticks; };
+
+		Platform::StepScheduler scheduler(period, 1000.0, 0.25);
+		check("a 30 ms frame should run 3 ticks", scheduler.Advance(0.03, tick) == 3 && std::abs(scheduler.GetAlpha() - 0.6) < 1e-9);
+		check("the leftover should carry into the next frame", scheduler.Advance(0.005, tick) == 1 && std::abs(scheduler.GetAlpha() - 0.2) < 1e-9);
+		check("a one second frame should only count for 250 ms", scheduler.Advance(1.0, tick) == 30 && std::abs(scheduler.GetStats().DroppedTime - 0.75) < 1e-9);
+		check("fast frames should tick only when a period has passed", scheduler.Advance(0.001, tick) == 0 && scheduler.Advance(0.001, tick) == 0);
+
+		Platform::StepScheduler starved(period, 0.0, 0.25);
+		check("a spent budget should still run one tick", starved.Advance(0.1, tick) == 1);
+		check("a spent budget should drop the whole ticks left and keep the fraction",
+			std::abs(starved.GetStats().DroppedTime - 11.0 * period) < 1e-9 && std::abs(starved.GetAlpha() - 0.0) < 1e-6 && starved.GetStats().DroppedFrames == 1);
+
+		check("every tick should have run", ticks == scheduler.GetStats().Ticks + starved.GetStats().Ticks);
+		return passed;
+	}
+
+	Result Measure(Scene const& scene, Stage const& stage, f64 minTime, Platform::JobSystem& jobs)
+	{
+		using clock = std::chrono::steady_clock;
+
+		entity_registry registry;
+		scene.Create(registry);
+		get_constraint_store(registry).workers = &jobs;
+		const uSize bodies = registry.view<spatial3_component>().size();
+
+		Fixture fixture{ registry, jobs };
+		fixture.Size = scene.Size;
+		stage.Setup(fixture);
+		stage.Run(fixture); //warm up caches and allocations
+
+		uSize iterations = 0;
+		f64 elapsed = 0.0;
+		uSize batch = 1;
+		while (elapsed < minTime)
+		{
+			const auto start = clock::now();
+			for (uSize i = 0; i < batch; ++i)
+			{
+				stage.Run(fixture);
+			}
+			elapsed += std::chrono::duration<f64>(clock::now() - start).count();
+			iterations += batch;
+			batch *= 2;
+		}
+
+		const f64 nsPerIteration = 1e9 * elapsed / f64(iterations);
+		return {
+			std::string(stage.Name) + "/" + scene.Name + "/" + std::to_string(scene.Size),
+			stage.Name, scene.Name, scene.Size, bodies, iterations,
+			nsPerIteration, bodies > 0 ? nsPerIteration / f64(bodies) : 0.0 };
+	}
+
+	void PrintUsage(cstring program)
+	{
+		std::fprintf(stderr,
+			"usage: %s [--help] [--filter TEXT] [--out PATH] [--min_time S] [--threads N]\n"
+			"  --filter    only run benchmarks whose name contains TEXT\n"
+			"  --out       write the json results to PATH instead of stdout\n"
+			"  --min_time  seconds to spend on each benchmark, more than 0 (default 0.2)\n"
+			"  --threads   worker threads, at least 1 (default 1)\n"
+			, program);
+	}
+
+	bool ParseSeconds(cstring text, f64& value)
+	{
+		char* end = nullptr;
+		errno = 0;
+		const f64 parsed = std::strtod(text, &end);
+		if (errno != 0 || end == text || *end != '\0' || !std::isfinite(parsed))
+		{
+			return false;
+		}
+		value = parsed;
+		return true;
+	}
+
+	//returns false on anything it does not recognise so the caller can print usage instead of running with defaults
+	bool ParseParameters(int argc, char* argv[], Parameters& parameters)
+	{
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0)
+			{
+				parameters.Help = true;
+				return true;
+			}
+			if (i + 1 >= argc)
+			{
+				std::fprintf(stderr, "%s: missing value for %s\n", argv[0], argv[i]);
+				return false;
+			}
+
+			if (std::strcmp(argv[i], "--filter") == 0)
+			{
+				parameters.Filter = argv[i + 1];
+			}
+			else if (std::strcmp(argv[i], "--out") == 0)
+			{
+				parameters.OutputPath = argv[i + 1];
+			}
+			else if (std::strcmp(argv[i], "--min_time") == 0)
+			{
+				//no time would leave every benchmark without an iteration to divide by
+				if (!ParseSeconds(argv[i + 1], parameters.MinTime) || parameters.MinTime <= 0.0)
+				{
+					std::fprintf(stderr, "%s: --min_time expects a number of seconds above 0, got '%s'\n", argv[0], argv[i + 1]);
+					return false;
+				}
+			}
+			else if (std::strcmp(argv[i], "--threads") == 0)
+			{
+				if (!Platform::ParseCount(argv[i + 1], parameters.Threads) || parameters.Threads == 0)
+				{
+					std::fprintf(stderr, "%s: --threads expects a whole number above 0, got '%s'\n", argv[0], argv[i + 1]);
+					return false;
+				}
+			}
+			else
+			{
+				std::fprintf(stderr, "%s: unknown argument %s\n", argv[0], argv[i]);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	//quotes and backslashes are escaped and control characters written as \u00XX, so paths like C:\bench stay valid json
+	void WriteJsonString(std::FILE* file, cstring text)
+	{
+		std::fputc('"', file);
+		for (cstring c = text; *c != '\0'; ++c)
+		{
+			const unsigned char character = static_cast<unsigned char>(*c);
+			if (character == '"' || character == '\\')
+			{
+				std::fputc('\\', file);
+				std::fputc(character, file);
+			}
+			else if (character < 0x20)
+			{
+				std::fprintf(file, "\\u%04x", character);
+			}
+			else
+			{
+				std::fputc(character, file);
+			}
+		}
+		std::fputc('"', file);
+	}
+
+	void WriteJson(std::FILE* file, cstring executable, Parameters const& parameters, std::vector<Result> const& results)
+	{
+		char date[64] = {};
+		const std::time_t now = std::time(nullptr);
+		std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+		std::fprintf(file, "{\n  \"context\": {\n");
+		std::fprintf(file, "    \"date\": \"%s\",\n", date);
+		std::fprintf(file, "    \"executable\": ");
+		WriteJsonString(file, executable);
+		std::fprintf(file, ",\n");
+		std::fprintf(file, "    \"library_build_type\": \"%s\",\n", Platform::IsDebug ? "debug" : "release");
+		std::fprintf(file, "    \"min_time\": %f,\n", parameters.MinTime);
+		std::fprintf(file, "    \"threads\": %zu\n", parameters.Threads);
+		std::fprintf(file, "  },\n  \"benchmarks\": [\n");
+		for (uSize i = 0; i < results.size(); ++i)
+		{
+			Result const& result = results[i];
+			std::fprintf(file, "    {\n");
+			std::fprintf(file, "      \"name\": ");
+			WriteJsonString(file, result.Name.c_str());
+			std::fprintf(file, ",\n      \"stage\": ");
+			WriteJsonString(file, result.Stage);
+			std::fprintf(file, ",\n      \"scene\": ");
+			WriteJsonString(file, result.Scene);
+			std::fprintf(file, ",\n");
+			std::fprintf(file, "      \"size\": %zu,\n", result.Size);
+			std::fprintf(file, "      \"bodies\": %zu,\n", result.Bodies);
+			std::fprintf(file, "      \"iterations\": %zu,\n", result.Iterations);
+			std::fprintf(file, "      \"real_time\": %f,\n", result.NanosecondsPerIteration);
+			std::fprintf(file, "      \"ns_per_body\": %f,\n", result.NanosecondsPerBody);
+			std::fprintf(file, "      \"time_unit\": \"ns\"\n");
+			std::fprintf(file, "    }%s\n", i + 1 < results.size() ? "," : "");
+		}
+		std::fprintf(file, "  ]\n}\n");
+	}
+
+	int RunBenchmarks(int argc, char* argv[])
+	{
+		Parameters parameters;
+		if (!ParseParameters(argc, argv, parameters) || parameters.Help)
+		{
+			PrintUsage(argv[0]);
+			return parameters.Help ? 0 : 1;
+		}
+		if (!VerifyBroadphases() || !VerifyTreeQueries() || !VerifyManifolds() || !VerifyBoxStacking() || !VerifySleeping() || !VerifyJobCounters() || !VerifyIslandJobs() || !VerifyIntegrators() || !VerifyPinnedPatch() || !VerifyAngularKernels() || !VerifyCompliance() || !VerifyScheduler() || !VerifyInterpolation() || !VerifySnapshots() || !VerifyInstances() || !VerifyCulling() || !VerifyLevelsOfDetail() || !VerifyHalfEdgeMesh() || !VerifyVertexCache())
+		{
+			return 1;
+		}
+		Platform::JobSystem jobs(parameters.Threads);
+
+		std::vector<Result> results;
+		std::fprintf(stderr, "%-40s %12s %16s %14s\n", "Benchmark", "Iterations", "ns/iteration", "ns/body");
+		for (Stage const& stage : MakeStages())
+		{
+			for (Scene const& scene : MakeScenes())
+			{
+				const std::string name = std::string(stage.Name) + "/" + scene.Name + "/" + std::to_string(scene.Size);
+				if (scene.Bodies > stage.MaxBodies ||
+					(stage.Scene != nullptr ? std::strcmp(stage.Scene, scene.Name) != 0 : scene.Bodies == 0) ||
+					(stage.FreeBodies && scene.Linked) ||
+					(!parameters.Filter.empty() && name.find(parameters.Filter) == std::string::npos))
+				{
+					continue;
+				}
+
+				Result result = Measure(scene, stage, parameters.MinTime, jobs);
+				std::fprintf(stderr, "%-40s %12zu %16.1f %14.3f\n", result.Name.c_str(), result.Iterations, result.NanosecondsPerIteration, result.NanosecondsPerBody);
+				results.push_back(std::move(result));
+			}
+		}
+
+		std::FILE* file = parameters.OutputPath.empty() ? stdout : std::fopen(parameters.OutputPath.c_str(), "w");
+		if (file == nullptr)
+		{
+			std::fprintf(stderr, "Could not open %s!\n", parameters.OutputPath.c_str());
+			return 1;
+		}
+		WriteJson(file, argv[0], parameters, results);
+		if (file != stdout)
+		{
+			std::fclose(file);
+		}
+		return 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	return jm::Bench::RunBenchmarks(argc, argv);
+}
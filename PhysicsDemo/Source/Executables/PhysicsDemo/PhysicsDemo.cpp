@@ -3,12 +3,17 @@
 
 #include "Math/Camera.h"
 
+#include "Platform/JobSystem.h"
+#include "Platform/StepScheduler.h"
+#include "Platform/TripleBuffer.h"
 #include "Platform/Tactual.h"
 #include "Platform/WindowedApplication.h"
 
 #include "Systems/Entity.h"
 #include "Systems/Collision.h"
+#include "Systems/Constraints.h"
 #include "Systems/Graphics.h"
+#include "Systems/RenderSnapshot.h"
 
 #include "DearImGui/imgui.h"
 
@@ -16,15 +21,39 @@
 
 #include "Systems/Simulation.h"
 
-#include "Worlds.h"
+#include "Systems/Worlds.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
 
 namespace jm
 {
 	constexpr math::vector2<iSize> screenSize = { 1600, 900 };
 	constexpr math::vector2_f32 screenSizeFloat = { f32(screenSize.x), f32(screenSize.y) };
-	math::vector3_f32 wind_force = { 0.f, 0.f, 0.f };
-	math::vector3_f32 wall_boundaries_min = { -10.f, 0.f, -10.f };
-	math::vector3_f32 wall_boundaries_max = { 10.f, 20.f, 10.f };
+
+	//what the ui edits, the ticking thread takes a copy before each tick
+	struct SimulationSettings
+	{
+		math::vector3_f32 WindForce = { 0.f, 0.f, 0.f };
+		math::vector3_f32 WallBoundariesMin = { -10.f, 0.f, -10.f };
+		math::vector3_f32 WallBoundariesMax = { 10.f, 20.f, 10.f };
+		u32 ConstraintSubsteps = constraint_store{}.substeps;
+		u32 ConstraintIterations = constraint_store{}.iterations;
+		f64 TickBudget = 0.01; //s of ticking per frame before the rest is dropped
+		bool Simulating = false;
+	};
+
+	//everything a frame shows of the simulation, published by whichever thread ticks it
+	struct SimulationFrame
+	{
+		render_snapshot Snapshot;
+		Platform::StepScheduler::Stats Stats;
+		f64 Alpha = 1.0; //on the simulation thread the renderer works it out from CurrentTime instead
+		std::chrono::steady_clock::time_point CurrentTime; //when the snapshot's current transforms were due
+	};
 
 	struct LoopController final
 	{
@@ -35,6 +64,7 @@ namespace jm
 		static constexpr f64 FPSUpdate_Period = 1.0 / FPSUpdate_Frequency; //s
 
 		LoopController()
+			: Scheduler(FixedTick_Period, SimulationSettings{}.TickBudget)
 		{
 			Timer.Initialize();
 		}
@@ -52,18 +82,6 @@ namespace jm
 				FPS = FPSUpdate_Frequency * FPSCounter;
 				FPSCounter = 0;
 			}
-
-			SimUpdateAccumulator += dt;
-			if (SimUpdateAccumulator > FixedTick_Period)
-			{
-				SimUpdateAccumulator -= FixedTick_Period;
-				ShouldTick = true;
-			}
-			else
-			{
-				ShouldTick = false;
-			}
-
 		}
 
 		f32 GetLoopDeltaTime()
@@ -76,19 +94,19 @@ namespace jm
 			return FPS;
 		}
 
-		bool ShouldTickThisFrame()
+		//ticks the simulation when it shares this thread
+		Platform::StepScheduler& GetScheduler()
 		{
-			return ShouldTick;
+			return Scheduler;
 		}
 
 	private:
 
 		Platform::Timer Timer;
-		f64 SimUpdateAccumulator = 0.0;
+		Platform::StepScheduler Scheduler;
 		f64 FPSUpdateAccumulator = 0.0;
 		uSize FPSCounter = 0;
 		uSize FPS = 60;
-		bool ShouldTick = false;
 	};
 
 	math::camera3<f32> Make3DCamera(f32 distanceFromOrigin, f32 yFOV, f32 aspectRatio)
@@ -113,7 +131,7 @@ namespace jm
 			, Camera(Make3DCamera(10.0f, 45.0f, window->GetArea().GetAspectRatio()))
 			, registry()
 			, InputSystem()
-			, GraphicsSystem(*window, registry, { 0.2f, 0.2f, 0.2f })
+			, GraphicsSystem(*window, { 0.2f, 0.2f, 0.2f })
 		{
 		}
 
@@ -132,43 +150,76 @@ namespace jm
 
 			InputUpdate();
 
-			Colliders = build_colliders(registry);
+			if (!Threaded)
+			{
+				SimulationFrame& frame = Frames.GetWriteBuffer();
+				SimulateFrame(Controller.GetScheduler(), Settings, Controller.GetLoopDeltaTime(), frame);
+				frame.Alpha = Settings.Simulating ? Controller.GetScheduler().GetAlpha() : 1.0; //paused frames show the last tick
+				Frames.Publish();
+			}
+			Frames.Acquire();
+			SimulationFrame const& frame = Frames.GetReadBuffer();
 
-			if (Simulating && Controller.ShouldTickThisFrame())
+			f64 alpha = frame.Alpha;
+			if (Threaded)
 			{
-				SimulationUpdate();
+				//a tick behind the simulation, so there is always a later transform to blend towards
+				alpha = std::chrono::duration<f64>(std::chrono::steady_clock::now() - frame.CurrentTime).count() / LoopController::FixedTick_Period;
+				alpha = Settings.Simulating ? std::clamp(alpha, 0.0, 1.0) : 1.0;
 			}
 
 			uSize fps = Controller.GetFPS();
-			GraphicsSystem.Draw(Camera, [this, fps]()
+			GraphicsSystem.Draw(Camera, frame.Snapshot, static_cast<f32>(alpha), [this, fps, &frame]()
 				{
 					ImGui::Begin("Data");
 					ImGui::Text("FPS = %d", fps);
 
 					ImGui::Text("Simulation");
+					SimulationSettings settings = Settings;
 					if (ImGui::Button("Play"))
 					{
-						Simulating = true;
+						settings.Simulating = true;
 					}
 					ImGui::SameLine();
 					if (ImGui::Button("Pause"))
 					{
-						Simulating = false;
+						settings.Simulating = false;
 					}
 					ImGui::SameLine();
 					if (ImGui::Button("Reset"))
 					{
-						DestroyWorld();
-						CreateWorld();
+						ResetWorld();
+					}
+					bool threaded = Threaded;
+					if (ImGui::Checkbox("Simulation Thread", &threaded))
+					{
+						SetThreaded(threaded);
 					}
-					ImGui::DragFloat3("WindForce", &wind_force.x, 0.1f, -100.f, 100.f);
-					ImGui::DragFloat3("WallBoundaryMin", &wall_boundaries_min.x, 0.1f, -20.f, 20.f);
-					ImGui::DragFloat3("WallBoundaryMax", &wall_boundaries_max.x, 0.1f, -20.f, 20.f);
+					ImGui::DragFloat3("WindForce", &settings.WindForce.x, 0.1f, -100.f, 100.f);
+					ImGui::DragFloat3("WallBoundaryMin", &settings.WallBoundariesMin.x, 0.1f, -20.f, 20.f);
+					ImGui::DragFloat3("WallBoundaryMax", &settings.WallBoundariesMax.x, 0.1f, -20.f, 20.f);
+
+					//same stiffness either way, substeps cost a prediction per body but converge faster than iterations
+					constexpr u32 constraintStepsMin = 1;
+					constexpr u32 constraintStepsMax = 64;
+					ImGui::SliderScalar("ConstraintSubsteps", ImGuiDataType_U32, &settings.ConstraintSubsteps, &constraintStepsMin, &constraintStepsMax);
+					ImGui::SliderScalar("ConstraintIterations", ImGuiDataType_U32, &settings.ConstraintIterations, &constraintStepsMin, &constraintStepsMax);
+
+					f32 tickBudget = static_cast<f32>(1000.0 * settings.TickBudget);
+					if (ImGui::DragFloat("TickBudget (ms)", &tickBudget, 0.1f, 0.f, 100.f))
+					{
+						settings.TickBudget = 0.001 * tickBudget;
+					}
+					SetSettings(settings);
+
+					Platform::StepScheduler::Stats const& stats = frame.Stats;
+					ImGui::Text("Ticks = %zu (%zu this frame, %.2f ms each)", stats.Ticks, stats.LastFrameTicks, 1000.0 * stats.AverageTickTime);
+					ImGui::Text("Dropped = %.2f s over %zu frames", stats.DroppedTime, stats.DroppedFrames);
 
 					GraphicsSystem.ImGuiDebug();
 
 					ImGui::Text("Entities");
-					ImGui::Text("Count = %d", registry.storage<entity_id>().in_use());
+					ImGui::Text("Count = %zu", frame.Snapshot.entities);
 					/*if (SelectedEntity.has_value())
 					{
 						ImGui::Text("Selected = %d", get_entity_id_raw(SelectedEntity.value().Entity));
@@ -185,6 +236,7 @@ namespace jm
 
 		virtual void OnStopLoop() override
 		{
+			SetThreaded(false);
 			DestroyWorld();
 			RemoveMessageHandler(InputSystem.GetMessageHandler());
 			RemoveMessageHandler(GraphicsSystem.GetMessageHandler());
@@ -198,6 +250,7 @@ namespace jm
 		void CreateWorld()
 		{
 			CreateBasicWorld(registry);
+			set_island_jobs(registry, &Jobs);
 		}
 
 		void DestroyWorld()
@@ -205,6 +258,89 @@ namespace jm
 			registry.clear();
 		}
 
+		void ResetWorld()
+		{
+			const bool threaded = Threaded;
+			SetThreaded(false);
+			DestroyWorld();
+			CreateWorld();
+			SetThreaded(threaded);
+		}
+
+		void SetSettings(SimulationSettings const& settings)
+		{
+			std::lock_guard lock(SettingsMutex);
+			Settings = settings;
+		}
+
+		//moves the ticking onto its own thread and back, the registry belongs to whichever thread ticks it
+		void SetThreaded(bool threaded)
+		{
+			if (threaded == Threaded)
+			{
+				return;
+			}
+
+			Threaded = threaded;
+			if (threaded)
+			{
+				StopSimulation = false;
+				SimulationThread = std::thread(&PhysicsDemo::SimulationLoop, this);
+			}
+			else
+			{
+				StopSimulation = true;
+				SimulationThread.join();
+			}
+		}
+
+		//ticks at the fixed rate with its own scheduler and sleeps until the next tick is due,
+		//so the tick cost overlaps drawing instead of adding to the frame
+		void SimulationLoop()
+		{
+			using clock = std::chrono::steady_clock;
+
+			Platform::StepScheduler scheduler(LoopController::FixedTick_Period);
+			clock::time_point last = clock::now();
+			while (!StopSimulation.load(std::memory_order_relaxed))
+			{
+				SimulationSettings settings;
+				{
+					std::lock_guard lock(SettingsMutex);
+					settings = Settings;
+				}
+
+				const clock::time_point now = clock::now();
+				SimulationFrame& frame = Frames.GetWriteBuffer();
+				SimulateFrame(scheduler, settings, std::chrono::duration<f64>(now - last).count(), frame);
+				frame.CurrentTime = now - std::chrono::duration_cast<clock::duration>(std::chrono::duration<f64>(scheduler.GetAlpha() * scheduler.GetTickPeriod()));
+				Frames.Publish();
+				last = now;
+
+				std::this_thread::sleep_until(frame.CurrentTime + std::chrono::duration_cast<clock::duration>(std::chrono::duration<f64>(scheduler.GetTickPeriod())));
+			}
+		}
+
+		//runs the ticks the elapsed time covers and captures what they left for drawing
+		void SimulateFrame(Platform::StepScheduler& scheduler, SimulationSettings const& settings, f64 elapsed, SimulationFrame& frame)
+		{
+			constraint_store& constraints = get_constraint_store(registry);
+			constraints.substeps = settings.ConstraintSubsteps;
+			constraints.iterations = settings.ConstraintIterations;
+			scheduler.SetTickBudget(settings.TickBudget);
+
+			if (settings.Simulating)
+			{
+				scheduler.Advance(elapsed, [this, &settings]() { SimulationUpdate(settings); });
+			}
+			else
+			{
+				scheduler.Reset(); //paused frames do not pile up time to catch up on
+			}
+			capture_render_snapshot(registry, frame.Snapshot);
+			frame.Stats = scheduler.GetStats();
+		}
+
 		void InputUpdate()
 		{
 			const bool shiftPressed = InputSystem.GetKeyboard().ShiftPressed;
@@ -246,14 +382,24 @@ namespace jm
 			InputSystem.Update();
 		}
 
-		void SimulationUpdate()
+		void SimulationUpdate(SimulationSettings const& settings)
 		{
-			integrate(registry, static_cast<f32>(LoopController::FixedTick_Period), wind_force, wall_boundaries_min, wall_boundaries_max);
+			store_previous_transforms(registry);
+			Colliders = build_colliders(registry);
+			resolve_collisions(registry, Colliders, static_cast<f32>(LoopController::FixedTick_Period));
+			integrate(registry, static_cast<f32>(LoopController::FixedTick_Period), settings.WindForce, settings.WallBoundariesMin, settings.WallBoundariesMax);
 		}
 
 		entity_registry registry;
+		Platform::JobSystem Jobs;
 		LoopController Controller;
-		bool Simulating = false;
+
+		SimulationSettings Settings; //written by the ui, read under the mutex by the simulation thread
+		std::mutex SettingsMutex;
+		Platform::TripleBuffer<SimulationFrame> Frames;
+		std::thread SimulationThread;
+		std::atomic<bool> StopSimulation = false;
+		bool Threaded = false;
 
 		math::camera3<f32> Camera;
 		collider_set Colliders;
@@ -1,8 +0,0 @@
-#pragma once
-
-#include "Systems/Entity.h"
-
-namespace jm
-{
-	void CreateBasicWorld(entity_registry& registry);
-}
\ No newline at end of file
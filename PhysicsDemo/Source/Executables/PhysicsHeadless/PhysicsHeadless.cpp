@@ -0,0 +1,153 @@
+#include "Math/MathTypes.h"
+
+#include "Systems/Entity.h"
+#include "Systems/Collision.h"
+#include "Systems/Components.h"
+#include "Systems/Constraints.h"
+#include "Systems/Simulation.h"
+#include "Systems/Worlds.h"
+
+#include "Platform/CommandLine.h"
+#include "Platform/JobSystem.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace jm
+{
+	constexpr uSize FixedTick_Frequency = 120; //Hz
+	constexpr f64 FixedTick_Period = 1.0 / FixedTick_Frequency; //s
+
+	math::vector3_f32 wind_force = { 0.f, 0.f, 0.f };
+	math::vector3_f32 wall_boundaries_min = { -10.f, 0.f, -10.f };
+	math::vector3_f32 wall_boundaries_max = { 10.f, 20.f, 10.f };
+
+	struct HeadlessParameters
+	{
+		uSize Ticks = 1200;
+		uSize Scenes = 1;
+		uSize Threads = 1;
+		bool Islands = false; //solve islands as jobs instead of colouring constraints across the worker threads
+		bool Help = false;
+	};
+
+	void PrintUsage(char const* program)
+	{
+		std::fprintf(stderr,
+			"usage: %s [--help] [--ticks N] [--scenes N] [--threads N] [--islands 0|1]\n"
+			"  --ticks    fixed ticks per scene, at least 1 (default 1200)\n"
+			"  --scenes   scenes to build and run back to back (default 1)\n"
+			"  --threads  worker threads, at least 1 (default 1)\n"
+			"  --islands  1 solves islands as jobs instead of colouring constraints (default 0)\n"
+			, program);
+	}
+
+	//returns false on anything it does not recognise so the caller can print usage instead of running a default scene
+	bool ParseParameters(int argc, char* argv[], HeadlessParameters& parameters)
+	{
+		for (int i = 1; i < argc; i += 2)
+		{
+			if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0)
+			{
+				parameters.Help = true;
+				return true;
+			}
+			if (i + 1 >= argc)
+			{
+				std::fprintf(stderr, "%s: missing value for %s\n", argv[0], argv[i]);
+				return false;
+			}
+
+			uSize value = 0;
+			if (!Platform::ParseCount(argv[i + 1], value))
+			{
+				std::fprintf(stderr, "%s: %s expects a non-negative integer, got '%s'\n", argv[0], argv[i], argv[i + 1]);
+				return false;
+			}
+
+			if (std::strcmp(argv[i], "--ticks") == 0 && value > 0)
+			{
+				parameters.Ticks = value;
+			}
+			else if (std::strcmp(argv[i], "--scenes") == 0)
+			{
+				parameters.Scenes = value;
+			}
+			else if (std::strcmp(argv[i], "--threads") == 0 && value > 0)
+			{
+				parameters.Threads = value;
+			}
+			else if (std::strcmp(argv[i], "--islands") == 0 && value <= 1)
+			{
+				parameters.Islands = value != 0;
+			}
+			else
+			{
+				std::fprintf(stderr, "%s: invalid argument %s %s\n", argv[0], argv[i], argv[i + 1]);
+				return false;
+			}
+		}
+		return true;
+	}
+
+	void SimulationUpdate(entity_registry& registry)
+	{
+		collider_set colliders = build_colliders(registry);
+		resolve_collisions(registry, colliders, static_cast<f32>(FixedTick_Period));
+		integrate(registry, static_cast<f32>(FixedTick_Period), wind_force, wall_boundaries_min, wall_boundaries_max);
+	}
+
+	int RunHeadless(HeadlessParameters const& parameters)
+	{
+		using clock = std::chrono::steady_clock;
+
+		Platform::JobSystem jobs(parameters.Threads);
+
+		uSize totalTicks = 0;
+		f64 totalSeconds = 0.0;
+		for (uSize scene = 0; scene < parameters.Scenes; ++scene)
+		{
+			entity_registry registry;
+			CreateBasicWorld(registry);
+			if (parameters.Islands)
+			{
+				set_island_jobs(registry, &jobs);
+			}
+			else
+			{
+				get_constraint_store(registry).workers = &jobs;
+			}
+
+			const auto start = clock::now();
+			for (uSize tick = 0; tick < parameters.Ticks; ++tick)
+			{
+				SimulationUpdate(registry);
+			}
+			const f64 seconds = std::chrono::duration<f64>(clock::now() - start).count();
+
+			totalTicks += parameters.Ticks;
+			totalSeconds += seconds;
+
+			std::printf("scene %zu: %zu ticks, %zu entities, %.3f s, %.1f ticks/s\n"
+				, scene, parameters.Ticks, uSize(registry.storage<entity_id>().in_use()), seconds
+				, seconds > 0.0 ? f64(parameters.Ticks) / seconds : 0.0);
+		}
+
+		std::printf("total: %zu scenes, %zu ticks, %.3f s, %.1f ticks/s\n"
+			, parameters.Scenes, totalTicks, totalSeconds
+			, totalSeconds > 0.0 ? f64(totalTicks) / totalSeconds : 0.0);
+		return 0;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	jm::HeadlessParameters parameters;
+	if (!jm::ParseParameters(argc, argv, parameters) || parameters.Help)
+	{
+		jm::PrintUsage(argv[0]);
+		return parameters.Help ? 0 : 1;
+	}
+	return jm::RunHeadless(parameters);
+}
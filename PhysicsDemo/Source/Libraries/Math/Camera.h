@@ -72,7 +72,7 @@ namespace jm::math
 
 		origin = look_from;
 
-		half_height = std::tanf(vert_fov * 0.5f);
+		half_height = std::tan(vert_fov * T(0.5));
 		half_width = aspect * half_height;
 
 		lower_left_corner = origin - focal_distance * half_width * right - focal_distance * half_height * up - focal_distance * back;
@@ -2,6 +2,9 @@
 
 #include "MathTypes.h"
 
+#include <algorithm>
+#include <array>
+
 namespace jm::math
 {
 	template <typename T>
@@ -26,6 +29,93 @@ namespace jm::math
 		vector3<T> direction{}; //assumes normalized
 	};
 
+	template <typename T>
+	struct aabb3
+	{
+		vector3<T> min{};
+		vector3<T> max{};
+	};
+
+	//the points p where dot(normal, p) + offset is zero, the normal points to the side that is kept
+	template <typename T>
+	struct plane3
+	{
+		vector3<T> normal{};
+		T offset{};
+	};
+
+	template <typename T>
+	struct frustum3
+	{
+		std::array<plane3<T>, 6> planes{}; //left, right, bottom, top, near, far
+	};
+
+	template <typename T>
+	aabb3<T> bounds(sphere3<T> const& sphere)
+	{
+		return { sphere.centre - vector3<T>(sphere.radius), sphere.centre + vector3<T>(sphere.radius) };
+	}
+
+	template <typename T>
+	aabb3<T> bounds(box3<T> const& box)
+	{
+		//world half size is the extents projected onto each world axis
+		const vector3<T> half = glm::abs(box.axes[0]) * box.extents.x + glm::abs(box.axes[1]) * box.extents.y + glm::abs(box.axes[2]) * box.extents.z;
+		return { box.position - half, box.position + half };
+	}
+
+	template <typename T>
+	aabb3<T> merge(aabb3<T> const& a, aabb3<T> const& b)
+	{
+		return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+	}
+
+	template <typename T>
+	aabb3<T> inflate(aabb3<T> const& a, T margin)
+	{
+		return { a.min - vector3<T>(margin), a.max + vector3<T>(margin) };
+	}
+
+	template <typename T>
+	T surface_area(aabb3<T> const& a)
+	{
+		const vector3<T> size = a.max - a.min;
+		return T(2) * (size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	template <typename T>
+	bool contains(aabb3<T> const& outer, aabb3<T> const& inner)
+	{
+		return glm::all(glm::lessThanEqual(outer.min, inner.min)) && glm::all(glm::lessThanEqual(inner.max, outer.max));
+	}
+
+	template <typename T>
+	bool intersects(aabb3<T> const& a, aabb3<T> const& b)
+	{
+		return glm::all(glm::lessThanEqual(a.min, b.max)) && glm::all(glm::lessThanEqual(b.min, a.max));
+	}
+
+	template <typename T>
+	bool intersects(aabb3<T> const& box, ray3<T> const& ray, T t_max, T& t)
+	{
+		//slab test, a zero direction component divides to +-infinity which the min/max handle
+		const vector3<T> inverse_direction = T(1) / ray.direction;
+		const vector3<T> t0 = (box.min - ray.origin) * inverse_direction;
+		const vector3<T> t1 = (box.max - ray.origin) * inverse_direction;
+		const vector3<T> t_near = glm::min(t0, t1);
+		const vector3<T> t_far = glm::max(t0, t1);
+
+		const T enter = std::max(std::max(t_near.x, t_near.y), std::max(t_near.z, T(0)));
+		const T exit = std::min(std::min(t_far.x, t_far.y), std::min(t_far.z, t_max));
+		if (enter > exit)
+		{
+			return false;
+		}
+
+		t = enter;
+		return true;
+	}
+
 	template <typename T>
 	bool intersects(sphere3<T> const& sphere, ray3<T> const& ray, T& t)
 	{
@@ -60,7 +150,8 @@ namespace jm::math
 	bool intersects(sphere3<T> const& a, sphere3<T> const& b)
 	{
 		const vector3<T> center_displacement = a.centre - b.centre;
-		return dot(center_displacement, center_displacement) < a.radius + b.radius + math::epsilon<T>();
+		const T reach = a.radius + b.radius;
+		return dot(center_displacement, center_displacement) < reach * reach + math::epsilon<T>();
 	}
 
 	template <typename T>
@@ -81,8 +172,37 @@ namespace jm::math
 		vector3<T> box_local_point = a.centre - b.position;
 		box_local_point = glm::transpose(b.axes) * box_local_point;
 
-		return std::abs(box_local_point.x) < b.extents.x + math::epsilon<T>() &&
-			std::abs(box_local_point.y) < b.extents.y + a.radius + math::epsilon<T>() &&
-			std::abs(box_local_point.z) < b.extents.z + a.radius + math::epsilon<T>();
+		//distance to the closest point of the box
+		const vector3<T> outside = box_local_point - glm::clamp(box_local_point, -b.extents, b.extents);
+		return dot(outside, outside) < a.radius * a.radius + math::epsilon<T>();
+	}
+
+	//the planes bounding what a projection view matrix maps into clip space, by adding and subtracting its rows (Gribb and Hartmann)
+	//the far plane of an infinite projection has no normal, it is kept with a positive offset so nothing is ever outside it
+	template <typename T>
+	frustum3<T> frustum(matrix44<T> const& projection_view)
+	{
+		const matrix44<T> rows = glm::transpose(projection_view);
+		frustum3<T> result;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			for (int side = 0; side < 2; ++side)
+			{
+				const vector4<T> row = side == 0 ? rows[3] + rows[axis] : rows[3] - rows[axis];
+				const T row_length = length(vector3<T>(row));
+				result.planes[2 * axis + side] = row_length > T(0) ? plane3<T>{ vector3<T>(row) / row_length, row.w / row_length } : plane3<T>{ vector3<T>{}, T(1) };
+			}
+		}
+		return result;
+	}
+
+	//touching counts as inside, what is culled must be entirely outside one plane
+	template <typename T>
+	bool intersects(frustum3<T> const& frustum, sphere3<T> const& sphere)
+	{
+		return std::all_of(frustum.planes.begin(), frustum.planes.end(), [&sphere](plane3<T> const& plane)
+			{
+				return dot(plane.normal, sphere.centre) + plane.offset + sphere.radius >= T(0);
+			});
 	}
-}
\ No newline at end of file
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "MathTypes.h"
+
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace jm::math
+{
+	//triangles sharing their vertices, each side stored as a half edge that knows the matching one in the triangle across it
+	//triangle t owns half edges 3t, 3t + 1 and 3t + 2, each starting at one of its corners and ending at the next,
+	//so appending a triangle is amortised O(1) and walking around a vertex never searches
+	template <typename TVertex>
+	class half_edge_mesh
+	{
+	public:
+
+		static constexpr u32 invalid = std::numeric_limits<u32>::max();
+
+		struct half_edge
+		{
+			u32 vertex; //where it starts
+			u32 twin = invalid; //the same side walked the other way by the neighbouring triangle, invalid on a boundary
+		};
+
+		explicit half_edge_mesh(std::vector<TVertex> vertices)
+			: vertices(std::move(vertices))
+			, outgoing(this->vertices.size(), invalid)
+		{
+		}
+
+		//returns the index of the first one added
+		u32 add_vertices(std::vector<TVertex> const& values)
+		{
+			const u32 first = (u32)vertices.size();
+			vertices.insert(vertices.end(), values.begin(), values.end());
+			outgoing.resize(vertices.size(), invalid);
+			return first;
+		}
+
+		//corners in winding order, triangles sharing a side must walk it in opposite directions
+		u32 add_triangle(u32 a, u32 b, u32 c)
+		{
+			JM_MATH_ASSERT(a < vertices.size() && b < vertices.size() && c < vertices.size());
+			JM_MATH_ASSERT(a != b && b != c && c != a);
+
+			const u32 triangle = triangle_count();
+			const u32 corners[3] = { a, b, c };
+			for (u32 corner = 0; corner < 3; ++corner)
+			{
+				const u32 from = corners[corner];
+				const u32 to = corners[(corner + 1) % 3];
+				const u32 edge = 3 * triangle + corner;
+				half_edges.push_back({ from });
+
+				//a side already walked the other way is closed by this one, otherwise it waits for its twin
+				auto found = open_edges.find(get_key(to, from));
+				if (found != open_edges.end())
+				{
+					half_edges[edge].twin = found->second;
+					half_edges[found->second].twin = edge;
+					open_edges.erase(found);
+				}
+				else
+				{
+					JM_MATH_ASSERT(!open_edges.contains(get_key(from, to)), "Side already has a triangle walking it this way!");
+					open_edges.emplace(get_key(from, to), edge);
+				}
+
+				if (outgoing[from] == invalid)
+				{
+					outgoing[from] = edge;
+				}
+			}
+			return triangle;
+		}
+
+		static u32 next(u32 edge) { return edge % 3 == 2 ? edge - 2 : edge + 1; }
+		static u32 prev(u32 edge) { return edge % 3 == 0 ? edge + 2 : edge - 1; }
+
+		u32 twin(u32 edge) const { return half_edges[edge].twin; }
+		u32 start(u32 edge) const { return half_edges[edge].vertex; }
+		u32 end(u32 edge) const { return half_edges[next(edge)].vertex; }
+
+		u32 vertex_count() const { return (u32)vertices.size(); }
+		u32 triangle_count() const { return (u32)(half_edges.size() / 3); }
+		u32 half_edge_count() const { return (u32)half_edges.size(); }
+
+		std::vector<TVertex> const& get_vertices() const { return vertices; }
+		TVertex const& get_vertex(u32 vertex) const { return vertices[vertex]; }
+		std::vector<half_edge> const& get_half_edges() const { return half_edges; }
+
+		vector3<u32> get_triangle(u32 triangle) const
+		{
+			return { half_edges[3 * triangle].vertex, half_edges[3 * triangle + 1].vertex, half_edges[3 * triangle + 2].vertex };
+		}
+
+		//calls function with every vertex sharing a side with this one, once each on a manifold mesh
+		template <typename Fxn>
+		void for_each_neighbour(u32 vertex, Fxn&& function) const
+		{
+			const u32 first = outgoing[vertex];
+			if (first == invalid)
+			{
+				return;
+			}
+
+			//turn one way through the triangles around the vertex, each one's previous side comes back into it
+			u32 edge = first;
+			while (true)
+			{
+				function(end(edge));
+				const u32 incoming = prev(edge);
+				if (twin(incoming) == invalid)
+				{
+					//a boundary, the side coming back has no triangle beyond it so its start is only reached here
+					function(start(incoming));
+					break;
+				}
+				edge = twin(incoming);
+				if (edge == first)
+				{
+					return;
+				}
+			}
+
+			//and the other way from the first, until the boundary on that side
+			edge = first;
+			while (twin(edge) != invalid)
+			{
+				edge = next(twin(edge));
+				function(end(edge));
+			}
+		}
+
+	private:
+
+		static u64 get_key(u32 from, u32 to) { return (u64(from) << 32) | to; }
+
+		std::vector<TVertex> vertices;
+		std::vector<half_edge> half_edges;
+		std::vector<u32> outgoing; //a half edge starting at each vertex, invalid until a triangle uses it
+		std::unordered_map<u64, u32> open_edges; //half edges still without a twin, keyed on their start and end
+	};
+}
@@ -19,6 +19,14 @@ namespace jm::math
 		quaternion<T> orientation{};
 	};
 
+	//lerp the position and nlerp the orientation the short way round, for blending two transforms a tick apart
+	template <typename T>
+	rigid_motion3<T> interpolate(rigid_motion3<T> const& from, rigid_motion3<T> const& to, T alpha)
+	{
+		const T sign = dot(from.orientation, to.orientation) < T(0) ? T(-1) : T(1);
+		return { lerp(alpha, from.position, to.position), normalize(from.orientation * (T(1) - alpha) + to.orientation * (sign * alpha)) };
+	}
+
 	template <typename T>
 	struct linear_body2
 	{
@@ -91,6 +99,62 @@ namespace jm::math
 		value += (delta_t * (last_derivative + derivative) * 0.5f);
 	}
 
+	//integrators advance a position and velocity by delta_t under acceleration(position, velocity)
+	//values only need +, - and * by a scalar, so the same step runs on glm vectors and on simd lanes
+	//steps are forced inline so they take on the instruction set of the kernel calling them
+
+	//semi-implicit euler, the new velocity carries the position, first order but symplectic
+	struct symplectic_euler
+	{
+		static constexpr cstring name = "symplectic_euler";
+
+		template <typename V, typename T, typename A>
+		static JM_FORCE_INLINE void step(V& position, V& velocity, T delta_t, A const& acceleration)
+		{
+			velocity = velocity + acceleration(position, velocity) * delta_t;
+			position = position + velocity * delta_t;
+		}
+	};
+
+	//position verlet as drift, kick, drift, second order and symplectic
+	//the kick sees the velocity half a step on, so velocity dependent forces such as damping stay second order too
+	struct position_verlet
+	{
+		static constexpr cstring name = "position_verlet";
+
+		template <typename V, typename T, typename A>
+		static JM_FORCE_INLINE void step(V& position, V& velocity, T delta_t, A const& acceleration)
+		{
+			const T half_t = delta_t * T(0.5);
+			const V midpoint = position + velocity * half_t;
+			const V midvelocity = velocity + acceleration(position, velocity) * half_t;
+			velocity = velocity + acceleration(midpoint, midvelocity) * delta_t;
+			position = midpoint + velocity * half_t;
+		}
+	};
+
+	//classic fourth order runge kutta, four accelerations per step and not symplectic, so energy drifts slowly rather than oscillating
+	struct runge_kutta4
+	{
+		static constexpr cstring name = "runge_kutta4";
+
+		template <typename V, typename T, typename A>
+		static JM_FORCE_INLINE void step(V& position, V& velocity, T delta_t, A const& acceleration)
+		{
+			const T half_t = delta_t * T(0.5);
+			const T sixth_t = delta_t * (T(1) / T(6));
+			const V a1 = acceleration(position, velocity);
+			const V v2 = velocity + a1 * half_t;
+			const V a2 = acceleration(position + velocity * half_t, v2);
+			const V v3 = velocity + a2 * half_t;
+			const V a3 = acceleration(position + v2 * half_t, v3);
+			const V v4 = velocity + a3 * delta_t;
+			const V a4 = acceleration(position + v3 * delta_t, v4);
+			position = position + (velocity + (v2 + v3) * T(2) + v4) * sixth_t;
+			velocity = velocity + (a1 + (a2 + a3) * T(2) + a4) * sixth_t;
+		}
+	};
+
 	template <typename T>
 	quaternion<T> get_spin(quaternion<T> const& orientation, vector3<T> const& angular_velocity)
 	{
@@ -98,7 +98,7 @@ namespace jm::math::random
 	inline vector2<T> unit_circle()
 	{
 		const T theta = angle<T>();
-		return vector2<T>{ cos(theta), sin(theta) };
+		return vector2<T>{ std::cos(theta), std::sin(theta) };
 	}
 
 	template <typename T>
@@ -111,7 +111,7 @@ namespace jm::math::random
 	inline vector3<T> unit_sphere()
 	{
 		const T phi = angle<T>() * 0.5f;
-		return { sin(phi) * unit_circle<T>(), cos(phi) };
+		return { std::sin(phi) * unit_circle<T>(), std::cos(phi) };
 	}
 
 	template <typename T>
@@ -0,0 +1,24 @@
+#include "CommandLine.h"
+
+#include <cerrno>
+#include <cstdlib>
+
+namespace jm::Platform
+{
+	bool ParseCount(cstring text, uSize& value)
+	{
+		if (text[0] < '0' || text[0] > '9')
+		{
+			return false;
+		}
+		char* end = nullptr;
+		errno = 0;
+		const unsigned long long parsed = std::strtoull(text, &end, 10);
+		if (errno != 0 || *end != '\0')
+		{
+			return false;
+		}
+		value = uSize(parsed);
+		return true;
+	}
+}
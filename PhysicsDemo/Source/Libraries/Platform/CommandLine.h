@@ -0,0 +1,9 @@
+#pragma once
+
+#include "PlatformCore.h"
+
+namespace jm::Platform
+{
+	//a whole argument of decimal digits, no sign, whitespace or trailing text, false leaves value untouched
+	bool ParseCount(cstring text, uSize& value);
+}
@@ -0,0 +1,58 @@
+#include "CpuFeatures.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+namespace jm::Platform
+{
+	cstring GetSimdLevelName(SimdLevel level)
+	{
+		switch (level)
+		{
+		case SimdLevel::SSE4: return "sse4";
+		case SimdLevel::AVX2: return "avx2";
+		default: return "scalar";
+		}
+	}
+
+	SimdLevel ProbeSimdLevel()
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		int info[4];
+		__cpuid(info, 0);
+		const int maxLeaf = info[0];
+		if (maxLeaf < 1)
+		{
+			return SimdLevel::Scalar;
+		}
+
+		__cpuid(info, 1);
+		const bool sse41 = (info[2] & (1 << 19)) != 0;
+		const bool avx = (info[2] & (1 << 28)) != 0;
+		const bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx2 = false;
+		if (avx && osxsave && maxLeaf >= 7 && (_xgetbv(0) & 0x6) == 0x6) //xmm and ymm state enabled
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+		return avx2 ? SimdLevel::AVX2 : sse41 ? SimdLevel::SSE4 : SimdLevel::Scalar;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return SimdLevel::AVX2;
+		}
+		return __builtin_cpu_supports("sse4.1") ? SimdLevel::SSE4 : SimdLevel::Scalar;
+#else
+		return SimdLevel::Scalar;
+#endif
+	}
+
+	SimdLevel GetSupportedSimdLevel()
+	{
+		static const SimdLevel level = ProbeSimdLevel();
+		return level;
+	}
+}
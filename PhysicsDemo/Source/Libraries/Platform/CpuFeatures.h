@@ -0,0 +1,19 @@
+#pragma once
+
+#include "PlatformCore.h"
+
+namespace jm::Platform
+{
+	//widest vector instruction set a kernel may use, ordered so a higher level implies the lower ones
+	enum class SimdLevel : u8
+	{
+		Scalar,
+		SSE4, //sse4.1, 4 floats per instruction
+		AVX2, //8 floats per instruction
+	};
+
+	cstring GetSimdLevelName(SimdLevel level);
+
+	//probed once, includes the check that the os saves the wide registers
+	SimdLevel GetSupportedSimdLevel();
+}
@@ -12,7 +12,11 @@ namespace jm::Platform
 {
 	bool HasDebugger()
 	{
+#if JM_ON_WINDOWS
 		return IsDebuggerPresent();
+#else
+		return false;
+#endif
 	}
 }
 
@@ -39,12 +43,16 @@ namespace jm
 
 		std::string MakeDebugString(Location location, cstring message)
 		{
-			constexpr DWORD size = 255;
-			char rawModuleName[size];
+			constexpr u32 size = 255;
+			char rawModuleName[size] = {};
 
 			::std::ostringstream debugStream;
 
+#if JM_ON_WINDOWS
 			if (GetModuleFileNameA(NULL, rawModuleName, size) < size)
+#else
+			if (readlink("/proc/self/exe", rawModuleName, size - 1) > 0)
+#endif
 			{
 				std::string moduleName{ rawModuleName };
 				std::string fileName{ location.fileName };
@@ -66,7 +74,11 @@ namespace jm
 
 		void Log(cstring message)
 		{
+#if JM_ON_WINDOWS
 			OutputDebugStringA(message);
+#else
+			std::cerr << message;
+#endif
 		}
 	}
 }
\ No newline at end of file
@@ -48,9 +48,15 @@ namespace jm::Debugger
 	extern void Log(cstring message);
 }
 
+#if JM_ON_WINDOWS
 #define JM_LIKELY(condition) __assume(condition)
 
 # define JM_BREAK if(::jm::Platform::HasDebugger()) { __debugbreak(); } std::exit(0)
+#else
+#define JM_LIKELY(condition) do { if (!(condition)) { __builtin_unreachable(); } } while(false)
+
+# define JM_BREAK if(::jm::Platform::HasDebugger()) { __builtin_trap(); } std::exit(0)
+#endif
 
 #define __JM_DEBUG_STRING(project, ...) \
 ::jm::Debugger::MakeDebugString({__LINE__, __FILE__, project}, __VA_ARGS__).c_str()
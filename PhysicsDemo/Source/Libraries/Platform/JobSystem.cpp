@@ -0,0 +1,217 @@
+#include "JobSystem.h"
+
+#include "PlatformDebug.h"
+
+#include <algorithm>
+
+namespace jm::Platform
+{
+	//which system the current thread works for, and its deque there
+	thread_local JobSystem const* CurrentJobSystem = nullptr;
+	thread_local uSize CurrentQueueIndex = 0;
+
+	//the owner may destroy a counter as soon as Pending reads zero, so the parent is read before the count moves and nothing after it touches this
+	void JobCounter::Add()
+	{
+		//the first pending job opens the parent, it stays open until this counter drains
+		JobCounter* parent = Parent;
+		if (Pending.fetch_add(1, std::memory_order_acq_rel) == 0 && parent != nullptr)
+		{
+			parent->Add();
+		}
+	}
+
+	void JobCounter::Finish()
+	{
+		//the parent cannot drain before this call finishes it, so it is still alive here even if this counter is not
+		JobCounter* parent = Parent;
+		if (Pending.fetch_sub(1, std::memory_order_acq_rel) == 1 && parent != nullptr)
+		{
+			parent->Finish();
+		}
+	}
+
+	JobSystem::JobSystem(uSize threadCount)
+	{
+		const uSize queueCount = std::max<uSize>(threadCount, 1);
+		Queues.reserve(queueCount);
+		for (uSize i = 0; i < queueCount; ++i)
+		{
+			Queues.push_back(std::make_unique<WorkQueue>());
+		}
+
+		Workers.reserve(queueCount - 1);
+		for (uSize i = 1; i < queueCount; ++i)
+		{
+			Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard lock(SleepMutex);
+			Stopping = true;
+		}
+		WakeCondition.notify_all();
+
+		for (std::thread& worker : Workers)
+		{
+			worker.join();
+		}
+	}
+
+	uSize JobSystem::GetQueueIndex() const
+	{
+		return CurrentJobSystem == this ? CurrentQueueIndex : 0;
+	}
+
+	void JobSystem::Run(JobCounter& counter, JobTask task)
+	{
+		counter.Add();
+		{
+			WorkQueue& queue = *Queues[GetQueueIndex()];
+			std::lock_guard lock(queue.Mutex);
+			queue.Jobs.push_back({ std::move(task), &counter });
+		}
+		QueuedJobs.fetch_add(1, std::memory_order_release);
+
+		//taking the lock orders this with a worker about to sleep, so the wake is not lost
+		if (!Workers.empty())
+		{
+			{
+				std::lock_guard lock(SleepMutex);
+			}
+			WakeCondition.notify_one();
+		}
+	}
+
+	void JobSystem::Wait(JobCounter const& counter)
+	{
+		const uSize queueIndex = GetQueueIndex();
+		while (!counter.IsDone())
+		{
+			if (!TryRunJob(queueIndex))
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	void JobSystem::ParallelFor(uSize count, uSize grainSize, RangeTask const& task)
+	{
+		JM_PLATFORM_ASSERT(grainSize > 0);
+
+		const uSize chunkCount = (count + grainSize - 1) / grainSize;
+		if (Workers.empty() || chunkCount <= 1)
+		{
+			if (count > 0)
+			{
+				task(0, count);
+			}
+			return;
+		}
+
+		std::atomic<uSize> nextChunk = 0;
+		auto run_chunks = [&task, &nextChunk, count, grainSize, chunkCount]()
+			{
+				for (uSize chunk = nextChunk.fetch_add(1); chunk < chunkCount; chunk = nextChunk.fetch_add(1))
+				{
+					const uSize begin = chunk * grainSize;
+					task(begin, std::min(begin + grainSize, count));
+				}
+			};
+
+		//a helper that starts late finds every chunk claimed and returns at once
+		JobCounter counter;
+		const uSize helperCount = std::min(Queues.size(), chunkCount) - 1;
+		for (uSize i = 0; i < helperCount; ++i)
+		{
+			Run(counter, run_chunks);
+		}
+		run_chunks();
+		Wait(counter);
+	}
+
+	bool JobSystem::TryRunJob(uSize queueIndex)
+	{
+		Job job;
+		{
+			WorkQueue& queue = *Queues[queueIndex];
+			std::unique_lock lock(queue.Mutex);
+			if (queue.Jobs.empty())
+			{
+				lock.unlock();
+				if (!TrySteal(queueIndex))
+				{
+					return false;
+				}
+				lock.lock();
+				if (queue.Jobs.empty())
+				{
+					return false;
+				}
+			}
+			//newest first, it is the most likely to still be in cache
+			job = std::move(queue.Jobs.back());
+			queue.Jobs.pop_back();
+		}
+		QueuedJobs.fetch_sub(1, std::memory_order_acq_rel);
+
+		//the task's captures go before the count drops, the waiter may free what they refer to as soon as it does
+		job.Task();
+		job.Task = nullptr;
+		job.Counter->Finish();
+		return true;
+	}
+
+	bool JobSystem::TrySteal(uSize queueIndex)
+	{
+		std::vector<Job> stolen;
+		for (uSize offset = 1; offset < Queues.size() && stolen.empty(); ++offset)
+		{
+			WorkQueue& victim = *Queues[(queueIndex + offset) % Queues.size()];
+			std::lock_guard lock(victim.Mutex);
+
+			//oldest half, rounded up so a single job can be stolen
+			const uSize count = (victim.Jobs.size() + 1) / 2;
+			for (uSize i = 0; i < count; ++i)
+			{
+				stolen.push_back(std::move(victim.Jobs.front()));
+				victim.Jobs.pop_front();
+			}
+		}
+		if (stolen.empty())
+		{
+			return false;
+		}
+
+		WorkQueue& queue = *Queues[queueIndex];
+		std::lock_guard lock(queue.Mutex);
+		for (Job& job : stolen)
+		{
+			queue.Jobs.push_back(std::move(job));
+		}
+		return true;
+	}
+
+	void JobSystem::WorkerLoop(uSize queueIndex)
+	{
+		CurrentJobSystem = this;
+		CurrentQueueIndex = queueIndex;
+		while (true)
+		{
+			if (TryRunJob(queueIndex))
+			{
+				continue;
+			}
+
+			std::unique_lock lock(SleepMutex);
+			WakeCondition.wait(lock, [this]() { return Stopping || QueuedJobs.load(std::memory_order_acquire) != 0; });
+			if (Stopping)
+			{
+				return;
+			}
+		}
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "PlatformCore.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace jm::Platform
+{
+	//counts unfinished jobs and must outlive them, a counter made with a parent keeps the parent unfinished while it has jobs of its own
+	class JobCounter
+	{
+	public:
+
+		JobCounter() = default;
+		explicit JobCounter(JobCounter* parent) : Parent(parent) {}
+
+		bool IsDone() const { return Pending.load(std::memory_order_acquire) == 0; }
+
+	private:
+
+		friend class JobSystem;
+
+		JobCounter(JobCounter const&) = delete;
+		JobCounter& operator=(JobCounter const&) = delete;
+
+		void Add();
+		void Finish();
+
+		std::atomic<u32> Pending = 0;
+		JobCounter* Parent = nullptr;
+	};
+
+	//work stealing scheduler, every thread owns a deque it pushes and pops at the back
+	//idle threads steal half of another deque from the front, so big batches spread out in a few steals
+	//threads outside the system share the first deque
+	class JobSystem
+	{
+	public:
+
+		using JobTask = std::function<void()>;
+		using RangeTask = std::function<void(uSize begin, uSize end)>;
+
+		explicit JobSystem(uSize threadCount = std::thread::hardware_concurrency());
+
+		~JobSystem();
+
+		//includes the calling thread
+		uSize GetThreadCount() const { return Queues.size(); }
+
+		//queues the task on the calling thread's deque, jobs may run more jobs on the same or a child counter
+		void Run(JobCounter& counter, JobTask task);
+
+		//runs queued jobs on the calling thread until every job on the counter and its children has finished
+		void Wait(JobCounter const& counter);
+
+		//blocks until every chunk of [0, count) has run, chunks are at most grainSize long
+		//one job per helper thread claims chunks in order, the calling thread claims them too and may be called from inside a job
+		void ParallelFor(uSize count, uSize grainSize, RangeTask const& task);
+
+	private:
+
+		struct Job
+		{
+			JobTask Task;
+			JobCounter* Counter;
+		};
+
+		struct alignas(64) WorkQueue
+		{
+			std::mutex Mutex;
+			std::deque<Job> Jobs;
+		};
+
+		JobSystem(JobSystem&) = delete;
+		JobSystem& operator=(JobSystem&) = delete;
+
+		void WorkerLoop(uSize queueIndex);
+		uSize GetQueueIndex() const;
+		bool TryRunJob(uSize queueIndex);
+		bool TrySteal(uSize queueIndex);
+
+		std::vector<std::unique_ptr<WorkQueue>> Queues;
+		std::vector<std::thread> Workers;
+
+		std::mutex SleepMutex;
+		std::condition_variable WakeCondition;
+		std::atomic<uSize> QueuedJobs = 0;
+		bool Stopping = false;
+	};
+}
@@ -1,6 +1,7 @@
 #include "Modal.h"
 
 #include "OS.h"
+#include "Debugger.h"
 
 #include <cassert>
 #include <sstream>
@@ -15,11 +16,14 @@ namespace jm::Platform
 		std::ostringstream text;
 		text << message << "\n\nDo you want to " << verb << "?";
 
-#ifdef JM_ON_WINDOWS
+#if JM_ON_WINDOWS
 		UINT type = MB_YESNO | MB_ICONEXCLAMATION | MB_DEFBUTTON1 | MB_APPLMODAL;
 		INT affirmation = MessageBoxA(NULL, text.str().c_str(), title, type);
 		assert((affirmation == IDYES) ^ (affirmation == IDNO));
 		return (affirmation == IDYES);
+#else
+		//no modal without a window, only stop if someone is attached to catch it
+		return HasDebugger();
 #endif
 	}
 
@@ -32,4 +32,7 @@
 #define _CRT_SECURE_NO_WARNINGS
 #include <Windows.h>
 
+#elif JM_ON_LINUX
+#include <unistd.h>
+
 #endif
\ No newline at end of file
@@ -3,11 +3,13 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstddef>
+#include <cmath>
 #include <vector>
 #include <string>
 
 
 #define JM_ON_WINDOWS 0
+#define JM_ON_LINUX 0
 #define JM_ON_32BIT 0
 #define JM_ON_64BIT 0
 
@@ -21,6 +23,16 @@
 #undef JM_ON_32BIT
 #define JM_ON_32BIT 1
 #	endif
+#elif defined(__linux__)
+#undef JM_ON_LINUX
+#define JM_ON_LINUX 1
+#	if defined(__x86_64__) || defined(__aarch64__)
+#undef JM_ON_64BIT
+#define JM_ON_64BIT 1
+#	else
+#undef JM_ON_32BIT
+#define JM_ON_32BIT 1
+#	endif
 #else
 #	error "Unknown OS!"
 #endif
@@ -29,10 +41,17 @@
 #define bitsizeof(Type) \
 static_cast<std::size_t>(sizeof(Type) * 8)
 
+#ifdef _MSC_VER
+#define JM_FORCE_INLINE __forceinline
+#else
+#define JM_FORCE_INLINE inline __attribute__((always_inline))
+#endif
+
 
 namespace jm
 {
 	constexpr bool OnWindows = static_cast<bool>(JM_ON_WINDOWS);
+	constexpr bool OnLinux = static_cast<bool>(JM_ON_LINUX);
 	constexpr bool On32bit = static_cast<bool>(JM_ON_32BIT);
 	constexpr bool On64bit = static_cast<bool>(JM_ON_64BIT);
 
@@ -103,7 +122,7 @@ namespace jm
 		u64 hash = 5381;
 		i32 c = 0;
 
-		while (static_cast<bool>(c = *hashedString++))
+		while ((c = *hashedString++) != 0)
 		{
 			hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
 		}
@@ -0,0 +1,59 @@
+#include "StepScheduler.h"
+
+#include <chrono>
+#include <cmath>
+
+namespace jm::Platform
+{
+	StepScheduler::StepScheduler(f64 tickPeriod, f64 tickBudget, f64 maxFrameTime)
+		: TickPeriod(tickPeriod)
+		, TickBudget(tickBudget)
+		, MaxFrameTime(maxFrameTime)
+	{
+	}
+
+	uSize StepScheduler::Advance(f64 frameTime, TickTask const& tick)
+	{
+		using clock = std::chrono::steady_clock;
+
+		f64 dropped = 0.0;
+		if (frameTime > MaxFrameTime)
+		{
+			dropped += frameTime - MaxFrameTime;
+			frameTime = MaxFrameTime;
+		}
+		Accumulator += frameTime;
+
+		const auto start = clock::now();
+		uSize ticks = 0;
+		while (Accumulator >= TickPeriod)
+		{
+			if (ticks != 0 && std::chrono::duration<f64>(clock::now() - start).count() >= TickBudget)
+			{
+				//keep the fraction of a tick so alpha stays continuous
+				const f64 wholeTicks = std::floor(Accumulator / TickPeriod);
+				dropped += wholeTicks * TickPeriod;
+				Accumulator -= wholeTicks * TickPeriod;
+				break;
+			}
+
+			tick();
+			Accumulator -= TickPeriod;
+			++ticks;
+		}
+
+		if (ticks != 0)
+		{
+			const f64 tickTime = std::chrono::duration<f64>(clock::now() - start).count() / f64(ticks);
+			Statistics.AverageTickTime = Statistics.Ticks == 0 ? tickTime : Statistics.AverageTickTime + 0.01 * (tickTime - Statistics.AverageTickTime);
+		}
+		Statistics.Ticks += ticks;
+		Statistics.LastFrameTicks = ticks;
+		if (dropped > 0.0)
+		{
+			++Statistics.DroppedFrames;
+			Statistics.DroppedTime += dropped;
+		}
+		return ticks;
+	}
+}
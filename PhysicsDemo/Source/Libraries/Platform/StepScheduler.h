@@ -0,0 +1,54 @@
+#pragma once
+
+#include "PlatformCore.h"
+
+#include <functional>
+
+namespace jm::Platform
+{
+	//fixed step clock, each frame runs as many ticks as the real time since the last one covers
+	//ticks stop once the frame has spent its budget on them and the whole ticks left over are dropped,
+	//so a machine that cannot keep up runs the simulation slower instead of falling further behind every frame
+	class StepScheduler
+	{
+	public:
+
+		using TickTask = std::function<void()>;
+
+		struct Stats
+		{
+			uSize Ticks = 0;
+			uSize LastFrameTicks = 0;
+			uSize DroppedFrames = 0; //frames that gave up time, to the budget or the frame time limit
+			f64 DroppedTime = 0.0; //seconds of real time the simulation never ran
+			f64 AverageTickTime = 0.0; //seconds of real time per tick, smoothed over about the last hundred frames
+		};
+
+		//the budget bounds the real time spent ticking in one frame, at least one due tick always runs
+		//frames longer than maxFrameTime, a breakpoint or a dragged window, only count for that long
+		explicit StepScheduler(f64 tickPeriod, f64 tickBudget = 0.01, f64 maxFrameTime = 0.25);
+
+		//adds the frame's real time and runs the ticks it covers, returns how many ran
+		uSize Advance(f64 frameTime, TickTask const& tick);
+
+		//forgets the time not yet ticked, call while paused so resuming does not catch up
+		void Reset() { Accumulator = 0.0; }
+
+		//how far the present is between the last tick and the next, in [0, 1) for interpolating what is drawn
+		f64 GetAlpha() const { return Accumulator / TickPeriod; }
+
+		f64 GetTickPeriod() const { return TickPeriod; }
+		f64 GetTickBudget() const { return TickBudget; }
+		void SetTickBudget(f64 seconds) { TickBudget = seconds; }
+
+		Stats const& GetStats() const { return Statistics; }
+
+	private:
+
+		f64 TickPeriod;
+		f64 TickBudget;
+		f64 MaxFrameTime;
+		f64 Accumulator = 0.0;
+		Stats Statistics;
+	};
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "PlatformCore.h"
+
+#include <array>
+#include <atomic>
+
+namespace jm::Platform
+{
+	//hands whole values from one writer thread to one reader thread without locks
+	//the writer and reader each own a buffer and swap it with the shared middle one, so neither ever waits for the other
+	//the reader sees the latest published value and skips any it was too slow for
+	template <typename T>
+	class TripleBuffer
+	{
+	public:
+
+		TripleBuffer() = default;
+
+		//only the writer may touch this, it keeps its contents from three publishes ago
+		T& GetWriteBuffer() { return Buffers[WriteIndex]; }
+
+		void Publish()
+		{
+			WriteIndex = Shared.exchange(WriteIndex | FreshBit, std::memory_order_acq_rel) & IndexMask;
+		}
+
+		//swaps in the latest published value, false when nothing new was published since the last call
+		bool Acquire()
+		{
+			if ((Shared.load(std::memory_order_relaxed) & FreshBit) == 0)
+			{
+				return false;
+			}
+			ReadIndex = Shared.exchange(ReadIndex, std::memory_order_acq_rel) & IndexMask;
+			return true;
+		}
+
+		//only the reader may touch this, it stays valid until the next Acquire
+		T const& GetReadBuffer() const { return Buffers[ReadIndex]; }
+
+	private:
+
+		static constexpr u8 IndexMask = 3;
+		static constexpr u8 FreshBit = 4;
+
+		TripleBuffer(TripleBuffer const&) = delete;
+		TripleBuffer& operator=(TripleBuffer const&) = delete;
+
+		std::array<T, 3> Buffers{};
+		alignas(64) u8 WriteIndex = 0; //apart from ReadIndex and Shared so the two threads do not share a cache line
+		alignas(64) u8 ReadIndex = 1;
+		alignas(64) std::atomic<u8> Shared = 2;
+	};
+}
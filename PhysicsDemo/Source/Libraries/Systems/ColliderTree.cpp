@@ -0,0 +1,442 @@
+#include "ColliderTree.h"
+#include "Components.h"
+
+#include <algorithm>
+#include <optional>
+
+namespace jm
+{
+	constexpr u32 null_node = collider_tree_node::null_node;
+	constexpr size_t BulkInsertThreshold = 64; //pending collidables before the tree is rebuilt instead of inserted into
+
+	void queue_collider(entity_registry& registry, entity_id entity)
+	{
+		registry.ctx().get<collider_tree>().pending.push_back(entity);
+	}
+
+	//destroying an entity empties its pools newest first, so the proxy is gone before collidable_component's signal fires
+	//the leaf is released from the proxy's own signal, dropping collidable_component from a live entity drops the proxy with it
+	void release_collider(entity_registry& registry, entity_id entity)
+	{
+		registry.remove<collider_proxy_component>(entity);
+	}
+
+	void release_proxy(entity_registry& registry, entity_id entity)
+	{
+		if (collider_proxy_component const& proxy = registry.get<collider_proxy_component>(entity); proxy.node != null_node)
+		{
+			remove_leaf(registry.ctx().get<collider_tree>(), proxy.node);
+		}
+	}
+
+	collider_tree& get_collider_tree(entity_registry& registry)
+	{
+		if (collider_tree* tree = registry.ctx().find<collider_tree>())
+		{
+			return *tree;
+		}
+
+		collider_tree& tree = registry.ctx().emplace<collider_tree>();
+		for (entity_id entity : registry.view<collidable_component>())
+		{
+			tree.pending.push_back(entity);
+		}
+		registry.on_construct<collidable_component>().connect<&queue_collider>();
+		registry.on_destroy<collidable_component>().connect<&release_collider>();
+		registry.on_destroy<collider_proxy_component>().connect<&release_proxy>();
+		return tree;
+	}
+
+	std::optional<math::aabb3<f32>> collider_bounds(entity_registry const& registry, entity_id entity, spatial3_component const& spatial)
+	{
+		if (sphere_shape_component const* sphere = registry.try_get<sphere_shape_component>(entity))
+		{
+			return math::bounds(math::sphere3<f32>{ spatial.position, sphere->radius });
+		}
+		if (box_shape_component const* box = registry.try_get<box_shape_component>(entity))
+		{
+			return math::bounds(math::box3<f32>{ spatial.position, box->extents, math::quat_to_mat(spatial.orientation) });
+		}
+		return std::nullopt;
+	}
+
+	u32 allocate_node(collider_tree& tree)
+	{
+		if (tree.free_list == null_node)
+		{
+			tree.nodes.emplace_back();
+			return static_cast<u32>(tree.nodes.size() - 1);
+		}
+
+		const u32 node = tree.free_list;
+		tree.free_list = tree.nodes[node].parent;
+		tree.nodes[node] = {};
+		return node;
+	}
+
+	void free_node(collider_tree& tree, u32 node)
+	{
+		tree.nodes[node] = {};
+		tree.nodes[node].parent = tree.free_list;
+		tree.nodes[node].height = -1;
+		tree.free_list = node;
+	}
+
+	//AVL style rotation, promotes the taller grandchild when the children of a differ in height by more than one
+	u32 balance(collider_tree& tree, u32 a)
+	{
+		collider_tree_node& A = tree.nodes[a];
+		if (A.is_leaf() || A.height < 2)
+		{
+			return a;
+		}
+
+		const u32 b = A.left;
+		const u32 c = A.right;
+		const i32 skew = tree.nodes[c].height - tree.nodes[b].height;
+		if (skew > -2 && skew < 2)
+		{
+			return a;
+		}
+
+		//rotate the taller child (up) above a, its shorter child (down) takes the taller child's old place under a
+		const u32 up = skew > 0 ? c : b;
+		const u32 other = skew > 0 ? b : c;
+		collider_tree_node& Up = tree.nodes[up];
+		const u32 f = Up.left;
+		const u32 g = Up.right;
+
+		Up.left = a;
+		Up.parent = A.parent;
+		A.parent = up;
+		if (Up.parent == null_node)
+		{
+			tree.root = up;
+		}
+		else if (tree.nodes[Up.parent].left == a)
+		{
+			tree.nodes[Up.parent].left = up;
+		}
+		else
+		{
+			tree.nodes[Up.parent].right = up;
+		}
+
+		const bool keepF = tree.nodes[f].height > tree.nodes[g].height;
+		const u32 keep = keepF ? f : g;
+		const u32 down = keepF ? g : f;
+		Up.right = keep;
+		if (skew > 0)
+		{
+			A.right = down;
+		}
+		else
+		{
+			A.left = down;
+		}
+		tree.nodes[down].parent = a;
+
+		A.bounds = math::merge(tree.nodes[other].bounds, tree.nodes[down].bounds);
+		A.height = 1 + std::max(tree.nodes[other].height, tree.nodes[down].height);
+		Up.bounds = math::merge(A.bounds, tree.nodes[keep].bounds);
+		Up.height = 1 + std::max(A.height, tree.nodes[keep].height);
+		return up;
+	}
+
+	//walk to the root restoring heights and bounds above a changed node
+	void refit_ancestors(collider_tree& tree, u32 node)
+	{
+		while (node != null_node)
+		{
+			node = balance(tree, node);
+
+			collider_tree_node& current = tree.nodes[node];
+			collider_tree_node const& left = tree.nodes[current.left];
+			collider_tree_node const& right = tree.nodes[current.right];
+			current.height = 1 + std::max(left.height, right.height);
+			current.bounds = math::merge(left.bounds, right.bounds);
+
+			node = current.parent;
+		}
+	}
+
+	//branch and bound descent picking the sibling that adds the least surface area
+	u32 find_best_sibling(collider_tree const& tree, math::aabb3<f32> const& bounds)
+	{
+		u32 index = tree.root;
+		while (!tree.nodes[index].is_leaf())
+		{
+			collider_tree_node const& node = tree.nodes[index];
+			const f32 area = math::surface_area(node.bounds);
+			const f32 combinedArea = math::surface_area(math::merge(node.bounds, bounds));
+
+			//pairing with this node makes a new parent, descending pushes every ancestor cost down a level
+			const f32 cost = 2.f * combinedArea;
+			const f32 inheritance = 2.f * (combinedArea - area);
+
+			auto descend_cost = [&](u32 child)
+				{
+					collider_tree_node const& childNode = tree.nodes[child];
+					const f32 merged = math::surface_area(math::merge(childNode.bounds, bounds));
+					return childNode.is_leaf() ? merged + inheritance : merged - math::surface_area(childNode.bounds) + inheritance;
+				};
+
+			const f32 costLeft = descend_cost(node.left);
+			const f32 costRight = descend_cost(node.right);
+			if (cost < costLeft && cost < costRight)
+			{
+				break;
+			}
+			index = costLeft < costRight ? node.left : node.right;
+		}
+		return index;
+	}
+
+	u32 insert_leaf(collider_tree& tree, entity_id entity, math::aabb3<f32> const& tight_bounds)
+	{
+		const u32 leaf = allocate_node(tree);
+		tree.nodes[leaf].bounds = math::inflate(tight_bounds, tree.fat_margin);
+		tree.nodes[leaf].entity = entity;
+		tree.nodes[leaf].height = 0;
+
+		if (tree.root == null_node)
+		{
+			tree.root = leaf;
+			return leaf;
+		}
+
+		const u32 sibling = find_best_sibling(tree, tree.nodes[leaf].bounds);
+		const u32 oldParent = tree.nodes[sibling].parent;
+		const u32 newParent = allocate_node(tree);
+		collider_tree_node& parent = tree.nodes[newParent];
+		parent.parent = oldParent;
+		parent.left = sibling;
+		parent.right = leaf;
+		parent.bounds = math::merge(tree.nodes[sibling].bounds, tree.nodes[leaf].bounds);
+		parent.height = tree.nodes[sibling].height + 1;
+		tree.nodes[sibling].parent = newParent;
+		tree.nodes[leaf].parent = newParent;
+
+		if (oldParent == null_node)
+		{
+			tree.root = newParent;
+		}
+		else if (tree.nodes[oldParent].left == sibling)
+		{
+			tree.nodes[oldParent].left = newParent;
+		}
+		else
+		{
+			tree.nodes[oldParent].right = newParent;
+		}
+
+		refit_ancestors(tree, tree.nodes[leaf].parent);
+		return leaf;
+	}
+
+	void remove_leaf(collider_tree& tree, u32 leaf)
+	{
+		if (leaf == tree.root)
+		{
+			tree.root = null_node;
+			free_node(tree, leaf);
+			return;
+		}
+
+		//the sibling takes the parent's place
+		const u32 parent = tree.nodes[leaf].parent;
+		const u32 grandParent = tree.nodes[parent].parent;
+		const u32 sibling = tree.nodes[parent].left == leaf ? tree.nodes[parent].right : tree.nodes[parent].left;
+		tree.nodes[sibling].parent = grandParent;
+		if (grandParent == null_node)
+		{
+			tree.root = sibling;
+		}
+		else
+		{
+			if (tree.nodes[grandParent].left == parent)
+			{
+				tree.nodes[grandParent].left = sibling;
+			}
+			else
+			{
+				tree.nodes[grandParent].right = sibling;
+			}
+			refit_ancestors(tree, grandParent);
+		}
+
+		free_node(tree, parent);
+		free_node(tree, leaf);
+	}
+
+	struct collider_tree_item
+	{
+		entity_id entity;
+		math::aabb3<f32> bounds; //already fat
+	};
+
+	//median split along the widest axis of the centres, nodes are laid out depth first so a descent walks forwards in memory
+	u32 build_subtree(collider_tree& tree, std::vector<collider_tree_item>& items, size_t begin, size_t end, u32 parent)
+	{
+		const u32 index = static_cast<u32>(tree.nodes.size());
+		tree.nodes.emplace_back();
+		tree.nodes[index].parent = parent;
+
+		if (end - begin == 1)
+		{
+			tree.nodes[index].bounds = items[begin].bounds;
+			tree.nodes[index].entity = items[begin].entity;
+			return index;
+		}
+
+		math::aabb3<f32> centres{ math::vector3_f32(math::infinity<f32>()), math::vector3_f32(-math::infinity<f32>()) };
+		for (size_t idx = begin; idx < end; ++idx)
+		{
+			const math::vector3_f32 centre = 0.5f * (items[idx].bounds.min + items[idx].bounds.max);
+			centres.min = glm::min(centres.min, centre);
+			centres.max = glm::max(centres.max, centre);
+		}
+		const math::vector3_f32 size = centres.max - centres.min;
+		const int axis = size.x > size.y && size.x > size.z ? 0 : (size.y > size.z ? 1 : 2);
+
+		const size_t middle = begin + (end - begin) / 2;
+		std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end, [axis](collider_tree_item const& a, collider_tree_item const& b)
+			{
+				return a.bounds.min[axis] + a.bounds.max[axis] < b.bounds.min[axis] + b.bounds.max[axis];
+			});
+
+		const u32 left = build_subtree(tree, items, begin, middle, index);
+		const u32 right = build_subtree(tree, items, middle, end, index);
+		collider_tree_node& node = tree.nodes[index];
+		node.left = left;
+		node.right = right;
+		node.bounds = math::merge(tree.nodes[left].bounds, tree.nodes[right].bounds);
+		node.height = 1 + std::max(tree.nodes[left].height, tree.nodes[right].height);
+		return index;
+	}
+
+	void rebuild_collider_tree(entity_registry& registry, collider_tree& tree, std::vector<collider_tree_item>& items)
+	{
+		for (collider_tree_node const& node : tree.nodes)
+		{
+			if (node.height == 0)
+			{
+				items.push_back({ node.entity, node.bounds });
+			}
+		}
+
+		tree.nodes.clear();
+		tree.nodes.reserve(2 * items.size());
+		tree.free_list = null_node;
+		tree.root = items.empty() ? null_node : build_subtree(tree, items, 0, items.size(), null_node);
+		for (u32 index = 0; index < tree.nodes.size(); ++index)
+		{
+			if (tree.nodes[index].is_leaf())
+			{
+				registry.get<collider_proxy_component>(tree.nodes[index].entity).node = index;
+			}
+		}
+	}
+
+	void update_collider_tree(entity_registry& registry, collider_tree& tree)
+	{
+		//large batches (the initial fill) are cheaper and give a better tree when built top down
+		const bool rebuild = tree.pending.size() > BulkInsertThreshold && tree.pending.size() > tree.nodes.size() / 4;
+		std::vector<collider_tree_item> bulk;
+		for (entity_id entity : tree.pending)
+		{
+			if (!registry.valid(entity) || !registry.all_of<collidable_component, spatial3_component>(entity))
+			{
+				continue;
+			}
+
+			collider_proxy_component& proxy = registry.get_or_emplace<collider_proxy_component>(entity);
+			if (proxy.node != null_node)
+			{
+				continue;
+			}
+
+			if (auto tightBounds = collider_bounds(registry, entity, registry.get<spatial3_component>(entity)))
+			{
+				if (rebuild)
+				{
+					bulk.push_back({ entity, math::inflate(*tightBounds, tree.fat_margin) });
+				}
+				else
+				{
+					proxy.node = insert_leaf(tree, entity, *tightBounds);
+				}
+			}
+		}
+		tree.pending.clear();
+		if (rebuild)
+		{
+			rebuild_collider_tree(registry, tree, bulk);
+		}
+
+		//bodies without a linear body, pinned in place or asleep do not move and are skipped entirely
+		tree.moving_leaves.clear();
+		auto moving_view = registry.view<collider_proxy_component, const spatial3_component, const linear_body3_component>(entt::exclude<sleeping_component>);
+		for (auto&& [entity, proxy, spatial, linear] : moving_view.each())
+		{
+			if (proxy.node == null_node)
+			{
+				continue;
+			}
+			if (pinned_component const* pinned = registry.try_get<pinned_component>(entity);
+				pinned != nullptr && pinned->isPinned)
+			{
+				continue;
+			}
+
+			if (auto tightBounds = collider_bounds(registry, entity, spatial))
+			{
+				if (!math::contains(tree.nodes[proxy.node].bounds, *tightBounds))
+				{
+					remove_leaf(tree, proxy.node);
+					proxy.node = insert_leaf(tree, entity, *tightBounds);
+				}
+				tree.moving_leaves.push_back(proxy.node);
+			}
+		}
+
+		//neighbouring leaves sit close together in the node array, querying in node order keeps the descents in cache
+		std::sort(tree.moving_leaves.begin(), tree.moving_leaves.end());
+	}
+
+	std::vector<entity_pair> find_tree_pairs(collider_tree const& tree)
+	{
+		//moving leaves are sorted, so a pair of two moving leaves is only reported from the lower node index
+		auto moving = [&tree](u32 leaf) { return std::binary_search(tree.moving_leaves.begin(), tree.moving_leaves.end(), leaf); };
+
+		std::vector<entity_pair> pairs;
+		std::vector<u32> stack;
+		stack.reserve(tree_stack_size(tree));
+		for (u32 leaf : tree.moving_leaves)
+		{
+			collider_tree_node const& query = tree.nodes[leaf];
+			stack.push_back(tree.root);
+			while (!stack.empty())
+			{
+				const u32 index = stack.back();
+				stack.pop_back();
+				collider_tree_node const& node = tree.nodes[index];
+				if (!math::intersects(node.bounds, query.bounds))
+				{
+					continue;
+				}
+
+				if (!node.is_leaf())
+				{
+					stack.push_back(node.left);
+					stack.push_back(node.right);
+				}
+				else if (index != leaf && (leaf < index || !moving(index)))
+				{
+					pairs.push_back({ query.entity, node.entity });
+				}
+			}
+		}
+		return pairs;
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "Entity.h"
+#include "Math/Geometry.h"
+
+namespace jm
+{
+	struct collider_tree_node
+	{
+		static constexpr u32 null_node = ~u32(0);
+
+		math::aabb3<f32> bounds{}; //fat for leaves, tight around both children for branches
+		u32 parent = null_node; //next free node while on the free list
+		u32 left = null_node;
+		u32 right = null_node;
+		i32 height = 0; //leaves are 0, free nodes -1
+		entity_id entity = null_entity_id;
+
+		bool is_leaf() const { return left == null_node; }
+	};
+
+	//the tree leaf of a collidable entity, null_node until the tree has inserted it
+	struct collider_proxy_component
+	{
+		u32 node = collider_tree_node::null_node;
+		u32 collider = collider_tree_node::null_node; //index into the collider_set the tree was last indexed with, spheres then boxes, may be stale
+	};
+
+	//persistent dynamic AABB tree over every collidable entity
+	//leaves keep a fat AABB and are only reinserted once the collider leaves it, bodies that do not move are never touched
+	struct collider_tree
+	{
+		f32 fat_margin = 0.1f;
+
+		std::vector<collider_tree_node> nodes;
+		u32 root = collider_tree_node::null_node;
+		u32 free_list = collider_tree_node::null_node;
+
+		std::vector<entity_id> pending; //collidables created since the last update
+		std::vector<u32> moving_leaves; //leaves of bodies that can move this tick, pairs are only searched from these
+		size_t collider_reindexes = 0; //times the proxies were pointed at a reordered collider set, see collider_proxy_component::collider
+	};
+
+	collider_tree& get_collider_tree(entity_registry& registry);
+
+	//inserts new collidables and reinserts any moving collider that left its fat AABB
+	void update_collider_tree(entity_registry& registry, collider_tree& tree);
+
+	//every pair of overlapping fat AABBs with at least one moving leaf, each pair appears once
+	//only the moving leaves are queried, sleeping, pinned and static bodies are not walked unless a moving body reaches them
+	//the collider set resolve_collisions takes is still built over every collider, see build_colliders
+	std::vector<entity_pair> find_tree_pairs(collider_tree const& tree);
+
+	u32 insert_leaf(collider_tree& tree, entity_id entity, math::aabb3<f32> const& tight_bounds);
+	void remove_leaf(collider_tree& tree, u32 leaf);
+
+	//a descent holds at most one waiting sibling per level, rotations keep the tree roughly balanced but give no bound on its height
+	inline size_t tree_stack_size(collider_tree const& tree)
+	{
+		return tree.root == collider_tree_node::null_node ? 0 : static_cast<size_t>(tree.nodes[tree.root].height) + 1;
+	}
+
+	//every leaf whose fat AABB overlaps bounds
+	template <typename Callback> //void(entity_id)
+	void query_overlaps(collider_tree const& tree, math::aabb3<f32> const& bounds, Callback&& callback)
+	{
+		if (tree.root == collider_tree_node::null_node)
+		{
+			return;
+		}
+
+		std::vector<u32> stack;
+		stack.reserve(tree_stack_size(tree));
+		stack.push_back(tree.root);
+		while (!stack.empty())
+		{
+			collider_tree_node const& node = tree.nodes[stack.back()];
+			stack.pop_back();
+			if (!math::intersects(node.bounds, bounds))
+			{
+				continue;
+			}
+
+			if (node.is_leaf())
+			{
+				callback(node.entity);
+			}
+			else
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+
+	//every leaf whose fat AABB the ray enters before t_max, the callback returns the new t_max, so hits can shorten the ray
+	template <typename Callback> //f32(entity_id, f32 t_max)
+	void query_ray(collider_tree const& tree, math::ray3<f32> const& ray, f32 t_max, Callback&& callback)
+	{
+		if (tree.root == collider_tree_node::null_node)
+		{
+			return;
+		}
+
+		std::vector<u32> stack;
+		stack.reserve(tree_stack_size(tree));
+		stack.push_back(tree.root);
+		while (!stack.empty())
+		{
+			collider_tree_node const& node = tree.nodes[stack.back()];
+			stack.pop_back();
+			f32 t_enter = 0.f;
+			if (!math::intersects(node.bounds, ray, t_max, t_enter))
+			{
+				continue;
+			}
+
+			if (node.is_leaf())
+			{
+				t_max = callback(node.entity, t_max);
+			}
+			else
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+	}
+}
@@ -1,5 +1,9 @@
 #include "Collision.h"
 #include "Components.h"
+#include "ColliderTree.h"
+#include "Contacts.h"
+#include "Islands.h"
+#include <algorithm>
 
 
 namespace jm
@@ -13,7 +17,7 @@ namespace jm
 			spheres.reserve(sphere_entity_view.size_hint());
 			for (auto&& [entity, shape, spatial] : sphere_entity_view.each())
 			{
-				spheres.push_back({ entity, math::sphere3<f32>{spatial.position, shape.radius} });
+				spheres.push_back({ entity, math::sphere3<f32>{spatial.position, shape.radius}, registry.all_of<sleeping_component>(entity) });
 			}
 		}
 		{
@@ -21,7 +25,7 @@ namespace jm
 			boxes.reserve(box_entity_view.size_hint());
 			for (auto&& [entity, shape, spatial] : box_entity_view.each())
 			{
-				boxes.push_back({ entity, math::box3<f32>{spatial.position, shape.extents, math::quat_to_mat(spatial.orientation)} });
+				boxes.push_back({ entity, math::box3<f32>{spatial.position, shape.extents, math::quat_to_mat(spatial.orientation)}, registry.all_of<sleeping_component>(entity) });
 			}
 		}
 		return { spheres, boxes };
@@ -55,31 +59,490 @@ namespace jm
 		return std::nullopt;
 	}
 
-	void resolve_collisions(entity_registry& registry, collider_set const& colliders)
+	//one proxy per collider, spheres first then boxes (bounded by the sphere through their corners)
+	struct broadphase_proxy
 	{
-		registry;
-		//check for collisions
+		math::vector3_f32 centre;
+		f32 radius;
+		math::vector3<i32> cell;
+		bool asleep;
+	};
+
+	inline broadphase_proxy make_proxy(collider_set const& colliders, size_t idx)
+	{
+		const size_t sphereCount = colliders.spheres.size();
+		if (idx < sphereCount)
+		{
+			auto const& sphere = colliders.spheres[idx].sphere;
+			return { sphere.centre, sphere.radius, {}, colliders.spheres[idx].asleep };
+		}
+		auto const& box = colliders.boxes[idx - sphereCount].box;
+		return { box.position, length(box.extents), {}, colliders.boxes[idx - sphereCount].asleep };
+	}
+
+	std::vector<broadphase_proxy> gather_proxies(collider_set const& colliders, f32& maxRadius)
+	{
+		std::vector<broadphase_proxy> proxies(colliders.spheres.size() + colliders.boxes.size());
+		maxRadius = 0.f;
+		for (size_t idx = 0; idx < proxies.size(); ++idx)
+		{
+			proxies[idx] = make_proxy(colliders, idx);
+			maxRadius = std::max(maxRadius, proxies[idx].radius);
+		}
+		return proxies;
+	}
+
+	//idx < jdx
+	inline void add_candidate(collision_candidates& candidates, broadphase_proxy const& first, broadphase_proxy const& second, size_t sphereCount, size_t idx, size_t jdx)
+	{
+		const math::vector3_f32 displacement = first.centre - second.centre;
+		const f32 reach = first.radius + second.radius;
+		if (dot(displacement, displacement) > reach * reach)
+		{
+			return;
+		}
+
+		if (jdx < sphereCount)
+		{
+			candidates.sphere_spheres.push_back({ static_cast<u32>(idx), static_cast<u32>(jdx) });
+		}
+		else if (idx < sphereCount)
+		{
+			candidates.sphere_boxes.push_back({ static_cast<u32>(idx), static_cast<u32>(jdx - sphereCount) });
+		}
+		else
+		{
+			candidates.box_boxes.push_back({ static_cast<u32>(idx - sphereCount), static_cast<u32>(jdx - sphereCount) });
+		}
+	}
+
+	inline void add_candidate(collision_candidates& candidates, std::vector<broadphase_proxy> const& proxies, size_t sphereCount, size_t idx, size_t jdx)
+	{
+		add_candidate(candidates, proxies[idx], proxies[jdx], sphereCount, idx, jdx);
+	}
+
+	collision_candidates find_candidates_all_pairs(collider_set const& colliders)
+	{
+		f32 maxRadius = 0.f;
+		const std::vector<broadphase_proxy> proxies = gather_proxies(colliders, maxRadius);
+
+		collision_candidates candidates;
+		for (size_t idx = 0; idx < proxies.size(); ++idx)
+		{
+			for (size_t jdx = idx + 1; jdx < proxies.size(); ++jdx)
+			{
+				add_candidate(candidates, proxies, colliders.spheres.size(), idx, jdx);
+			}
+		}
+		return candidates;
+	}
+
+	inline u32 hash_cell(math::vector3<i32> const& cell)
+	{
+		return (static_cast<u32>(cell.x) * 73856093u) ^ (static_cast<u32>(cell.y) * 19349663u) ^ (static_cast<u32>(cell.z) * 83492791u);
+	}
+
+	collision_candidates find_candidates_spatial_hash(collider_set const& colliders)
+	{
+		f32 maxRadius = 0.f;
+		std::vector<broadphase_proxy> proxies = gather_proxies(colliders, maxRadius);
+		const size_t proxyCount = proxies.size();
+
+		collision_candidates candidates;
+		if (proxyCount < 2 || maxRadius <= 0.f)
+		{
+			return candidates;
+		}
+
+		//cells as wide as the largest collider, so overlapping pairs are always in neighbouring cells
+		const f32 inverseCellSize = 1.f / (2.f * maxRadius);
+		size_t bucketCount = 1;
+		while (bucketCount < 2 * proxyCount)
+		{
+			bucketCount <<= 1;
+		}
+		const u32 bucketMask = static_cast<u32>(bucketCount - 1);
+
+		//counting sort proxies by bucket, bucket b spans [bucketStarts[b], bucketStarts[b + 1])
+		std::vector<u32> bucketStarts(bucketCount + 1, 0);
+		std::vector<u32> proxyBuckets(proxyCount);
+		for (size_t idx = 0; idx < proxyCount; ++idx)
+		{
+			broadphase_proxy& proxy = proxies[idx];
+			proxy.cell = math::vector3<i32>(glm::floor(proxy.centre * inverseCellSize));
+			proxyBuckets[idx] = hash_cell(proxy.cell) & bucketMask;
+			++bucketStarts[proxyBuckets[idx] + 1];
+		}
+		for (size_t bucket = 0; bucket < bucketCount; ++bucket)
+		{
+			bucketStarts[bucket + 1] += bucketStarts[bucket];
+		}
+		std::vector<u32> bucketProxies(proxyCount);
+		{
+			std::vector<u32> cursor(bucketStarts.begin(), bucketStarts.end() - 1);
+			for (size_t idx = 0; idx < proxyCount; ++idx)
+			{
+				bucketProxies[cursor[proxyBuckets[idx]]++] = static_cast<u32>(idx);
+			}
+		}
+
+		//sleeping proxies are only found from awake ones, so a settled scene does almost no queries
+		for (size_t idx = 0; idx < proxyCount; ++idx)
+		{
+			if (proxies[idx].asleep)
+			{
+				continue;
+			}
+			const math::vector3<i32> home = proxies[idx].cell;
+			for (i32 z = -1; z <= 1; ++z)
+			{
+				for (i32 y = -1; y <= 1; ++y)
+				{
+					for (i32 x = -1; x <= 1; ++x)
+					{
+						const math::vector3<i32> cell = home + math::vector3<i32>{ x, y, z };
+						const u32 bucket = hash_cell(cell) & bucketMask;
+						for (u32 slot = bucketStarts[bucket]; slot < bucketStarts[bucket + 1]; ++slot)
+						{
+							//other cells can share the bucket, only accept each pair from its lower awake index and true cell
+							const u32 jdx = bucketProxies[slot];
+							if ((jdx > idx || proxies[jdx].asleep) && proxies[jdx].cell == cell)
+							{
+								add_candidate(candidates, proxies, colliders.spheres.size(), std::min<size_t>(idx, jdx), std::max<size_t>(idx, jdx));
+							}
+						}
+					}
+				}
+			}
+		}
+		return candidates;
+	}
+
+	constexpr u32 no_proxy = ~u32(0);
+
+	struct entity_proxy
+	{
+		entity_id entity = null_entity_id; //full id, a recycled slot must not alias the proxy of the entity that held it before
+		u32 proxy = no_proxy;
+	};
+
+	//entity slot -> proxy index for this frame's colliders, no_proxy for entities without one
+	std::vector<entity_proxy> map_entity_proxies(collider_set const& colliders)
+	{
+		std::vector<entity_proxy> entityProxies;
+		auto map_entity = [&](entity_id entity, u32 proxy)
+			{
+				const size_t slot = static_cast<size_t>(entt::to_entity(entity));
+				if (slot >= entityProxies.size())
+				{
+					entityProxies.resize(slot + 1);
+				}
+				entityProxies[slot] = { entity, proxy };
+			};
 		for (size_t idx = 0; idx < colliders.spheres.size(); ++idx)
 		{
-			auto& b = colliders.spheres[idx];
-			for (size_t jdx = idx + 1; jdx < colliders.spheres.size(); ++jdx)
+			map_entity(colliders.spheres[idx].entity, static_cast<u32>(idx));
+		}
+		for (size_t idx = 0; idx < colliders.boxes.size(); ++idx)
+		{
+			map_entity(colliders.boxes[idx].entity, static_cast<u32>(colliders.spheres.size() + idx));
+		}
+		return entityProxies;
+	}
+
+	inline u32 find_entity_proxy(std::vector<entity_proxy> const& entityProxies, entity_id entity)
+	{
+		const size_t slot = static_cast<size_t>(entt::to_entity(entity));
+		return slot < entityProxies.size() && entityProxies[slot].entity == entity ? entityProxies[slot].proxy : no_proxy;
+	}
+
+	//the tree reports entities, each proxy keeps the index of its entity's collider in the set the tree was last indexed with
+	//build_colliders keeps the same order until a collider is created or destroyed, so the indices are only rebuilt when a lookup finds them stale
+	struct tree_colliders
+	{
+		entt::storage_for_t<collider_proxy_component>& proxies;
+		collider_set const& colliders;
+		bool indexed = false; //at most once per query, an entity the collider set does not hold would otherwise reindex on every pair
+
+		//point each tree proxy at this frame's collider instead of building a lookup table
+		void index(collider_tree& tree)
+		{
+			const size_t sphereCount = colliders.spheres.size();
+			const size_t colliderCount = sphereCount + colliders.boxes.size();
+			for (size_t idx = 0; idx < colliderCount; ++idx)
+			{
+				const entity_id entity = idx < sphereCount ? colliders.spheres[idx].entity : colliders.boxes[idx - sphereCount].entity;
+				if (proxies.contains(entity))
+				{
+					proxies.get(entity).collider = static_cast<u32>(idx);
+				}
+			}
+			indexed = true;
+			++tree.collider_reindexes;
+		}
+
+		//a new proxy or a reordered set leaves an index that does not point back at the same entity
+		u32 find_indexed(entity_id entity) const
+		{
+			const size_t sphereCount = colliders.spheres.size();
+			const u32 idx = proxies.get(entity).collider;
+			if (idx >= sphereCount + colliders.boxes.size())
+			{
+				return no_proxy;
+			}
+			return (idx < sphereCount ? colliders.spheres[idx].entity : colliders.boxes[idx - sphereCount].entity) == entity ? idx : no_proxy;
+		}
+
+		u32 find(collider_tree& tree, entity_id entity)
+		{
+			u32 idx = find_indexed(entity);
+			if (idx == no_proxy && !indexed)
+			{
+				index(tree);
+				idx = find_indexed(entity);
+			}
+			return idx;
+		}
+	};
+
+	collision_candidates find_candidates_dynamic_tree(entity_registry& registry, collider_set const& colliders)
+	{
+		collider_tree& tree = get_collider_tree(registry);
+		update_collider_tree(registry, tree);
+
+		tree_colliders treeColliders{ registry.storage<collider_proxy_component>(), colliders };
+		const size_t sphereCount = colliders.spheres.size();
+		collision_candidates candidates;
+		for (entity_pair const& pair : find_tree_pairs(tree))
+		{
+			const u32 a = treeColliders.find(tree, pair.first);
+			const u32 b = treeColliders.find(tree, pair.second);
+			if (a != no_proxy && b != no_proxy)
+			{
+				const u32 first = std::min(a, b);
+				const u32 second = std::max(a, b);
+				add_candidate(candidates, make_proxy(colliders, first), make_proxy(colliders, second), sphereCount, first, second);
+			}
+		}
+		return candidates;
+	}
+
+	entity_pick ray_cast(entity_registry& registry, math::ray3<f32> const& ray)
+	{
+		//colliders created or moved since the broadphase last ran are put in the tree before it is walked
+		collider_tree& tree = get_collider_tree(registry);
+		update_collider_tree(registry, tree);
+
+		//only leaves the ray reaches are tested, and every hit shortens the ray so further leaves are pruned sooner
+		entity_id entity_closest = null_entity_id;
+		math::vector3_f32 offset{};
+		query_ray(tree, ray, std::numeric_limits<f32>::infinity(), [&](entity_id entity, f32 t_max)
 			{
-				auto& a = colliders.spheres[jdx];
-				if (math::intersects(a.sphere, b.sphere))
+				sphere_shape_component const* shape = registry.try_get<sphere_shape_component>(entity);
+				if (shape == nullptr) //boxes are not picked, like the loop over the colliders
 				{
-					//do something
+					return t_max;
 				}
+
+				const math::sphere3<f32> sphere{ registry.get<spatial3_component>(entity).position, shape->radius };
+				f32 t_intersect = std::numeric_limits<f32>::infinity();
+				if (math::intersects(sphere, ray, t_intersect) && t_intersect < t_max)
+				{
+					entity_closest = entity;
+					offset = (ray.origin + t_intersect * ray.direction) - sphere.centre;
+					return t_intersect;
+				}
+				return t_max;
+			});
+
+		if (entity_closest != null_entity_id)
+		{
+			return entity_offset{ entity_closest, offset };
+		}
+		return std::nullopt;
+	}
+
+	sweep_and_prune& get_sweep_and_prune(entity_registry& registry)
+	{
+		if (sweep_and_prune* sweep = registry.ctx().find<sweep_and_prune>())
+		{
+			return *sweep;
+		}
+		return registry.ctx().emplace<sweep_and_prune>();
+	}
+
+	constexpr f32 SweepAxisHysteresis = 1.5f; //another axis has to be this much more spread before the sweep switches to it
+
+	//variance of the centres along each axis, the sweep runs along the widest
+	math::vector3_f32 centre_variance(std::vector<broadphase_proxy> const& proxies)
+	{
+		math::vector3_f32 sum{ 0.f };
+		math::vector3_f32 sumSquares{ 0.f };
+		for (broadphase_proxy const& proxy : proxies)
+		{
+			sum += proxy.centre;
+			sumSquares += proxy.centre * proxy.centre;
+		}
+		const f32 count = static_cast<f32>(std::max<size_t>(proxies.size(), 1));
+		return sumSquares / count - (sum / count) * (sum / count);
+	}
+
+	//keeps the current axis until the distribution has clearly changed, so a scene spread evenly does not flip every tick
+	int choose_sweep_axis(math::vector3_f32 const& variance, int current)
+	{
+		const int widest = variance.x > variance.y && variance.x > variance.z ? 0 : (variance.y > variance.z ? 1 : 2);
+		if (current < 0 || variance[widest] > SweepAxisHysteresis * variance[current])
+		{
+			return widest;
+		}
+		return current;
+	}
+
+	collision_candidates find_candidates_sweep_and_prune(entity_registry& registry, collider_set const& colliders)
+	{
+		sweep_and_prune& sweep = get_sweep_and_prune(registry);
+
+		f32 maxRadius = 0.f;
+		const std::vector<broadphase_proxy> proxies = gather_proxies(colliders, maxRadius);
+		const std::vector<entity_proxy> entityProxies = map_entity_proxies(colliders);
+		//re-picked every tick, a pile spreading sideways would otherwise keep sweeping along its old height axis
+		const int previousAxis = sweep.axis;
+		sweep.axis = choose_sweep_axis(centre_variance(proxies), sweep.axis);
+		const int axis = sweep.axis;
+
+		//refresh the kept intervals in their old order, dropping entities that lost their collider
+		std::vector<u8> kept(proxies.size(), 0);
+		size_t count = 0;
+		for (sweep_and_prune::interval const& entry : sweep.intervals)
+		{
+			const u32 proxy = find_entity_proxy(entityProxies, entry.entity);
+			if (proxy == no_proxy || kept[proxy] != 0)
+			{
+				continue;
+			}
+			kept[proxy] = 1;
+			const f32 centre = proxies[proxy].centre[axis];
+			sweep.intervals[count++] = { centre - proxies[proxy].radius, centre + proxies[proxy].radius, entry.entity, proxy };
+		}
+		sweep.intervals.resize(count);
+
+		const size_t added = proxies.size() - count;
+		for (u32 proxy = 0; proxy < proxies.size(); ++proxy)
+		{
+			if (kept[proxy] == 0)
+			{
+				const entity_id entity = proxy < colliders.spheres.size() ? colliders.spheres[proxy].entity : colliders.boxes[proxy - colliders.spheres.size()].entity;
+				const f32 centre = proxies[proxy].centre[axis];
+				sweep.intervals.push_back({ centre - proxies[proxy].radius, centre + proxies[proxy].radius, entity, proxy });
 			}
+		}
 
-			for (size_t jdx = idx + 1; jdx < colliders.boxes.size(); ++jdx)
+		//bodies move little between ticks, so insertion sort only pays for the swaps
+		auto lower = [](sweep_and_prune::interval const& a, sweep_and_prune::interval const& b) { return a.min < b.min; };
+		sweep.swaps = 0;
+		if (axis != previousAxis || added > sweep.intervals.size() / 4)
+		{
+			std::sort(sweep.intervals.begin(), sweep.intervals.end(), lower);
+		}
+		else
+		{
+			for (size_t idx = 1; idx < sweep.intervals.size(); ++idx)
 			{
-				auto& a = colliders.boxes[jdx];
-				if (math::intersects(b.sphere, a.box))
+				const sweep_and_prune::interval entry = sweep.intervals[idx];
+				size_t jdx = idx;
+				for (; jdx > 0 && lower(entry, sweep.intervals[jdx - 1]); --jdx)
 				{
-					//do something
+					sweep.intervals[jdx] = sweep.intervals[jdx - 1];
 				}
+				sweep.intervals[jdx] = entry;
+				sweep.swaps += idx - jdx;
+			}
+		}
+
+		collision_candidates candidates;
+		for (size_t idx = 0; idx < sweep.intervals.size(); ++idx)
+		{
+			sweep_and_prune::interval const& entry = sweep.intervals[idx];
+			for (size_t jdx = idx + 1; jdx < sweep.intervals.size() && sweep.intervals[jdx].min <= entry.max; ++jdx)
+			{
+				const u32 other = sweep.intervals[jdx].proxy;
+				if (proxies[entry.proxy].asleep && proxies[other].asleep)
+				{
+					continue;
+				}
+				add_candidate(candidates, proxies, colliders.spheres.size(), std::min(entry.proxy, other), std::max(entry.proxy, other));
+			}
+		}
+		return candidates;
+	}
+
+	collision_candidates find_candidates(entity_registry& registry, collider_set const& colliders, broadphase_method method)
+	{
+		switch (method)
+		{
+		case broadphase_method::all_pairs:
+			return find_candidates_all_pairs(colliders);
+		case broadphase_method::dynamic_tree:
+			return find_candidates_dynamic_tree(registry, colliders);
+		case broadphase_method::sweep_and_prune:
+			return find_candidates_sweep_and_prune(registry, colliders);
+		case broadphase_method::spatial_hash:
+		default:
+			return find_candidates_spatial_hash(colliders);
+		}
+	}
+
+	void resolve_collisions(entity_registry& registry, collider_set const& colliders, f32 delta_time, broadphase_method method)
+	{
+		const collision_candidates candidates = find_candidates(registry, colliders, method);
+
+		//pairs where neither body can move, asleep or static, need no contacts
+		auto any_awake = [&registry](entity_id a, entity_id b)
+		{
+			return is_awake_body(registry, a) || is_awake_body(registry, b);
+		};
+
+		//check for collisions
+		std::vector<contact_manifold> manifolds;
+		contact_manifold manifold;
+		for (collider_pair const& pair : candidates.sphere_spheres)
+		{
+			auto& a = colliders.spheres[pair.first];
+			auto& b = colliders.spheres[pair.second];
+			if (any_awake(a.entity, b.entity) && collide(a.sphere, b.sphere, manifold))
+			{
+				manifold.a = a.entity;
+				manifold.b = b.entity;
+				manifolds.push_back(manifold);
 			}
 		}
+
+		for (collider_pair const& pair : candidates.sphere_boxes)
+		{
+			auto& a = colliders.spheres[pair.first];
+			auto& b = colliders.boxes[pair.second];
+			if (any_awake(a.entity, b.entity) && collide(a.sphere, b.box, manifold))
+			{
+				manifold.a = a.entity;
+				manifold.b = b.entity;
+				manifolds.push_back(manifold);
+			}
+		}
+
+		for (collider_pair const& pair : candidates.box_boxes)
+		{
+			auto& a = colliders.boxes[pair.first];
+			auto& b = colliders.boxes[pair.second];
+			if (any_awake(a.entity, b.entity) && collide(a.box, b.box, manifold))
+			{
+				manifold.a = a.entity;
+				manifold.b = b.entity;
+				manifolds.push_back(manifold);
+			}
+		}
+
 		//resolve collisions
+		record_contacts(registry, manifolds);
+		solve_contacts(registry, manifolds, delta_time);
 	}
 }
\ No newline at end of file
@@ -10,12 +10,14 @@ namespace jm
 	{
 		entity_id entity;
 		math::sphere3<f32> sphere;
+		bool asleep = false; //broadphases skip pairs of sleeping colliders
 	};
 
 	struct box_collider
 	{
 		entity_id entity;
 		math::box3<f32> box;
+		bool asleep = false;
 	};
 
 	struct collider_set
@@ -32,7 +34,56 @@ namespace jm
 
 	using entity_pick = std::optional<entity_offset>;
 
+	enum class broadphase_method
+	{
+		all_pairs,
+		spatial_hash,
+		dynamic_tree, //persistent, see ColliderTree.h
+		sweep_and_prune, //persistent, best when bodies are spread along one axis
+	};
+
+	struct collider_pair
+	{
+		u32 first;
+		u32 second;
+	};
+
+	//possibly overlapping pairs, each pair appears once
+	struct collision_candidates
+	{
+		std::vector<collider_pair> sphere_spheres{}; //indices into collider_set::spheres
+		std::vector<collider_pair> sphere_boxes{}; //first into collider_set::spheres, second into collider_set::boxes
+		std::vector<collider_pair> box_boxes{}; //indices into collider_set::boxes
+	};
+
+	//sort and sweep state kept in the registry context
+	//intervals stay in last tick's order so re-sorting a coherent scene costs O(n + swaps)
+	struct sweep_and_prune
+	{
+		struct interval
+		{
+			f32 min;
+			f32 max;
+			entity_id entity;
+			u32 proxy; //index into this tick's colliders, spheres then boxes
+		};
+
+		std::vector<interval> intervals;
+		int axis = -1; //the axis the colliders are most spread along, switched once another is clearly wider
+		size_t swaps = 0; //insertion sort moves last tick
+	};
+
 	collider_set build_colliders(entity_registry& registry);
-	void resolve_collisions(entity_registry& registry, collider_set const& colliders);
-	entity_pick ray_cast(collider_set const& colliders, math::ray3<f32> const& ray);
+
+	collision_candidates find_candidates(entity_registry& registry, collider_set const& colliders, broadphase_method method);
+	collision_candidates find_candidates_all_pairs(collider_set const& colliders);
+	collision_candidates find_candidates_spatial_hash(collider_set const& colliders);
+	collision_candidates find_candidates_dynamic_tree(entity_registry& registry, collider_set const& colliders);
+	collision_candidates find_candidates_sweep_and_prune(entity_registry& registry, collider_set const& colliders);
+
+	//narrowphase on the broadphase candidates, then an impulse solve on the resulting contacts
+	void resolve_collisions(entity_registry& registry, collider_set const& colliders, f32 delta_time, broadphase_method method = broadphase_method::spatial_hash);
+	entity_pick ray_cast(collider_set const& colliders, math::ray3<f32> const& ray); //tests every sphere
+	//descends the dynamic tree, updating it first so colliders created or moved since the last tick are hit too
+	entity_pick ray_cast(entity_registry& registry, math::ray3<f32> const& ray);
 }
\ No newline at end of file
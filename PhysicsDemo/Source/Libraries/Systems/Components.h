@@ -47,6 +47,13 @@ namespace jm
 
 		entity_id massA;
 		entity_id massB;
+
+		f32 compliance = 0.f; //inverse stiffness in metres per newton, zero is rigid
+	};
+
+	//moved by the constraint solve instead of the linear pass, set on the bodies of constraint_component_rigid links
+	struct constraint_particle_component
+	{
 	};
 
 	struct pinned_component
@@ -54,6 +61,12 @@ namespace jm
 		bool isPinned;
 	};
 
+	//skipped by integration and collision until something wakes its island
+	struct sleeping_component
+	{
+		u32 island; //index into island_state::sleeping_islands
+	};
+
 	using linear_body2_component = math::linear_body2<f32>;
 	using linear_body3_component = math::linear_body3<f32>;
 
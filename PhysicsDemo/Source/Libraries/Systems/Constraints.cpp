@@ -0,0 +1,454 @@
+#include "Constraints.h"
+#include "Components.h"
+#include "Islands.h"
+
+#include "Platform/JobSystem.h"
+
+#include <algorithm>
+#include <bit>
+#include <unordered_map>
+
+namespace jm
+{
+	constexpr uSize ParallelGrainSize = 1024; //links per chunk handed to a worker
+
+	void mark_constraints_dirty(entity_registry& registry, entity_id)
+	{
+		registry.ctx().get<constraint_store>().dirty = true;
+	}
+
+	constraint_store& get_constraint_store(entity_registry& registry)
+	{
+		if (constraint_store* store = registry.ctx().find<constraint_store>())
+		{
+			return *store;
+		}
+
+		constraint_store& store = registry.ctx().emplace<constraint_store>();
+		registry.on_construct<constraint_component_rigid>().connect<&mark_constraints_dirty>();
+		registry.on_destroy<constraint_component_rigid>().connect<&mark_constraints_dirty>();
+		registry.on_destroy<spatial3_component>().connect<&mark_constraints_dirty>();
+		registry.on_destroy<pinned_component>().connect<&mark_constraints_dirty>();
+		return store;
+	}
+
+	template <typename T>
+	void apply_order(std::vector<T>& values, std::vector<u32> const& order)
+	{
+		std::vector<T> ordered(values.size());
+		for (size_t idx = 0; idx < order.size(); ++idx)
+		{
+			ordered[idx] = values[order[idx]];
+		}
+		values = std::move(ordered);
+	}
+
+	//greedy edge colouring, grids and chains need 4 and 2 colours
+	void colour_constraint_store(constraint_store& store)
+	{
+		constexpr u32 overflow_colour = constraint_store::max_colours;
+
+		std::vector<u64> particleColours(store.particle_entities.size(), 0);
+		std::vector<u32> linkColours(store.links.size());
+		u32 colourCount = 0;
+		for (size_t idx = 0; idx < store.links.size(); ++idx)
+		{
+			const constraint_link link = store.links[idx];
+			const u64 used = particleColours[link.a] | particleColours[link.b];
+			const u32 colour = used == ~u64(0) ? overflow_colour : static_cast<u32>(std::countr_zero(~used));
+			if (colour != overflow_colour)
+			{
+				particleColours[link.a] |= u64(1) << colour;
+				particleColours[link.b] |= u64(1) << colour;
+			}
+			linkColours[idx] = colour;
+			colourCount = std::max(colourCount, colour + 1);
+		}
+
+		//counting sort keeps the original order inside each colour
+		store.colour_offsets.assign(colourCount + 1, 0);
+		for (u32 colour : linkColours)
+		{
+			++store.colour_offsets[colour + 1];
+		}
+		for (u32 colour = 0; colour < colourCount; ++colour)
+		{
+			store.colour_offsets[colour + 1] += store.colour_offsets[colour];
+		}
+
+		std::vector<u32> order(store.links.size());
+		std::vector<u32> cursor(store.colour_offsets.begin(), store.colour_offsets.end() - 1);
+		for (size_t idx = 0; idx < linkColours.size(); ++idx)
+		{
+			order[cursor[linkColours[idx]]++] = static_cast<u32>(idx);
+		}
+
+		apply_order(store.link_entities, order);
+		apply_order(store.links, order);
+		apply_order(store.link_distances, order);
+		apply_order(store.link_compliances, order);
+		apply_order(store.break_distances, order);
+	}
+
+	//groups the links and particles of each connected set, pinned particles included since every link writes both ends
+	//links stay in store order inside an island, and small islands are packed into one batch
+	void island_constraint_store(constraint_store& store)
+	{
+		std::vector<u32> parents(store.particle_entities.size());
+		for (u32 idx = 0; idx < parents.size(); ++idx)
+		{
+			parents[idx] = idx;
+		}
+		for (constraint_link const& link : store.links)
+		{
+			parents[find_island_root(parents, link.a)] = find_island_root(parents, link.b);
+		}
+
+		constexpr u32 no_island = ~u32(0);
+		std::vector<u32> rootIslands(parents.size(), no_island);
+		std::vector<u32> linkIslands(store.links.size());
+		std::vector<u32> islandOffsets(1, 0);
+		for (size_t idx = 0; idx < store.links.size(); ++idx)
+		{
+			u32& island = rootIslands[find_island_root(parents, store.links[idx].a)];
+			if (island == no_island)
+			{
+				island = static_cast<u32>(islandOffsets.size() - 1);
+				islandOffsets.push_back(0);
+			}
+			linkIslands[idx] = island;
+			++islandOffsets[island + 1];
+		}
+		for (size_t island = 1; island < islandOffsets.size(); ++island)
+		{
+			islandOffsets[island] += islandOffsets[island - 1];
+		}
+
+		store.island_links.resize(store.links.size());
+		std::vector<u32> cursor(islandOffsets.begin(), islandOffsets.end() - 1);
+		for (size_t idx = 0; idx < linkIslands.size(); ++idx)
+		{
+			store.island_links[cursor[linkIslands[idx]]++] = static_cast<u32>(idx);
+		}
+
+		std::vector<u32> particleOffsets(islandOffsets.size(), 0);
+		std::vector<u32> particleIslands(parents.size());
+		for (u32 idx = 0; idx < parents.size(); ++idx)
+		{
+			particleIslands[idx] = rootIslands[find_island_root(parents, idx)]; //every particle has a link, so every root has an island
+			++particleOffsets[particleIslands[idx] + 1];
+		}
+		for (size_t island = 1; island < particleOffsets.size(); ++island)
+		{
+			particleOffsets[island] += particleOffsets[island - 1];
+		}
+
+		store.island_particles.resize(parents.size());
+		cursor.assign(particleOffsets.begin(), particleOffsets.end() - 1);
+		for (u32 idx = 0; idx < particleIslands.size(); ++idx)
+		{
+			store.island_particles[cursor[particleIslands[idx]]++] = idx;
+		}
+
+		store.island_batch_offsets.assign(1, 0);
+		store.island_particle_offsets.assign(1, 0);
+		for (size_t island = 1; island < islandOffsets.size(); ++island)
+		{
+			if (islandOffsets[island] - store.island_batch_offsets.back() >= ParallelGrainSize || island + 1 == islandOffsets.size())
+			{
+				store.island_batch_offsets.push_back(islandOffsets[island]);
+				store.island_particle_offsets.push_back(particleOffsets[island]);
+			}
+		}
+	}
+
+	void rebuild_constraint_store(entity_registry& registry, constraint_store& store)
+	{
+		store.particle_entities.clear();
+		store.link_entities.clear();
+		store.links.clear();
+		store.link_distances.clear();
+		store.link_compliances.clear();
+		store.break_distances.clear();
+
+		std::unordered_map<entity_id, u32> particleIndices;
+		auto get_particle_index = [&](entity_id entity)
+		{
+			auto [it, inserted] = particleIndices.try_emplace(entity, static_cast<u32>(store.particle_entities.size()));
+			if (inserted)
+			{
+				store.particle_entities.push_back(entity);
+			}
+			return it->second;
+		};
+
+		auto constraints_rigid = registry.view<const constraint_component_rigid>();
+		store.links.reserve(constraints_rigid.size());
+		for (auto&& [entity, constraint] : constraints_rigid.each())
+		{
+			if (!registry.valid(constraint.massA) || !registry.all_of<spatial3_component, pinned_component>(constraint.massA) ||
+				!registry.valid(constraint.massB) || !registry.all_of<spatial3_component, pinned_component>(constraint.massB))
+			{
+				continue;
+			}
+
+			store.link_entities.push_back(entity);
+			store.links.push_back({ get_particle_index(constraint.massA), get_particle_index(constraint.massB) });
+			store.link_distances.push_back(constraint.linkDistance);
+			store.link_compliances.push_back(constraint.compliance);
+			store.break_distances.push_back(constraint.breakThreshold * constraint.linkDistance);
+		}
+
+		const size_t particleCount = store.particle_entities.size();
+		store.positions.resize(particleCount);
+		store.previous_positions.resize(particleCount);
+		store.velocities.resize(particleCount);
+		store.accelerations.resize(particleCount);
+		store.inverse_masses.resize(particleCount);
+		store.radii.resize(particleCount);
+		store.lambdas.resize(store.links.size());
+		store.broken.assign(store.links.size(), 0);
+
+		//tagged bodies are left out of the linear pass, the solve integrates them in its substeps
+		registry.clear<constraint_particle_component>();
+		for (size_t idx = 0; idx < particleCount; ++idx)
+		{
+			const entity_id entity = store.particle_entities[idx];
+			const sphere_shape_component* sphere = registry.try_get<sphere_shape_component>(entity);
+			store.radii[idx] = sphere != nullptr ? sphere->radius : 0.f;
+			if (registry.all_of<linear_body3_component>(entity))
+			{
+				registry.emplace<constraint_particle_component>(entity);
+			}
+		}
+
+		colour_constraint_store(store);
+		island_constraint_store(store);
+		store.dirty = false;
+	}
+
+	void update_constraint_store(entity_registry& registry, constraint_store& store)
+	{
+		if (store.dirty)
+		{
+			rebuild_constraint_store(registry, store);
+		}
+	}
+
+	void gather_particles(entity_registry& registry, constraint_store& store)
+	{
+		store.movable_particles = 0;
+		for (size_t idx = 0; idx < store.particle_entities.size(); ++idx)
+		{
+			const entity_id entity = store.particle_entities[idx];
+			store.positions[idx] = registry.get<spatial3_component>(entity).position;
+
+			const linear_body3_component* linear = registry.try_get<linear_body3_component>(entity);
+			const bool fixed = registry.get<pinned_component>(entity).isPinned || registry.all_of<sleeping_component>(entity);
+			store.inverse_masses[idx] = (fixed || linear == nullptr) ? 0.f : linear->inverse_mass;
+			store.movable_particles += store.inverse_masses[idx] > 0.f;
+			if (linear != nullptr)
+			{
+				store.velocities[idx] = linear->velocity;
+				store.accelerations[idx] = linear->applied_force * linear->inverse_mass;
+			}
+		}
+	}
+
+	void scatter_particles(entity_registry& registry, constraint_store const& store)
+	{
+		for (size_t idx = 0; idx < store.particle_entities.size(); ++idx)
+		{
+			if (store.inverse_masses[idx] > 0.f)
+			{
+				const entity_id entity = store.particle_entities[idx];
+				registry.get<spatial3_component>(entity).position = store.positions[idx];
+				registry.get<linear_body3_component>(entity).velocity = store.velocities[idx];
+			}
+		}
+	}
+
+	//symplectic euler over one substep, the start is kept to derive the velocity once the links are projected
+	inline void predict_particle(constraint_store& store, constraint_step const& step, f32 substep, u32 idx)
+	{
+		if (store.inverse_masses[idx] <= 0.f)
+		{
+			return;
+		}
+
+		math::vector3_f32& velocity = store.velocities[idx];
+		store.previous_positions[idx] = store.positions[idx];
+		velocity += (step.acceleration + store.accelerations[idx] - velocity * step.damping) * substep;
+		store.positions[idx] += velocity * substep;
+	}
+
+	//walls are applied to the position, so the derived velocity loses whatever went into them
+	inline void update_particle(constraint_store& store, constraint_step const& step, f32 inverse_substep, u32 idx)
+	{
+		if (store.inverse_masses[idx] <= 0.f)
+		{
+			return;
+		}
+
+		const f32 radius = store.radii[idx];
+		math::vector3_f32& position = store.positions[idx];
+		position = max(min(position, step.wall_max - radius), step.wall_min + radius); //low wall last so it wins where both hold
+		store.velocities[idx] = (position - store.previous_positions[idx]) * inverse_substep;
+	}
+
+	inline void project_link(constraint_store& store, math::vector3_f32* positions, const f32* inverse_masses, f32 inverse_substep_squared, uSize idx)
+	{
+		if (store.broken[idx])
+		{
+			return;
+		}
+
+		const constraint_link link = store.links[idx];
+		math::vector3_f32& positionA = positions[link.a];
+		math::vector3_f32& positionB = positions[link.b];
+
+		const math::vector3_f32 dist = positionA - positionB;
+		const f32 magnitude = length(dist);
+		if (magnitude > store.break_distances[idx])
+		{
+			store.broken[idx] = 1; //still projected this substep, destroyed after the solve
+		}
+
+		const f32 weightA = inverse_masses[link.a];
+		const f32 weightB = inverse_masses[link.b];
+		const f32 weightSum = weightA + weightB;
+		if (weightSum <= 0.f || magnitude <= math::epsilon_f32)
+		{
+			return;
+		}
+
+		//xpbd, compliance over the squared substep acts like a mass on the link, zero moves each end by its share of the whole error
+		const f32 compliance = store.link_compliances[idx] * inverse_substep_squared;
+		const f32 deltaLambda = (store.link_distances[idx] - magnitude - compliance * store.lambdas[idx]) / (weightSum + compliance);
+		store.lambdas[idx] += deltaLambda;
+
+		const math::vector3_f32 correction = (deltaLambda / magnitude) * dist;
+		positionA += weightA * correction;
+		positionB -= weightB * correction;
+	}
+
+	inline void project_links(constraint_store& store, f32 inverse_substep_squared, uSize begin, uSize end)
+	{
+		math::vector3_f32* positions = store.positions.data();
+		const f32* inverse_masses = store.inverse_masses.data();
+
+		for (size_t idx = begin; idx < end; ++idx)
+		{
+			project_link(store, positions, inverse_masses, inverse_substep_squared, idx);
+		}
+	}
+
+	//islands share no particle, so running each one through every substep on its own matches the coloured solve
+	void solve_constraint_islands(constraint_store& store, constraint_step const& step)
+	{
+		const f32 substep = step.delta_time / static_cast<f32>(store.substeps);
+		const f32 inverse_substep = 1.f / substep;
+		const f32 inverse_substep_squared = inverse_substep * inverse_substep;
+
+		Platform::JobCounter counter;
+		for (size_t batch = 0; batch + 1 < store.island_batch_offsets.size(); ++batch)
+		{
+			const u32 begin = store.island_batch_offsets[batch];
+			const u32 end = store.island_batch_offsets[batch + 1];
+			const u32 particleBegin = store.island_particle_offsets[batch];
+			const u32 particleEnd = store.island_particle_offsets[batch + 1];
+			store.jobs->Run(counter, [&store, &step, substep, inverse_substep, inverse_substep_squared, begin, end, particleBegin, particleEnd]()
+				{
+					math::vector3_f32* positions = store.positions.data();
+					const f32* inverse_masses = store.inverse_masses.data();
+					u32 const* links = store.island_links.data();
+					u32 const* particles = store.island_particles.data();
+					for (u32 s = 0; s < store.substeps; ++s)
+					{
+						for (u32 idx = particleBegin; idx < particleEnd; ++idx)
+						{
+							predict_particle(store, step, substep, particles[idx]);
+						}
+						for (u32 idx = begin; idx < end; ++idx)
+						{
+							store.lambdas[links[idx]] = 0.f;
+						}
+						for (u32 i = 0; i < store.iterations; ++i)
+						{
+							for (u32 idx = begin; idx < end; ++idx)
+							{
+								project_link(store, positions, inverse_masses, inverse_substep_squared, links[idx]);
+							}
+						}
+						for (u32 idx = particleBegin; idx < particleEnd; ++idx)
+						{
+							update_particle(store, step, inverse_substep, particles[idx]);
+						}
+					}
+				});
+		}
+		store.jobs->Wait(counter);
+	}
+
+	void solve_constraints(constraint_store& store, constraint_step const& step)
+	{
+		if (store.jobs != nullptr && store.island_batch_offsets.size() > 2)
+		{
+			solve_constraint_islands(store, step);
+			return;
+		}
+
+		const uSize colourCount = store.colour_offsets.empty() ? 0 : store.colour_offsets.size() - 1;
+		const u32 particleCount = static_cast<u32>(store.particle_entities.size());
+		const f32 substep = step.delta_time / static_cast<f32>(store.substeps);
+		const f32 inverse_substep = 1.f / substep;
+		const f32 inverse_substep_squared = inverse_substep * inverse_substep;
+
+		for (u32 s = 0; s < store.substeps; ++s)
+		{
+			for (u32 idx = 0; idx < particleCount; ++idx)
+			{
+				predict_particle(store, step, substep, idx);
+			}
+			std::fill(store.lambdas.begin(), store.lambdas.end(), 0.f);
+
+			for (u32 i = 0; i < store.iterations; ++i)
+			{
+				for (uSize colour = 0; colour < colourCount; ++colour)
+				{
+					const uSize begin = store.colour_offsets[colour];
+					const uSize end = store.colour_offsets[colour + 1];
+
+					//links inside a colour are independent, so the split does not change the result
+					if (store.workers != nullptr && colour != constraint_store::max_colours && end - begin > ParallelGrainSize)
+					{
+						store.workers->ParallelFor(end - begin, ParallelGrainSize, [&store, inverse_substep_squared, begin](uSize first, uSize last)
+							{
+								project_links(store, inverse_substep_squared, begin + first, begin + last);
+							});
+					}
+					else
+					{
+						project_links(store, inverse_substep_squared, begin, end);
+					}
+				}
+			}
+
+			for (u32 idx = 0; idx < particleCount; ++idx)
+			{
+				update_particle(store, step, inverse_substep, idx);
+			}
+		}
+	}
+
+	void destroy_broken_constraints(entity_registry& registry, constraint_store& store)
+	{
+		for (size_t idx = 0; idx < store.links.size(); ++idx)
+		{
+			if (store.broken[idx] && registry.valid(store.link_entities[idx]))
+			{
+				registry.destroy(store.link_entities[idx]);
+			}
+		}
+	}
+}
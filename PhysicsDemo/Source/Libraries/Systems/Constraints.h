@@ -1 +1,78 @@
-#pragma once
\ No newline at end of file
+#pragma once
+
+#include "Entity.h"
+#include "Math/MathTypes.h"
+
+namespace jm::Platform
+{
+	class JobSystem;
+}
+
+namespace jm
+{
+	struct constraint_link
+	{
+		u32 a;
+		u32 b;
+	};
+
+	//one tick of the constraint solve, the particles are integrated here and not in the linear pass
+	struct constraint_step
+	{
+		f32 delta_time;
+		f32 damping; //per second, like linear_step
+		math::vector3_f32 acceleration; //gravity and wind, forces are added per particle
+		math::vector3_f32 wall_min;
+		math::vector3_f32 wall_max;
+	};
+
+	//packed copy of the constraint_component_rigid graph, the xpbd solve only touches these arrays
+	//particles and links are re-indexed when constraints or their masses are created/destroyed
+	//links are sorted into colours where no two links of a colour share a particle
+	struct constraint_store
+	{
+		static constexpr u32 max_colours = 64; //links past this share one colour that is solved serially
+
+		//the tick is cut into substeps of one prediction, iterations projections and one velocity update
+		//compliance is scaled by the substep length, so stiffness no longer depends on either count
+		u32 substeps = 12;
+		u32 iterations = 1;
+
+		std::vector<entity_id> particle_entities;
+		std::vector<math::vector3_f32> positions;
+		std::vector<math::vector3_f32> previous_positions; //at the start of the substep, velocities come from the difference
+		std::vector<math::vector3_f32> velocities;
+		std::vector<math::vector3_f32> accelerations; //applied force over mass, gravity and wind come with the step
+		std::vector<f32> inverse_masses; //zero when pinned or asleep
+		std::vector<f32> radii; //keeps spheres inside the walls, zero for other shapes
+		u32 movable_particles = 0; //non-zero inverse masses after the last gather
+
+		std::vector<entity_id> link_entities;
+		std::vector<constraint_link> links;
+		std::vector<f32> link_distances;
+		std::vector<f32> link_compliances;
+		std::vector<f32> lambdas; //accumulated over the iterations of one substep
+		std::vector<f32> break_distances;
+		std::vector<u8> broken;
+		std::vector<u32> colour_offsets; //colour c spans [colour_offsets[c], colour_offsets[c + 1])
+		std::vector<u32> island_links; //link indices grouped by connected island, in store order inside each
+		std::vector<u32> island_batch_offsets; //batch b spans [island_batch_offsets[b], island_batch_offsets[b + 1]) of island_links
+		std::vector<u32> island_particles; //particle indices grouped like island_links
+		std::vector<u32> island_particle_offsets; //batch b spans [island_particle_offsets[b], island_particle_offsets[b + 1]) of island_particles
+
+		Platform::JobSystem* workers = nullptr; //solve each colour in parallel when set
+		Platform::JobSystem* jobs = nullptr; //solve batches of islands as jobs when set, ahead of workers
+
+		bool dirty = true;
+	};
+
+	constraint_store& get_constraint_store(entity_registry& registry);
+
+	//re-indexes the store when dirty and tags its bodies with constraint_particle_component, before the linear pass so it skips them
+	void update_constraint_store(entity_registry& registry, constraint_store& store);
+	void gather_particles(entity_registry& registry, constraint_store& store);
+	void scatter_particles(entity_registry& registry, constraint_store const& store);
+
+	void solve_constraints(constraint_store& store, constraint_step const& step);
+	void destroy_broken_constraints(entity_registry& registry, constraint_store& store);
+}
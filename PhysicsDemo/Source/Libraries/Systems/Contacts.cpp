@@ -0,0 +1,716 @@
+#include "Contacts.h"
+#include "Components.h"
+#include "Islands.h"
+
+#include "Platform/JobSystem.h"
+
+#include <algorithm>
+
+namespace jm
+{
+	constexpr f32 Baumgarte = 0.2f; //fraction of the penetration pushed out per tick
+	constexpr f32 PenetrationSlop = 0.005f; //m left overlapping so resting contacts do not jitter
+	constexpr f32 Friction = 0.4f;
+	constexpr f32 Restitution = 0.3f;
+	constexpr f32 RestitutionThreshold = 1.f; //m/s, slower impacts do not bounce
+	constexpr u32 BatchGrainSize = 64; //manifolds per job, small islands are packed together
+
+	bool collide(math::sphere3<f32> const& a, math::sphere3<f32> const& b, contact_manifold& manifold)
+	{
+		const math::vector3_f32 displacement = b.centre - a.centre;
+		const f32 distanceSquared = dot(displacement, displacement);
+		const f32 reach = a.radius + b.radius;
+		if (distanceSquared >= reach * reach)
+		{
+			return false;
+		}
+
+		const f32 distance = std::sqrt(distanceSquared);
+		manifold.normal = distance > math::epsilon_f32 ? displacement / distance : math::vector3_f32{ 0.f, 1.f, 0.f };
+		manifold.point_count = 1;
+		manifold.points[0].depth = reach - distance;
+		manifold.points[0].position = a.centre + manifold.normal * (a.radius - 0.5f * manifold.points[0].depth);
+		manifold.points[0].feature = 0;
+		return true;
+	}
+
+	bool collide(math::sphere3<f32> const& a, math::box3<f32> const& b, contact_manifold& manifold)
+	{
+		const math::vector3_f32 local = glm::transpose(b.axes) * (a.centre - b.position);
+		const math::vector3_f32 closest = glm::clamp(local, -b.extents, b.extents);
+		const math::vector3_f32 offset = local - closest;
+		const f32 distanceSquared = dot(offset, offset);
+		if (distanceSquared >= a.radius * a.radius)
+		{
+			return false;
+		}
+
+		math::vector3_f32 localNormal{}; //box to sphere
+		math::vector3_f32 surface = closest;
+		f32 depth = 0.f;
+		if (distanceSquared > math::epsilon_f32)
+		{
+			const f32 distance = std::sqrt(distanceSquared);
+			localNormal = offset / distance;
+			depth = a.radius - distance;
+		}
+		else
+		{
+			//centre inside the box, leave through the nearest face
+			const math::vector3_f32 room = b.extents - glm::abs(local);
+			const int axis = room.x < room.y && room.x < room.z ? 0 : (room.y < room.z ? 1 : 2);
+			localNormal[axis] = local[axis] < 0.f ? -1.f : 1.f;
+			surface[axis] = localNormal[axis] * b.extents[axis];
+			depth = a.radius + room[axis];
+		}
+
+		const math::vector3_f32 normal = b.axes * localNormal;
+		manifold.normal = -normal;
+		manifold.point_count = 1;
+		manifold.points[0].depth = depth;
+		manifold.points[0].position = b.position + b.axes * surface + normal * (0.5f * depth);
+		manifold.points[0].feature = 0;
+		return true;
+	}
+
+	struct clip_vertex
+	{
+		math::vector3_f32 position;
+		u32 id;
+	};
+
+	//keeps the part of the polygon where dot(normal, p) <= offset
+	u32 clip_polygon(clip_vertex const* polygon, u32 count, math::vector3_f32 const& normal, f32 offset, u32 plane, clip_vertex* clipped)
+	{
+		u32 clippedCount = 0;
+		for (u32 idx = 0; idx < count; ++idx)
+		{
+			clip_vertex const& current = polygon[idx];
+			clip_vertex const& next = polygon[(idx + 1) % count];
+			const f32 currentDistance = dot(normal, current.position) - offset;
+			const f32 nextDistance = dot(normal, next.position) - offset;
+			if (currentDistance <= 0.f)
+			{
+				clipped[clippedCount++] = current;
+			}
+			if ((currentDistance <= 0.f) != (nextDistance <= 0.f))
+			{
+				//new points are named after the edge and plane that made them
+				const f32 t = currentDistance / (currentDistance - nextDistance);
+				clipped[clippedCount++] = { current.position + t * (next.position - current.position), 16 + ((current.id * 29 + next.id) << 2) + plane };
+			}
+		}
+		return clippedCount;
+	}
+
+	//keeps the deepest point, the one furthest from it and the two spanning the most area either side
+	u32 reduce_contact_points(contact_point* points, u32 count, math::vector3_f32 const& normal)
+	{
+		if (count <= contact_manifold::max_points)
+		{
+			return count;
+		}
+
+		u32 chosen[4] = {};
+		for (u32 idx = 1; idx < count; ++idx)
+		{
+			chosen[0] = points[idx].depth > points[chosen[0]].depth ? idx : chosen[0];
+		}
+
+		f32 furthest = -1.f;
+		for (u32 idx = 0; idx < count; ++idx)
+		{
+			const math::vector3_f32 offset = points[idx].position - points[chosen[0]].position;
+			if (dot(offset, offset) > furthest)
+			{
+				furthest = dot(offset, offset);
+				chosen[1] = idx;
+			}
+		}
+
+		const math::vector3_f32 edge = points[chosen[1]].position - points[chosen[0]].position;
+		f32 mostPositive = 0.f;
+		f32 mostNegative = 0.f;
+		chosen[2] = chosen[0];
+		chosen[3] = chosen[1];
+		for (u32 idx = 0; idx < count; ++idx)
+		{
+			const f32 area = dot(cross(edge, points[idx].position - points[chosen[0]].position), normal);
+			if (area > mostPositive)
+			{
+				mostPositive = area;
+				chosen[2] = idx;
+			}
+			else if (area < mostNegative)
+			{
+				mostNegative = area;
+				chosen[3] = idx;
+			}
+		}
+
+		contact_point reduced[4];
+		u32 reducedCount = 0;
+		for (u32 candidate : chosen)
+		{
+			if (std::find_if(reduced, reduced + reducedCount, [&](contact_point const& point) { return point.feature == points[candidate].feature; }) == reduced + reducedCount)
+			{
+				reduced[reducedCount++] = points[candidate];
+			}
+		}
+		std::copy(reduced, reduced + reducedCount, points);
+		return reducedCount;
+	}
+
+	bool collide(math::box3<f32> const& a, math::box3<f32> const& b, contact_manifold& manifold)
+	{
+		constexpr f32 ParallelTolerance = 1e-5f;
+		constexpr f32 RelativeTolerance = 0.95f; //prefer faces over edges, and a over b, unless clearly shallower
+		constexpr f32 AbsoluteTolerance = 0.01f;
+
+		const math::vector3_f32 between = b.position - a.position;
+
+		//separation along each axis, the contact is on the axis with the greatest (least negative) separation
+		struct sat_axis
+		{
+			f32 separation = -math::infinity<f32>();
+			math::vector3_f32 normal{}; //a to b
+			int first = -1;
+			int second = -1;
+		};
+		auto project = [](math::box3<f32> const& box, math::vector3_f32 const& axis)
+			{
+				return box.extents.x * std::abs(dot(box.axes[0], axis)) + box.extents.y * std::abs(dot(box.axes[1], axis)) + box.extents.z * std::abs(dot(box.axes[2], axis));
+			};
+		auto test = [&](math::vector3_f32 const& axis, sat_axis& best, int first, int second)
+			{
+				const f32 distance = dot(between, axis);
+				const f32 separation = std::abs(distance) - project(a, axis) - project(b, axis);
+				if (separation > best.separation)
+				{
+					best = { separation, distance < 0.f ? -axis : axis, first, second };
+				}
+				return separation <= 0.f;
+			};
+
+		sat_axis faceA;
+		sat_axis faceB;
+		sat_axis edge;
+		for (int idx = 0; idx < 3; ++idx)
+		{
+			if (!test(a.axes[idx], faceA, idx, -1) || !test(b.axes[idx], faceB, -1, idx))
+			{
+				return false;
+			}
+		}
+		for (int idx = 0; idx < 3; ++idx)
+		{
+			for (int jdx = 0; jdx < 3; ++jdx)
+			{
+				const math::vector3_f32 axis = cross(a.axes[idx], b.axes[jdx]);
+				const f32 axisLength = length(axis);
+				if (axisLength > ParallelTolerance && !test(axis / axisLength, edge, idx, jdx))
+				{
+					return false;
+				}
+			}
+		}
+
+		sat_axis face = faceB.separation > RelativeTolerance * faceA.separation + AbsoluteTolerance ? faceB : faceA;
+		manifold.point_count = 0;
+		if (edge.first >= 0 && edge.separation > RelativeTolerance * face.separation + AbsoluteTolerance)
+		{
+			//closest points of the two edges that support the axis
+			manifold.normal = edge.normal;
+			auto support_edge = [](math::box3<f32> const& box, int along, math::vector3_f32 const& towards)
+				{
+					math::vector3_f32 centre = box.position;
+					for (int axis = 0; axis < 3; ++axis)
+					{
+						if (axis != along)
+						{
+							centre += (dot(box.axes[axis], towards) < 0.f ? -box.extents[axis] : box.extents[axis]) * box.axes[axis];
+						}
+					}
+					return centre;
+				};
+			const math::vector3_f32 centreA = support_edge(a, edge.first, edge.normal);
+			const math::vector3_f32 centreB = support_edge(b, edge.second, -edge.normal);
+			const math::vector3_f32 directionA = a.axes[edge.first];
+			const math::vector3_f32 directionB = b.axes[edge.second];
+
+			const math::vector3_f32 offset = centreA - centreB;
+			const f32 alignment = dot(directionA, directionB);
+			const f32 denominator = 1.f - alignment * alignment;
+			f32 s = 0.f;
+			f32 t = 0.f;
+			if (denominator > ParallelTolerance)
+			{
+				s = (alignment * dot(directionB, offset) - dot(directionA, offset)) / denominator;
+				s = std::clamp(s, -a.extents[edge.first], a.extents[edge.first]);
+			}
+			t = std::clamp(dot(directionB, centreA + s * directionA - centreB), -b.extents[edge.second], b.extents[edge.second]);
+
+			contact_point& point = manifold.points[manifold.point_count++];
+			point.position = 0.5f * (centreA + s * directionA + centreB + t * directionB);
+			point.depth = -edge.separation;
+			point.feature = 0x80000000u | (u32(edge.first) << 4) | u32(edge.second);
+			return true;
+		}
+
+		//reference face belongs to the box whose face axis won, the incident face is the other box's face most against it
+		const bool referenceIsB = face.first < 0;
+		math::box3<f32> const& reference = referenceIsB ? b : a;
+		math::box3<f32> const& incident = referenceIsB ? a : b;
+		const int referenceAxis = referenceIsB ? face.second : face.first;
+		const math::vector3_f32 referenceNormal = referenceIsB ? -face.normal : face.normal; //out of the reference box towards the other
+		manifold.normal = face.normal;
+
+		int incidentAxis = 0;
+		f32 mostAgainst = 0.f;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			const f32 alignment = dot(incident.axes[axis], referenceNormal);
+			if (std::abs(alignment) > std::abs(mostAgainst))
+			{
+				mostAgainst = alignment;
+				incidentAxis = axis;
+			}
+		}
+		const f32 incidentSign = mostAgainst > 0.f ? -1.f : 1.f;
+		const int incidentU = (incidentAxis + 1) % 3;
+		const int incidentV = (incidentAxis + 2) % 3;
+		const math::vector3_f32 incidentCentre = incident.position + incidentSign * incident.extents[incidentAxis] * incident.axes[incidentAxis];
+		const math::vector3_f32 incidentU_extent = incident.extents[incidentU] * incident.axes[incidentU];
+		const math::vector3_f32 incidentV_extent = incident.extents[incidentV] * incident.axes[incidentV];
+
+		clip_vertex polygon[16] = {
+			{ incidentCentre + incidentU_extent + incidentV_extent, 0 },
+			{ incidentCentre - incidentU_extent + incidentV_extent, 1 },
+			{ incidentCentre - incidentU_extent - incidentV_extent, 2 },
+			{ incidentCentre + incidentU_extent - incidentV_extent, 3 } };
+		clip_vertex clipped[16];
+		u32 count = 4;
+		for (u32 plane = 0; plane < 4 && count > 0; ++plane)
+		{
+			const int sideAxis = (referenceAxis + 1 + int(plane / 2)) % 3;
+			const math::vector3_f32 sideNormal = (plane % 2 == 0 ? 1.f : -1.f) * reference.axes[sideAxis];
+			const f32 sideOffset = dot(sideNormal, reference.position) + reference.extents[sideAxis];
+			count = clip_polygon(polygon, count, sideNormal, sideOffset, plane, clipped);
+			std::copy(clipped, clipped + count, polygon);
+		}
+
+		const f32 referenceOffset = dot(referenceNormal, reference.position) + reference.extents[referenceAxis];
+		const u32 faceFeature = (referenceIsB ? 0x40000000u : 0u) | (u32(referenceAxis) << 28) | (u32(incidentAxis) << 26) | (incidentSign > 0.f ? 1u << 25 : 0u);
+		contact_point points[16];
+		u32 pointCount = 0;
+		for (u32 idx = 0; idx < count; ++idx)
+		{
+			const f32 depth = referenceOffset - dot(referenceNormal, polygon[idx].position);
+			if (depth >= 0.f)
+			{
+				points[pointCount++] = { polygon[idx].position + (0.5f * depth) * referenceNormal, depth, faceFeature | (polygon[idx].id & 0x1ffffffu) };
+			}
+		}
+
+		pointCount = reduce_contact_points(points, pointCount, referenceNormal);
+		std::copy(points, points + pointCount, manifold.points);
+		manifold.point_count = pointCount;
+		return pointCount > 0;
+	}
+
+	struct solver_body
+	{
+		entity_id entity;
+		math::vector3_f32 position;
+		math::vector3_f32 linear_velocity;
+		math::vector3_f32 angular_velocity;
+		math::matrix33_f32 inverse_inertia; //world space
+		f32 inverse_mass;
+		linear_body3_component* linear; //resolved before the batches run, jobs never look anything up in the registry
+		rotational_body3_component* angular;
+	};
+
+	struct contact_constraint
+	{
+		u32 a;
+		u32 b;
+		math::vector3_f32 normal;
+		math::vector3_f32 tangents[2];
+		math::vector3_f32 arm_a;
+		math::vector3_f32 arm_b;
+		f32 normal_mass;
+		f32 tangent_masses[2];
+		f32 bias; //target separating speed
+		f32 normal_impulse;
+		f32 tangent_impulses[2];
+	};
+
+	struct body_slot
+	{
+		u32 batch = ~u32(0);
+		u32 body = 0;
+	};
+
+	//one solver copy per body and batch, immovable bodies are copied into every batch that touches them so batches share nothing
+	u32 find_or_add_body(entity_registry& registry, std::vector<solver_body>& bodies, std::vector<body_slot>& entityBodies, u32 batch, entity_id entity)
+	{
+		const size_t slot = static_cast<size_t>(entt::to_entity(entity));
+		if (slot >= entityBodies.size())
+		{
+			entityBodies.resize(slot + 1);
+		}
+		if (entityBodies[slot].batch == batch)
+		{
+			return entityBodies[slot].body;
+		}
+
+		solver_body body{ entity, registry.get<spatial3_component>(entity).position, {}, {}, math::matrix33_f32(0.f), 0.f, nullptr, nullptr };
+		if (is_awake_body(registry, entity))
+		{
+			body.linear = &registry.get<linear_body3_component>(entity);
+			body.linear_velocity = body.linear->velocity;
+			body.inverse_mass = body.linear->inverse_mass;
+			body.angular = registry.try_get<rotational_body3_component>(entity);
+			if (body.angular != nullptr)
+			{
+				const math::matrix33_f32 rotation = math::quat_to_mat(registry.get<spatial3_component>(entity).orientation);
+				body.angular_velocity = body.angular->velocity;
+				body.inverse_inertia = rotation * math::diagonal_matrix3(body.angular->inverse_inertia) * transpose(rotation);
+			}
+		}
+
+		entityBodies[slot] = { batch, static_cast<u32>(bodies.size()) };
+		bodies.push_back(body);
+		return entityBodies[slot].body;
+	}
+
+	f32 effective_mass(solver_body const& a, solver_body const& b, math::vector3_f32 const& arm_a, math::vector3_f32 const& arm_b, math::vector3_f32 const& direction)
+	{
+		const math::vector3_f32 angularA = cross(a.inverse_inertia * cross(arm_a, direction), arm_a);
+		const math::vector3_f32 angularB = cross(b.inverse_inertia * cross(arm_b, direction), arm_b);
+		const f32 inverse = a.inverse_mass + b.inverse_mass + dot(angularA + angularB, direction);
+		return inverse > 0.f ? 1.f / inverse : 0.f;
+	}
+
+	math::vector3_f32 relative_velocity(solver_body const& a, solver_body const& b, contact_constraint const& constraint)
+	{
+		return b.linear_velocity + cross(b.angular_velocity, constraint.arm_b) - a.linear_velocity - cross(a.angular_velocity, constraint.arm_a);
+	}
+
+	void apply_impulse(solver_body& a, solver_body& b, contact_constraint const& constraint, math::vector3_f32 const& impulse)
+	{
+		a.linear_velocity -= a.inverse_mass * impulse;
+		a.angular_velocity -= a.inverse_inertia * cross(constraint.arm_a, impulse);
+		b.linear_velocity += b.inverse_mass * impulse;
+		b.angular_velocity += b.inverse_inertia * cross(constraint.arm_b, impulse);
+	}
+
+	u64 contact_pair_key(entity_id a, entity_id b)
+	{
+		const u64 first = static_cast<u64>(entt::to_integral(a));
+		const u64 second = static_cast<u64>(entt::to_integral(b));
+		return first < second ? (first << 32) | second : (second << 32) | first;
+	}
+
+	contact_cache& get_contact_cache(entity_registry& registry)
+	{
+		if (contact_cache* cache = registry.ctx().find<contact_cache>())
+		{
+			return *cache;
+		}
+		return registry.ctx().emplace<contact_cache>();
+	}
+
+	//manifolds that share no movable body are independent, batch b spans [batchOffsets[b], batchOffsets[b + 1]) of order
+	//islands keep the manifolds in their original order and are packed into batches of at least BatchGrainSize
+	void batch_contact_islands(entity_registry& registry, std::vector<contact_manifold> const& manifolds, bool split, std::vector<u32>& order, std::vector<u32>& batchOffsets)
+	{
+		constexpr u32 no_slot = ~u32(0);
+		std::vector<u32> movableSlots(2 * manifolds.size(), no_slot); //entity slots of the movable bodies of each manifold
+		u32 slotCount = 0;
+		for (u32 idx = 0; idx < manifolds.size(); ++idx)
+		{
+			if (is_awake_body(registry, manifolds[idx].a))
+			{
+				movableSlots[2 * idx] = static_cast<u32>(entt::to_entity(manifolds[idx].a));
+				slotCount = std::max(slotCount, movableSlots[2 * idx] + 1);
+			}
+			if (is_awake_body(registry, manifolds[idx].b))
+			{
+				movableSlots[2 * idx + 1] = static_cast<u32>(entt::to_entity(manifolds[idx].b));
+				slotCount = std::max(slotCount, movableSlots[2 * idx + 1] + 1);
+			}
+		}
+
+		order.clear();
+		batchOffsets.assign(1, 0);
+		if (!split)
+		{
+			for (u32 idx = 0; idx < manifolds.size(); ++idx)
+			{
+				if (movableSlots[2 * idx] != no_slot || movableSlots[2 * idx + 1] != no_slot)
+				{
+					order.push_back(idx);
+				}
+			}
+			batchOffsets.push_back(static_cast<u32>(order.size()));
+			return;
+		}
+
+		//union-find over entity slots, immovable bodies join nothing
+		std::vector<u32> parents(slotCount);
+		for (u32 slot = 0; slot < slotCount; ++slot)
+		{
+			parents[slot] = slot;
+		}
+		for (u32 idx = 0; idx < manifolds.size(); ++idx)
+		{
+			if (movableSlots[2 * idx] != no_slot && movableSlots[2 * idx + 1] != no_slot)
+			{
+				parents[find_island_root(parents, movableSlots[2 * idx])] = find_island_root(parents, movableSlots[2 * idx + 1]);
+			}
+		}
+
+		//counting sort the manifolds by island, stable so each island solves in the same order as a single batch would
+		std::vector<u32> rootIslands(slotCount, no_slot);
+		std::vector<u32> manifoldIslands(manifolds.size(), no_slot);
+		std::vector<u32> islandOffsets(1, 0);
+		for (u32 idx = 0; idx < manifolds.size(); ++idx)
+		{
+			const u32 slot = movableSlots[2 * idx] != no_slot ? movableSlots[2 * idx] : movableSlots[2 * idx + 1];
+			if (slot == no_slot)
+			{
+				continue;
+			}
+			u32& island = rootIslands[find_island_root(parents, slot)];
+			if (island == no_slot)
+			{
+				island = static_cast<u32>(islandOffsets.size() - 1);
+				islandOffsets.push_back(0);
+			}
+			manifoldIslands[idx] = island;
+			++islandOffsets[island + 1];
+		}
+		for (size_t island = 1; island < islandOffsets.size(); ++island)
+		{
+			islandOffsets[island] += islandOffsets[island - 1];
+		}
+		order.resize(islandOffsets.back());
+		{
+			std::vector<u32> cursor(islandOffsets.begin(), islandOffsets.end() - 1);
+			for (u32 idx = 0; idx < manifolds.size(); ++idx)
+			{
+				if (manifoldIslands[idx] != no_slot)
+				{
+					order[cursor[manifoldIslands[idx]]++] = idx;
+				}
+			}
+		}
+
+		for (size_t island = 1; island < islandOffsets.size(); ++island)
+		{
+			if (islandOffsets[island] - batchOffsets.back() >= BatchGrainSize || island + 1 == islandOffsets.size())
+			{
+				batchOffsets.push_back(islandOffsets[island]);
+			}
+		}
+	}
+
+	using cached_entry = std::pair<u64, contact_cache::cached_manifold>;
+
+	//sequential impulses over one batch, which owns bodies [bodyBegin, bodyEnd) and nothing else
+	void solve_contact_batch(contact_cache const& cache, std::vector<contact_manifold> const& manifolds
+		, u32 const* batchManifolds, u32 manifoldCount, std::pair<u32, u32> const* manifoldBodies
+		, solver_body* bodies, u32 bodyCount, f32 delta_time, std::vector<cached_entry>& cachedOut)
+	{
+		std::vector<contact_constraint> constraints;
+		std::vector<u32> manifoldOffsets; //constraints of the nth manifold of the batch start at manifoldOffsets[n]
+		manifoldOffsets.reserve(manifoldCount + 1);
+		for (u32 batchIndex = 0; batchIndex < manifoldCount; ++batchIndex)
+		{
+			contact_manifold const& manifold = manifolds[batchManifolds[batchIndex]];
+			const u32 a = manifoldBodies[batchIndex].first;
+			const u32 b = manifoldBodies[batchIndex].second;
+			manifoldOffsets.push_back(static_cast<u32>(constraints.size()));
+
+			contact_cache::cached_manifold const* cached = nullptr;
+			if (cache.warm_starting)
+			{
+				auto found = cache.manifolds.find(contact_pair_key(manifold.a, manifold.b));
+				cached = found != cache.manifolds.end() ? &found->second : nullptr;
+			}
+			//friction is cached as the impulse on b, flip it when the pair comes back the other way around
+			const f32 frictionSign = cached != nullptr && cached->a != manifold.a ? -1.f : 1.f;
+
+			contact_constraint constraint{};
+			constraint.a = a;
+			constraint.b = b;
+			constraint.normal = manifold.normal;
+			const math::vector3_f32 helper = std::abs(manifold.normal.x) < 0.57f ? math::vector3_f32{ 1.f, 0.f, 0.f } : math::vector3_f32{ 0.f, 1.f, 0.f };
+			constraint.tangents[0] = normalize(cross(manifold.normal, helper));
+			constraint.tangents[1] = cross(manifold.normal, constraint.tangents[0]);
+			for (u32 idx = 0; idx < manifold.point_count; ++idx)
+			{
+				contact_point const& point = manifold.points[idx];
+				constraint.arm_a = point.position - bodies[a].position;
+				constraint.arm_b = point.position - bodies[b].position;
+				constraint.normal_mass = effective_mass(bodies[a], bodies[b], constraint.arm_a, constraint.arm_b, constraint.normal);
+				constraint.tangent_masses[0] = effective_mass(bodies[a], bodies[b], constraint.arm_a, constraint.arm_b, constraint.tangents[0]);
+				constraint.tangent_masses[1] = effective_mass(bodies[a], bodies[b], constraint.arm_a, constraint.arm_b, constraint.tangents[1]);
+
+				//push out what is past the slop, and bounce fast approaches
+				const f32 approach = dot(relative_velocity(bodies[a], bodies[b], constraint), constraint.normal);
+				constraint.bias = Baumgarte / delta_time * std::max(point.depth - PenetrationSlop, 0.f);
+				if (approach < -RestitutionThreshold)
+				{
+					constraint.bias = std::max(constraint.bias, -Restitution * approach);
+				}
+
+				constraint.normal_impulse = 0.f;
+				constraint.tangent_impulses[0] = 0.f;
+				constraint.tangent_impulses[1] = 0.f;
+				if (cached != nullptr)
+				{
+					for (u32 jdx = 0; jdx < cached->point_count; ++jdx)
+					{
+						if (cached->points[jdx].feature == point.feature)
+						{
+							const math::vector3_f32 friction = frictionSign * cached->points[jdx].friction_impulse;
+							constraint.normal_impulse = cached->points[jdx].normal_impulse;
+							constraint.tangent_impulses[0] = dot(friction, constraint.tangents[0]);
+							constraint.tangent_impulses[1] = dot(friction, constraint.tangents[1]);
+							break;
+						}
+					}
+				}
+				constraints.push_back(constraint);
+			}
+		}
+		manifoldOffsets.push_back(static_cast<u32>(constraints.size()));
+
+		//warm start, apply what the same contacts needed last tick
+		for (contact_constraint const& constraint : constraints)
+		{
+			const math::vector3_f32 impulse = constraint.normal_impulse * constraint.normal +
+				constraint.tangent_impulses[0] * constraint.tangents[0] + constraint.tangent_impulses[1] * constraint.tangents[1];
+			apply_impulse(bodies[constraint.a], bodies[constraint.b], constraint, impulse);
+		}
+
+		for (int iteration = 0; iteration < cache.iterations; ++iteration)
+		{
+			for (contact_constraint& constraint : constraints)
+			{
+				solver_body& a = bodies[constraint.a];
+				solver_body& b = bodies[constraint.b];
+
+				//friction first so the normal impulse, which matters more, is solved last
+				for (int tangent = 0; tangent < 2; ++tangent)
+				{
+					const f32 speed = dot(relative_velocity(a, b, constraint), constraint.tangents[tangent]);
+					const f32 limit = Friction * constraint.normal_impulse;
+					const f32 previous = constraint.tangent_impulses[tangent];
+					constraint.tangent_impulses[tangent] = std::clamp(previous - speed * constraint.tangent_masses[tangent], -limit, limit);
+					apply_impulse(a, b, constraint, (constraint.tangent_impulses[tangent] - previous) * constraint.tangents[tangent]);
+				}
+
+				const f32 speed = dot(relative_velocity(a, b, constraint), constraint.normal);
+				const f32 previous = constraint.normal_impulse;
+				constraint.normal_impulse = std::max(previous + (constraint.bias - speed) * constraint.normal_mass, 0.f);
+				apply_impulse(a, b, constraint, (constraint.normal_impulse - previous) * constraint.normal);
+			}
+		}
+
+		//each movable body is in exactly one batch, so batches write disjoint components
+		for (u32 idx = 0; idx < bodyCount; ++idx)
+		{
+			solver_body const& body = bodies[idx];
+			if (body.linear == nullptr || body.inverse_mass == 0.f)
+			{
+				continue;
+			}
+			body.linear->velocity = body.linear_velocity;
+			if (body.angular != nullptr)
+			{
+				body.angular->velocity = body.angular_velocity;
+			}
+		}
+
+		if (!cache.warm_starting)
+		{
+			return;
+		}
+		for (u32 batchIndex = 0; batchIndex < manifoldCount; ++batchIndex)
+		{
+			contact_manifold const& manifold = manifolds[batchManifolds[batchIndex]];
+			cached_entry& entry = cachedOut.emplace_back();
+			entry.first = contact_pair_key(manifold.a, manifold.b);
+			entry.second.a = manifold.a;
+			entry.second.point_count = manifold.point_count;
+			for (u32 idx = 0; idx < manifold.point_count; ++idx)
+			{
+				contact_constraint const& constraint = constraints[manifoldOffsets[batchIndex] + idx];
+				entry.second.points[idx].feature = manifold.points[idx].feature;
+				entry.second.points[idx].normal_impulse = constraint.normal_impulse;
+				entry.second.points[idx].friction_impulse = constraint.tangent_impulses[0] * constraint.tangents[0] + constraint.tangent_impulses[1] * constraint.tangents[1];
+			}
+		}
+	}
+
+	void solve_contacts(entity_registry& registry, std::vector<contact_manifold> const& manifolds, f32 delta_time)
+	{
+		contact_cache& cache = get_contact_cache(registry);
+		const bool split = cache.jobs != nullptr && cache.jobs->GetThreadCount() > 1;
+
+		std::vector<u32> order;
+		std::vector<u32> batchOffsets;
+		batch_contact_islands(registry, manifolds, split, order, batchOffsets);
+		const u32 batchCount = static_cast<u32>(batchOffsets.size() - 1);
+
+		//copy the bodies in serially with pointers to their components, batches write through those and never touch the registry
+		std::vector<solver_body> bodies;
+		std::vector<body_slot> entityBodies;
+		std::vector<std::pair<u32, u32>> manifoldBodies(order.size());
+		std::vector<u32> bodyOffsets(1, 0);
+		for (u32 batch = 0; batch < batchCount; ++batch)
+		{
+			for (u32 idx = batchOffsets[batch]; idx < batchOffsets[batch + 1]; ++idx)
+			{
+				contact_manifold const& manifold = manifolds[order[idx]];
+				manifoldBodies[idx].first = find_or_add_body(registry, bodies, entityBodies, batch, manifold.a) - bodyOffsets[batch];
+				manifoldBodies[idx].second = find_or_add_body(registry, bodies, entityBodies, batch, manifold.b) - bodyOffsets[batch];
+			}
+			bodyOffsets.push_back(static_cast<u32>(bodies.size()));
+		}
+
+		std::vector<std::vector<cached_entry>> cachedBatches(batchCount);
+		auto solve_batch = [&](u32 batch)
+			{
+				solve_contact_batch(cache, manifolds
+					, order.data() + batchOffsets[batch], batchOffsets[batch + 1] - batchOffsets[batch], manifoldBodies.data() + batchOffsets[batch]
+					, bodies.data() + bodyOffsets[batch], bodyOffsets[batch + 1] - bodyOffsets[batch], delta_time, cachedBatches[batch]);
+			};
+		if (split && batchCount > 1)
+		{
+			Platform::JobCounter counter;
+			for (u32 batch = 0; batch < batchCount; ++batch)
+			{
+				cache.jobs->Run(counter, [&solve_batch, batch]() { solve_batch(batch); });
+			}
+			cache.jobs->Wait(counter);
+		}
+		else if (batchCount == 1)
+		{
+			solve_batch(0);
+		}
+
+		//only this tick's contacts are kept, so pairs that separated expire
+		cache.manifolds.clear();
+		for (std::vector<cached_entry> const& cachedBatch : cachedBatches)
+		{
+			for (cached_entry const& entry : cachedBatch)
+			{
+				cache.manifolds[entry.first] = entry.second;
+			}
+		}
+	}
+}
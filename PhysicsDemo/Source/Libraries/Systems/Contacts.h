@@ -0,0 +1,68 @@
+#pragma once
+
+#include "Entity.h"
+#include "Math/Geometry.h"
+
+#include <unordered_map>
+
+namespace jm::Platform
+{
+	class JobSystem;
+}
+
+namespace jm
+{
+	struct contact_point
+	{
+		math::vector3_f32 position{}; //world, halfway between the two surfaces
+		f32 depth = 0.f; //positive while overlapping
+		u32 feature = 0; //which features of the two shapes made the point, same value while the contact persists
+	};
+
+	//normal is shared by every point and points from a to b
+	struct contact_manifold
+	{
+		static constexpr u32 max_points = 4;
+
+		entity_id a = null_entity_id;
+		entity_id b = null_entity_id;
+		math::vector3_f32 normal{};
+		u32 point_count = 0;
+		contact_point points[max_points]{};
+	};
+
+	struct cached_contact
+	{
+		u32 feature = 0;
+		f32 normal_impulse = 0.f;
+		math::vector3_f32 friction_impulse{}; //world space, as applied to b
+	};
+
+	//impulses each contact ended the last tick with, kept in the registry context
+	//contacts that reappear start from them (warm starting), pairs that were not touching last tick are dropped
+	struct contact_cache
+	{
+		struct cached_manifold
+		{
+			entity_id a = null_entity_id;
+			u32 point_count = 0;
+			cached_contact points[contact_manifold::max_points]{};
+		};
+
+		int iterations = 4; //solver iterations per tick
+		bool warm_starting = true;
+		Platform::JobSystem* jobs = nullptr; //solve independent islands as jobs when set
+		std::unordered_map<u64, cached_manifold> manifolds; //keyed on the entity pair, lower id first
+	};
+
+	contact_cache& get_contact_cache(entity_registry& registry);
+
+	//narrowphase, fills the normal and points and returns false when the shapes are apart
+	bool collide(math::sphere3<f32> const& a, math::sphere3<f32> const& b, contact_manifold& manifold);
+	bool collide(math::sphere3<f32> const& a, math::box3<f32> const& b, contact_manifold& manifold);
+	bool collide(math::box3<f32> const& a, math::box3<f32> const& b, contact_manifold& manifold); //separating axis test, face contacts are clipped
+
+	//sequential impulses with friction warm started from the contact cache, writes linear_body3_component and rotational_body3_component velocities
+	//islands that share no movable body give the same result whether they are solved together or as separate jobs
+	void solve_contacts(entity_registry& registry, std::vector<contact_manifold> const& manifolds, f32 delta_time);
+}
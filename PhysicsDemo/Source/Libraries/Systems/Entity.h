@@ -7,4 +7,10 @@ namespace jm
 	using entity_id = entt::entity;
 	using entity_registry = entt::registry;
 	constexpr auto null_entity_id = entt::null;
+
+	struct entity_pair
+	{
+		entity_id first;
+		entity_id second;
+	};
 }
\ No newline at end of file
@@ -1,5 +1,4 @@
 #include "Graphics.h"
-#include "Components.h"
 
 #include "Visual/DearImGui/ImGuiContext.h"
 #include "Visual/VisualGeometry.h"
@@ -8,13 +7,29 @@
 
 namespace jm::System
 {
-	Graphics::Data2D::Data2D(cstring vertexSource, cstring fragmentSource)
-		: Program(vertexSource, fragmentSource)
+	//matches the { 3, 3 } lines layout, so lines are written into the stream buffer as they are
+	struct LineVertex
+	{
+		math::vector3_f32 position;
+		math::colour3_f32 colour;
+	};
+	static_assert(sizeof(LineVertex) == 6 * sizeof(f32));
+
+	Graphics::Data2D::Data2D(cstring instancedVertexSource, cstring vertexSource, cstring fragmentSource)
+		: InstancedProgram(instancedVertexSource, fragmentSource)
+		, Program(vertexSource, fragmentSource)
+		, instancedView(InstancedProgram.GetUniform<math::matrix33_f32>("view"))
+		, view(Program.GetUniform<math::matrix33_f32>("view"))
+		, model(Program.GetUniform<math::matrix33_f32>("model"))
 	{
 	}
 
-	Graphics::Data3D::Data3D(cstring vertexSource, cstring fragmentSource)
-		: Program(vertexSource, fragmentSource)
+	Graphics::Data3D::Data3D(cstring instancedVertexSource, cstring vertexSource, cstring fragmentSource)
+		: InstancedProgram(instancedVertexSource, fragmentSource)
+		, Program(vertexSource, fragmentSource)
+		, instancedProjectionView(InstancedProgram.GetUniform<math::matrix44_f32>("projectionView"))
+		, projectionView(Program.GetUniform<math::matrix44_f32>("projectionView"))
+		, model(Program.GetUniform<math::matrix44_f32>("model"))
 	{
 	}
 
@@ -31,13 +46,28 @@ namespace jm::System
 			}
 			)";
 
-	Graphics::Graphics(Platform::Window& window, entity_registry& registry, math::vector3_f32 const& clearColour)
+	Graphics::Graphics(Platform::Window& window, math::vector3_f32 const& clearColour)
 		: Renderer(window)
-		, EntityRegistry(registry)
 		, TwoDimensional(R"(
 			#version 330 core
 			layout (location = 0) in vec2 inPosition;
 			layout (location = 1) in vec3 inColour;
+			layout (location = 2) in mat3 inModel;
+			  
+			out vec3 outColour;
+			
+			uniform mat3 view;
+			
+			void main()
+			{
+				vec3 worldPosition = view * inModel * vec3(inPosition, -1.0);
+			    gl_Position = vec4(worldPosition, 1.0);
+				outColour = inColour;
+			}
+			)", R"(
+			#version 330 core
+			layout (location = 0) in vec2 inPosition;
+			layout (location = 1) in vec3 inColour;
 			  
 			out vec3 outColour;
 			
@@ -55,6 +85,21 @@ namespace jm::System
 			#version 330 core
 			layout (location = 0) in vec3 inPosition;
 			layout (location = 1) in vec3 inColour;
+			layout (location = 2) in mat4 inModel;
+			  
+			out vec3 outColour;
+			
+			uniform mat4 projectionView;
+			
+			void main()
+			{
+			    gl_Position = projectionView * inModel * vec4(inPosition, 1.0);
+				outColour = inColour;
+			}
+			)", R"(
+			#version 330 core
+			layout (location = 0) in vec3 inPosition;
+			layout (location = 1) in vec3 inColour;
 			  
 			out vec3 outColour;
 			
@@ -72,52 +117,48 @@ namespace jm::System
 		{
 			Visual::InputLayout layout{ {2, 3 } };
 
-			byte_list inputVertexData;
-			{
-				auto boxVertexData = Visual::GenerateBox(layout);
-				inputVertexData.insert(inputVertexData.end(), boxVertexData.data.begin(), boxVertexData.data.end());
-				TwoDimensional.squareVertices = (GLsizei)boxVertexData.size;
-			}
-			{
-				auto diskVertexData = Visual::GenerateDisk(layout);
-				inputVertexData.insert(inputVertexData.end(), diskVertexData.data.begin(), diskVertexData.data.end());
-				TwoDimensional.diskVertices = (GLsizei)diskVertexData.size;
-			}
+			Visual::RawBuffer vertexData;
+			std::vector<u32> indexData;
+			TwoDimensional.square = AppendMesh(Visual::GenerateBox(layout), vertexData, indexData);
+			TwoDimensional.disk = AppendMesh(Visual::GenerateDisk(layout), vertexData, indexData);
 			{
 				auto axesVertexData = Visual::GenerateCoordinateAxes2(layout);
-				inputVertexData.insert(inputVertexData.end(), axesVertexData.data.begin(), axesVertexData.data.end());
+				TwoDimensional.axesStart = (GLint)vertexData.size;
 				TwoDimensional.axesVertices = (GLsizei)axesVertexData.size;
+				vertexData.Append(std::move(axesVertexData));
 			}
 
 			TwoDimensional.Program.MakeActive();
 			TwoDimensional.inputLayoutHandle = Renderer.RasterizerMemory->createInputLayout(layout);
-			TwoDimensional.inputBufferHandle = Renderer.RasterizerMemory->createInputBuffer(TwoDimensional.inputLayoutHandle, inputVertexData);
+			TwoDimensional.inputBufferHandle = Renderer.RasterizerMemory->createInputBuffer(TwoDimensional.inputLayoutHandle, vertexData.data);
+			TwoDimensional.indexBufferHandle = Renderer.RasterizerMemory->createIndexBuffer(TwoDimensional.inputLayoutHandle, indexData);
+			TwoDimensional.instanceBufferHandle = Renderer.RasterizerMemory->createInstanceBuffer(TwoDimensional.inputLayoutHandle, Visual::InputLayout{ { 3, 3, 3 } });
 		}
 		{
 			Visual::InputLayout layout{ { 3, 3 } };
 
-			byte_list inputVertexData;
-			{
-				auto cubeVertexData = Visual::GenerateCube(layout);
-				inputVertexData.insert(inputVertexData.end(), cubeVertexData.data.begin(), cubeVertexData.data.end());
-				ThreeDimensional.cubeVertices = (GLsizei)cubeVertexData.size;
-			}
+			Visual::RawBuffer vertexData;
+			std::vector<u32> indexData;
+			ThreeDimensional.cube = AppendMesh(Visual::GenerateCube(layout), vertexData, indexData);
+			for (uSize level = 0; level < sphere_lods.size(); ++level)
 			{
-				auto sphereVertexData = Visual::GenerateSphere(layout);
-				inputVertexData.insert(inputVertexData.end(), sphereVertexData.data.begin(), sphereVertexData.data.end());
-				ThreeDimensional.sphereVertices = (GLsizei)sphereVertexData.size;
+				ThreeDimensional.spheres[level] = AppendMesh(Visual::GenerateSphere(layout, 2.0f, sphere_lods[level].slices, sphere_lods[level].layers), vertexData, indexData);
 			}
 			{
 				auto axesVertexData = Visual::GenerateCoordinateAxes3(layout);
-				inputVertexData.insert(inputVertexData.end(), axesVertexData.data.begin(), axesVertexData.data.end());
+				ThreeDimensional.axesStart = (GLint)vertexData.size;
 				ThreeDimensional.axesVertices = (GLsizei)axesVertexData.size;
+				vertexData.Append(std::move(axesVertexData));
 			}
 
 			ThreeDimensional.Program.MakeActive();
 			ThreeDimensional.inputLayoutHandle = Renderer.RasterizerMemory->createInputLayout(layout);
-			ThreeDimensional.inputBufferHandle = Renderer.RasterizerMemory->createInputBuffer(ThreeDimensional.inputLayoutHandle, inputVertexData);
+			ThreeDimensional.inputBufferHandle = Renderer.RasterizerMemory->createInputBuffer(ThreeDimensional.inputLayoutHandle, vertexData.data);
+			ThreeDimensional.indexBufferHandle = Renderer.RasterizerMemory->createIndexBuffer(ThreeDimensional.inputLayoutHandle, indexData);
+			ThreeDimensional.instanceBufferHandle = Renderer.RasterizerMemory->createInstanceBuffer(ThreeDimensional.inputLayoutHandle, Visual::InputLayout{ { 4, 4, 4, 4 } });
 
 			ThreeDimensional.linesLayoutHandle = Renderer.RasterizerMemory->createInputLayout(layout);
+			ThreeDimensional.linesStreamHandle = Renderer.RasterizerMemory->createStreamBuffer(ThreeDimensional.linesLayoutHandle, 1024 * sizeof(LineVertex));
 		}
 
 		glEnable(GL_DEPTH_TEST);
@@ -125,147 +166,129 @@ namespace jm::System
 
 	Graphics::~Graphics()
 	{
+		Renderer.RasterizerMemory->destroyInputBuffer(TwoDimensional.inputLayoutHandle, TwoDimensional.instanceBufferHandle);
+		Renderer.RasterizerMemory->destroyInputBuffer(TwoDimensional.inputLayoutHandle, TwoDimensional.indexBufferHandle);
 		Renderer.RasterizerMemory->destroyInputBuffer(TwoDimensional.inputLayoutHandle, TwoDimensional.inputBufferHandle);
 		Renderer.RasterizerMemory->destroyInputLayout(TwoDimensional.inputLayoutHandle);
 
+		Renderer.RasterizerMemory->destroyInputBuffer(ThreeDimensional.inputLayoutHandle, ThreeDimensional.instanceBufferHandle);
+		Renderer.RasterizerMemory->destroyInputBuffer(ThreeDimensional.inputLayoutHandle, ThreeDimensional.indexBufferHandle);
 		Renderer.RasterizerMemory->destroyInputBuffer(ThreeDimensional.inputLayoutHandle, ThreeDimensional.inputBufferHandle);
 		Renderer.RasterizerMemory->destroyInputLayout(ThreeDimensional.inputLayoutHandle);
-	}
 
-	Platform::MessageHandler* Graphics::GetMessageHandler()
-	{
-		return Renderer.ImGuiContextPtr->GetMessageHandler();
+		Renderer.RasterizerMemory->destroyInputBuffer(ThreeDimensional.linesLayoutHandle, ThreeDimensional.linesStreamHandle);
+		Renderer.RasterizerMemory->destroyInputLayout(ThreeDimensional.linesLayoutHandle);
 	}
 
-	template <typename T>
-	auto&& get_shapes2(entity_registry& registry)
+	Graphics::IndexedMesh Graphics::AppendMesh(Visual::IndexedBuffer&& mesh, Visual::RawBuffer& vertexData, std::vector<u32>& indexData)
 	{
-		auto shape_entity_view = registry.view<const T, const spatial2_component>();
-		return shape_entity_view.each();
+		IndexedMesh appended{ indexData.size(), mesh.indices.size(), (GLint)vertexData.size };
+		indexData.insert(indexData.end(), mesh.indices.begin(), mesh.indices.end());
+		vertexData.Append(std::move(mesh.vertices));
+		return appended;
 	}
 
-	template <typename T>
-	auto&& get_shapes3(entity_registry& registry)
+	Platform::MessageHandler* Graphics::GetMessageHandler()
 	{
-		auto shape_entity_view = registry.view<const T, const spatial3_component>();
-		return shape_entity_view.each();
+		return Renderer.ImGuiContextPtr->GetMessageHandler();
 	}
 
-	void Graphics::Draw(math::camera3<f32> const& camera, std::function<void()>&& imguiFrame)
+	void Graphics::Draw(math::camera3<f32> const& camera, render_snapshot const& snapshot, f32 alpha, std::function<void()>&& imguiFrame)
 	{
-		std::vector<math::matrix33_f32> diskInstances;
-		std::vector<math::matrix33_f32> squareInstances;
-		std::vector<math::matrix44_f32> sphereInstances;
-		std::vector<math::matrix44_f32> cubeInstances;
-		{
-			auto disk_entity_view = EntityRegistry.view<const disk_shape_component, const spatial2_component>();
-			diskInstances.reserve(disk_entity_view.size_hint());
-			for (auto&& [entity, shape, spatial] : disk_entity_view.each())
-			{
-				diskInstances.push_back(math::isometry_matrix2(spatial.position, spatial.orientation) * math::scale_matrix2(shape.radius));
-			}
-		}
-		{
-			auto rectangle_entity_view = EntityRegistry.view<const rectangle_shape_component, const spatial2_component>();
-			squareInstances.reserve(rectangle_entity_view.size_hint());
-			for (auto&& [entity, shape, spatial] : rectangle_entity_view.each())
-			{
-				squareInstances.push_back(math::isometry_matrix2(spatial.position, spatial.orientation) * math::scale_matrix2(shape.extents));
-			}
-		}
+		const math::matrix44_f32 projectionView = camera.get_perspective_transform() * camera.get_view_transform();
+		render_view renderView = make_render_view(camera.get_perspective_transform(), camera.get_view_transform());
+		if (!Culling)
 		{
-			auto sphere_entity_view = EntityRegistry.view<const sphere_shape_component, const spatial3_component>();
-			sphereInstances.reserve(sphere_entity_view.size_hint());
-			for (auto&& [entity, shape, spatial] : sphere_entity_view.each())
-			{
-				sphereInstances.push_back(math::isometry_matrix3(spatial.position, spatial.orientation) * math::scale_matrix3(shape.radius));
-			}
-		}
-		{
-			auto box_entity_view = EntityRegistry.view<const box_shape_component, const spatial3_component>();
-			cubeInstances.reserve(box_entity_view.size_hint());
-			for (auto&& [entity, shape, spatial] : box_entity_view.each())
-			{
-				cubeInstances.push_back(math::isometry_matrix3(spatial.position, spatial.orientation) * math::scale_matrix3(shape.extents));
-			}
-		}
-		//===============================================================================================
-		std::vector<math::vector3_f32> lines;
-		{
-			auto constraint_lines_view = EntityRegistry.view<const constraint_component_rigid>();
-			for (auto&& [entity, constraint] : constraint_lines_view.each())
-			{
-				spatial3_component massAPos = EntityRegistry.get<spatial3_component>(constraint.massA);
-				spatial3_component massBPos = EntityRegistry.get<spatial3_component>(constraint.massB);
-				lines.push_back(massAPos.position);
-				lines.push_back(massBPos.position);
-			}
+			renderView.frustum = {};
 		}
+		build_render_instances(snapshot, alpha, renderView, Instances);
 		//===============================================================================================
 		Renderer.RasterizerImpl->PrepareRenderBuffer(ClearColour);
 
 		{
-			ThreeDimensional.Program.MakeActive();
-
 			glBindVertexArray(static_cast<GLuint>(ThreeDimensional.inputLayoutHandle));
-			ThreeDimensional.Program.SetUniform("projectionView", camera.get_perspective_transform() * camera.get_view_transform());
+			Renderer.RasterizerMemory->updateInstanceBuffer(ThreeDimensional.inputLayoutHandle, Instances.solids.data(), Instances.solids.size() * sizeof(math::matrix44_f32));
 
-			GLsizei start = 0;
-			for (auto& instance : cubeInstances)
+			ThreeDimensional.InstancedProgram.MakeActive();
+			ThreeDimensional.InstancedProgram.SetUniform(ThreeDimensional.instancedProjectionView, projectionView);
+
+			if (Instances.boxes != 0)
 			{
-				ThreeDimensional.Program.SetUniform("model", instance);
-				glDrawArrays(GL_TRIANGLES, start, ThreeDimensional.cubeVertices);
+				const IndexedMesh& cube = ThreeDimensional.cube;
+				Renderer.RasterizerMemory->selectInstances(ThreeDimensional.inputLayoutHandle, 0);
+				Renderer.RasterizerMemory->drawIndexed(ThreeDimensional.inputLayoutHandle, GL_TRIANGLES, cube.firstIndex, cube.indices, cube.baseVertex, Instances.boxes);
 			}
-			start += ThreeDimensional.cubeVertices;
 
-			for (auto& instance : sphereInstances)
+			uSize firstInstance = Instances.boxes;
+			for (uSize level = 0; level < sphere_lods.size(); ++level)
 			{
-				ThreeDimensional.Program.SetUniform("model", instance);
-				glDrawArrays(GL_TRIANGLES, start, ThreeDimensional.sphereVertices);
+				if (Instances.sphere_counts[level] != 0)
+				{
+					const IndexedMesh& sphere = ThreeDimensional.spheres[level];
+					Renderer.RasterizerMemory->selectInstances(ThreeDimensional.inputLayoutHandle, firstInstance);
+					Renderer.RasterizerMemory->drawIndexed(ThreeDimensional.inputLayoutHandle, GL_TRIANGLES, sphere.firstIndex, sphere.indices, sphere.baseVertex, Instances.sphere_counts[level]);
+				}
+				firstInstance += Instances.sphere_counts[level];
 			}
-			start += ThreeDimensional.sphereVertices;
+			OpenGL::CheckError();
+
+			ThreeDimensional.Program.MakeActive();
+			ThreeDimensional.Program.SetUniform(ThreeDimensional.projectionView, projectionView);
 
 			if (Debug3D)
 			{
-				ThreeDimensional.Program.SetUniform("model", math::identity4);
-				glDrawArrays(GL_LINES, start, ThreeDimensional.axesVertices);
+				ThreeDimensional.Program.SetUniform(ThreeDimensional.model, math::identity4);
+				glDrawArrays(GL_LINES, ThreeDimensional.axesStart, ThreeDimensional.axesVertices);
 			}
 
-			//draw lines in world space
-			Visual::InputLayout layout{ {3, 3} };
-			auto linesVertexData = Visual::GenerateLines(layout, lines);
-			ThreeDimensional.linesBufferHandle = Renderer.RasterizerMemory->createInputBuffer(ThreeDimensional.linesLayoutHandle, linesVertexData.data);
-			ThreeDimensional.Program.SetUniform("model", math::identity4);
-			glDrawArrays(GL_LINES, 0, (GLsizei)linesVertexData.size);
+			//draw lines in world space, interpolated straight into the stream buffer
+			if (!snapshot.lines.empty())
+			{
+				GLint firstVertex = 0;
+				LineVertex* vertices = static_cast<LineVertex*>(Renderer.RasterizerMemory->mapStream(ThreeDimensional.linesLayoutHandle, snapshot.lines.size(), firstVertex));
+				for (render_line_point const& point : snapshot.lines)
+				{
+					*vertices++ = { get_line_point(point, alpha), math::white };
+				}
+				Renderer.RasterizerMemory->unmapStream(ThreeDimensional.linesLayoutHandle);
+
+				glBindVertexArray(static_cast<GLuint>(ThreeDimensional.linesLayoutHandle));
+				ThreeDimensional.Program.SetUniform(ThreeDimensional.model, math::identity4);
+				glDrawArrays(GL_LINES, firstVertex, (GLsizei)snapshot.lines.size());
+			}
 		}
 
 
 		{
+			const math::matrix33_f32 view = math::scale_matrix2(0.1f) * math::matrix33_f32(camera.get_orthogonal_transform());
 
-			TwoDimensional.Program.MakeActive();
 			glBindVertexArray(static_cast<GLuint>(TwoDimensional.inputLayoutHandle));
-			TwoDimensional.Program.SetUniform("view", math::scale_matrix2(0.1f) * math::matrix33_f32(camera.get_orthogonal_transform()));
+			Renderer.RasterizerMemory->updateInstanceBuffer(TwoDimensional.inputLayoutHandle, Instances.flats.data(), Instances.flats.size() * sizeof(math::matrix33_f32));
+
+			TwoDimensional.InstancedProgram.MakeActive();
+			TwoDimensional.InstancedProgram.SetUniform(TwoDimensional.instancedView, view);
 
-			GLsizei start = 0;
-			for (auto& instance : squareInstances)
+			if (Instances.rectangles != 0)
 			{
-				TwoDimensional.Program.SetUniform("model", instance);
-				glDrawArrays(GL_TRIANGLES, start, TwoDimensional.squareVertices);
+				const IndexedMesh& square = TwoDimensional.square;
+				Renderer.RasterizerMemory->selectInstances(TwoDimensional.inputLayoutHandle, 0);
+				Renderer.RasterizerMemory->drawIndexed(TwoDimensional.inputLayoutHandle, GL_TRIANGLES, square.firstIndex, square.indices, square.baseVertex, Instances.rectangles);
 			}
-			OpenGL::CheckError();
-			start += TwoDimensional.squareVertices;
-			for (auto& instance : diskInstances)
+
+			if (Instances.disks != 0)
 			{
-				TwoDimensional.Program.SetUniform("model", instance);
-				glDrawArrays(GL_TRIANGLES, start, TwoDimensional.diskVertices);
+				const IndexedMesh& disk = TwoDimensional.disk;
+				Renderer.RasterizerMemory->selectInstances(TwoDimensional.inputLayoutHandle, Instances.rectangles);
+				Renderer.RasterizerMemory->drawIndexed(TwoDimensional.inputLayoutHandle, GL_TRIANGLES, disk.firstIndex, disk.indices, disk.baseVertex, Instances.disks);
 			}
-			start += TwoDimensional.diskVertices;
-
+			OpenGL::CheckError();
 
 			if (Debug2D)
 			{
-				TwoDimensional.Program.SetUniform("model", math::identity3);
-				glDrawArrays(GL_LINES, start, TwoDimensional.axesVertices);
+				TwoDimensional.Program.MakeActive();
+				TwoDimensional.Program.SetUniform(TwoDimensional.view, view);
+				TwoDimensional.Program.SetUniform(TwoDimensional.model, math::identity3);
+				glDrawArrays(GL_LINES, TwoDimensional.axesStart, TwoDimensional.axesVertices);
 			}
 		}
 
@@ -280,5 +303,7 @@ namespace jm::System
 		ImGui::ColorEdit3("BG Colour", reinterpret_cast<f32*>(&ClearColour));
 		ImGui::Checkbox("Debug 2D", &Debug2D);
 		ImGui::Checkbox("Debug 3D", &Debug3D);
+		ImGui::Checkbox("Frustum Culling", &Culling);
+		ImGui::Text("Drawn = %zu, Culled = %zu", Instances.solids.size(), Instances.culled);
 	}
 }
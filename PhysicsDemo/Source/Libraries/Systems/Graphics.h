@@ -7,7 +7,7 @@
 
 #include "Math/Camera.h"
 
-#include "Entity.h"
+#include "RenderSnapshot.h"
 
 namespace jm
 {
@@ -21,52 +21,81 @@ namespace jm::System
 {
 	class Graphics
 	{
+		//a mesh's run in its layout's index buffer, indices count from its first vertex in the vertex buffer
+		struct IndexedMesh
+		{
+			uSize firstIndex = 0;
+			uSize indices = 0;
+			GLint baseVertex = 0;
+		};
+
 		struct Data2D
 		{
-			Data2D(cstring vertexSource, cstring fragmentSource);
+			Data2D(cstring instancedVertexSource, cstring vertexSource, cstring fragmentSource);
 
-			Visual::ShaderProgram Program;
+			Visual::ShaderProgram InstancedProgram; //shapes, with their model matrices in the instance buffer
+			Visual::ShaderProgram Program; //axes and lines, with one model matrix for the draw
+			Visual::UniformHandle<math::matrix33_f32> instancedView;
+			Visual::UniformHandle<math::matrix33_f32> view;
+			Visual::UniformHandle<math::matrix33_f32> model;
 			OpenGL::InputLayoutHandle inputLayoutHandle;
 			OpenGL::InputBufferHandle inputBufferHandle;
-			GLsizei squareVertices;
-			GLsizei diskVertices;
+			OpenGL::InputBufferHandle instanceBufferHandle;
+			OpenGL::InputBufferHandle indexBufferHandle;
+			IndexedMesh square;
+			IndexedMesh disk;
+			GLint axesStart; //the axes are lines after the meshes' vertices, drawn without indices
 			GLsizei axesVertices;
 		};
 
 		struct Data3D
 		{
-			Data3D(cstring vertexSource, cstring fragmentSource);
+			Data3D(cstring instancedVertexSource, cstring vertexSource, cstring fragmentSource);
 
-			Visual::ShaderProgram Program;
+			Visual::ShaderProgram InstancedProgram; //shapes, with their model matrices in the instance buffer
+			Visual::ShaderProgram Program; //axes and lines, with one model matrix for the draw
+			Visual::UniformHandle<math::matrix44_f32> instancedProjectionView;
+			Visual::UniformHandle<math::matrix44_f32> projectionView;
+			Visual::UniformHandle<math::matrix44_f32> model;
 			OpenGL::InputLayoutHandle inputLayoutHandle;
 			OpenGL::InputBufferHandle inputBufferHandle;
-			GLsizei cubeVertices;
-			GLsizei sphereVertices;
+			OpenGL::InputBufferHandle instanceBufferHandle;
+			OpenGL::InputBufferHandle indexBufferHandle;
+			IndexedMesh cube;
+			std::array<IndexedMesh, sphere_lods.size()> spheres; //one mesh per level
+			GLint axesStart; //the axes are lines after the meshes' vertices, drawn without indices
 			GLsizei axesVertices;
 
 			OpenGL::InputLayoutHandle linesLayoutHandle;
-			OpenGL::InputBufferHandle linesBufferHandle;
+			OpenGL::InputBufferHandle linesStreamHandle; //constraint lines, rewritten every frame
 		};
 
 
 		Rendering::Context Renderer;
-		entity_registry& EntityRegistry;
 		Data2D TwoDimensional;
 		Data3D ThreeDimensional;
+		render_instances Instances; //kept between frames so building them does not allocate
+
+		//appends the mesh's vertices and indices, its indices keep counting from its own first vertex
+		//so each mesh's indices stay small enough to be stored as u16
+		static IndexedMesh AppendMesh(Visual::IndexedBuffer&& mesh, Visual::RawBuffer& vertexData, std::vector<u32>& indexData);
 
 		math::vector3_f32 ClearColour;
 		bool Debug2D = false;
 		bool Debug3D = true;
+		bool Culling = true;
 
 	public:
 
-		Graphics(Platform::Window& window, entity_registry& registry, math::vector3_f32 const& clearColour);
+		Graphics(Platform::Window& window, math::vector3_f32 const& clearColour);
 
 		~Graphics();
 
 		Platform::MessageHandler* GetMessageHandler();
 
-		void Draw(math::camera3<f32> const& camera, std::function<void()>&& imguiFrame);
+		//draws only from the snapshot, so the simulation may be ticking the registry on another thread
+		//alpha is how far the frame is between the snapshot's previous and current transforms
+		void Draw(math::camera3<f32> const& camera, render_snapshot const& snapshot, f32 alpha, std::function<void()>&& imguiFrame);
 
 		void ImGuiDebug();
 	};
@@ -0,0 +1,231 @@
+#include "Islands.h"
+#include "Components.h"
+#include "Contacts.h"
+
+#include <algorithm>
+
+namespace jm
+{
+	constexpr u32 NoBody = ~u32(0);
+
+	island_state& get_island_state(entity_registry& registry)
+	{
+		if (island_state* state = registry.ctx().find<island_state>())
+		{
+			return *state;
+		}
+		return registry.ctx().emplace<island_state>();
+	}
+
+	bool is_awake_body(entity_registry& registry, entity_id entity)
+	{
+		pinned_component const* pinned = registry.try_get<pinned_component>(entity);
+		return pinned != nullptr && !pinned->isPinned && registry.all_of<linear_body3_component>(entity) && !registry.all_of<sleeping_component>(entity);
+	}
+
+	void wake_island(entity_registry& registry, island_state& state, u32 island)
+	{
+		std::vector<entity_id>& bodies = state.sleeping_islands[island];
+		for (entity_id entity : bodies)
+		{
+			//the body may have been destroyed, or woken and put back to sleep in another island, while this one slept
+			sleeping_component const* sleeping = registry.valid(entity) ? registry.try_get<sleeping_component>(entity) : nullptr;
+			if (sleeping != nullptr && sleeping->island == island)
+			{
+				registry.remove<sleeping_component>(entity);
+				registry.get_or_emplace<sleep_timer_component>(entity).resting = 0.f;
+			}
+		}
+		bodies.clear();
+		state.free_islands.push_back(island);
+	}
+
+	void wake_body(entity_registry& registry, entity_id entity)
+	{
+		if (sleeping_component const* sleeping = registry.try_get<sleeping_component>(entity))
+		{
+			wake_island(registry, get_island_state(registry), sleeping->island);
+		}
+	}
+
+	void wake_all(entity_registry& registry)
+	{
+		island_state& state = get_island_state(registry);
+		for (u32 island = 0; island < state.sleeping_islands.size(); ++island)
+		{
+			if (!state.sleeping_islands[island].empty())
+			{
+				wake_island(registry, state, island);
+			}
+		}
+	}
+
+	bool is_moving(entity_registry& registry, entity_id entity)
+	{
+		sleep_timer_component const* timer = registry.try_get<sleep_timer_component>(entity);
+		return timer == nullptr || timer->resting == 0.f;
+	}
+
+	void record_contacts(entity_registry& registry, std::vector<contact_manifold> const& manifolds)
+	{
+		island_state& state = get_island_state(registry);
+		state.contacts.clear();
+		for (contact_manifold const& manifold : manifolds)
+		{
+			const bool awakeA = is_awake_body(registry, manifold.a);
+			const bool awakeB = is_awake_body(registry, manifold.b);
+			if (!awakeA && !awakeB)
+			{
+				continue;
+			}
+			state.contacts.push_back({ manifold.a, manifold.b });
+
+			//something resting against a sleeping body leaves it asleep, only a moving body wakes it
+			if (awakeA && is_moving(registry, manifold.a))
+			{
+				wake_body(registry, manifold.b);
+			}
+			else if (awakeB && is_moving(registry, manifold.b))
+			{
+				wake_body(registry, manifold.a);
+			}
+		}
+	}
+
+	u32 find_island_root(std::vector<u32>& parents, u32 node)
+	{
+		while (parents[node] != node)
+		{
+			parents[node] = parents[parents[node]];
+			node = parents[node];
+		}
+		return node;
+	}
+
+	void update_islands(entity_registry& registry, f32 delta_time, math::vector3_f32 const& wind_force)
+	{
+		island_state& state = get_island_state(registry);
+		if (wind_force != state.wind)
+		{
+			wake_all(registry);
+			state.wind = wind_force;
+		}
+
+		//index the awake dynamic bodies and advance their timers
+		std::vector<entity_id> bodies;
+		std::vector<f32> resting;
+		std::vector<u32> entityBodies;
+		const f32 linearSleepSpeed2 = state.linear_sleep_speed * state.linear_sleep_speed;
+		const f32 angularSleepSpeed2 = state.angular_sleep_speed * state.angular_sleep_speed;
+		auto awake_view = registry.view<linear_body3_component, pinned_component>(entt::exclude<sleeping_component>);
+		for (auto&& [entity, linear, pinned] : awake_view.each())
+		{
+			if (pinned.isPinned)
+			{
+				continue;
+			}
+
+			rotational_body3_component const* angular = registry.try_get<rotational_body3_component>(entity);
+			const bool still = dot(linear.velocity, linear.velocity) < linearSleepSpeed2 &&
+				(angular == nullptr || dot(angular->velocity, angular->velocity) < angularSleepSpeed2);
+			sleep_timer_component& timer = registry.get_or_emplace<sleep_timer_component>(entity);
+			timer.resting = still ? timer.resting + delta_time : 0.f;
+
+			const size_t slot = static_cast<size_t>(entt::to_entity(entity));
+			if (slot >= entityBodies.size())
+			{
+				entityBodies.resize(slot + 1, NoBody);
+			}
+			entityBodies[slot] = static_cast<u32>(bodies.size());
+			bodies.push_back(entity);
+			resting.push_back(timer.resting);
+		}
+
+		auto body_index = [&](entity_id entity)
+		{
+			const size_t slot = static_cast<size_t>(entt::to_entity(entity));
+			return slot < entityBodies.size() && entityBodies[slot] != NoBody && bodies[entityBodies[slot]] == entity ? entityBodies[slot] : NoBody;
+		};
+
+		//union-find, static bodies join nothing so everything resting on the floor does not become one island
+		std::vector<u32> parents(bodies.size());
+		for (u32 idx = 0; idx < parents.size(); ++idx)
+		{
+			parents[idx] = idx;
+		}
+		auto link = [&](entity_id first, entity_id second)
+		{
+			const u32 a = body_index(first);
+			const u32 b = body_index(second);
+			if (a != NoBody && b != NoBody)
+			{
+				parents[find_island_root(parents, a)] = find_island_root(parents, b);
+			}
+			else if (a != NoBody && resting[a] == 0.f)
+			{
+				wake_body(registry, second);
+			}
+			else if (b != NoBody && resting[b] == 0.f)
+			{
+				wake_body(registry, first);
+			}
+		};
+
+		for (auto&& [entity, constraint] : registry.view<constraint_component_rigid>().each())
+		{
+			link(constraint.massA, constraint.massB);
+		}
+		for (entity_pair const& contact : state.contacts)
+		{
+			link(contact.first, contact.second);
+		}
+		state.contacts.clear();
+
+		//an island rests as long as its least rested body
+		std::vector<f32> islandResting(bodies.size(), math::infinity<f32>());
+		for (u32 idx = 0; idx < bodies.size(); ++idx)
+		{
+			f32& islandRest = islandResting[find_island_root(parents, idx)];
+			islandRest = std::min(islandRest, resting[idx]);
+		}
+
+		std::vector<u32> rootIslands(bodies.size(), NoBody);
+		state.islands = 0;
+		state.awake_bodies = 0;
+		for (u32 idx = 0; idx < bodies.size(); ++idx)
+		{
+			const u32 root = find_island_root(parents, idx);
+			state.islands += root == idx;
+			if (islandResting[root] < state.time_to_sleep)
+			{
+				++state.awake_bodies;
+				continue;
+			}
+
+			u32& island = rootIslands[root];
+			if (island == NoBody)
+			{
+				if (state.free_islands.empty())
+				{
+					island = static_cast<u32>(state.sleeping_islands.size());
+					state.sleeping_islands.emplace_back();
+				}
+				else
+				{
+					island = state.free_islands.back();
+					state.free_islands.pop_back();
+				}
+			}
+
+			const entity_id entity = bodies[idx];
+			registry.emplace<sleeping_component>(entity, island);
+			state.sleeping_islands[island].push_back(entity);
+			registry.get<linear_body3_component>(entity).velocity = {};
+			if (rotational_body3_component* angular = registry.try_get<rotational_body3_component>(entity))
+			{
+				angular->velocity = {};
+			}
+		}
+		state.sleeping_bodies = static_cast<u32>(registry.storage<sleeping_component>().size());
+	}
+}
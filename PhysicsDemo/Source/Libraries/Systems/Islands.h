@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Entity.h"
+#include "Math/MathTypes.h"
+
+namespace jm
+{
+	struct contact_manifold;
+
+	struct sleep_timer_component
+	{
+		f32 resting = 0.f; //seconds spent under the sleep speeds
+	};
+
+	//bodies joined by constraints or contacts form an island, an island sleeps once every body in it has rested long enough
+	//kept in the registry context, sleeping bodies point back into sleeping_islands through sleeping_component
+	struct island_state
+	{
+		f32 linear_sleep_speed = 0.05f;
+		f32 angular_sleep_speed = 0.1f;
+		f32 time_to_sleep = 0.5f;
+
+		math::vector3_f32 wind{}; //last tick's wind, any change wakes everything
+		std::vector<entity_pair> contacts; //touching pairs from the last resolve_collisions, at least one of them awake
+
+		std::vector<std::vector<entity_id>> sleeping_islands;
+		std::vector<u32> free_islands; //empty slots in sleeping_islands
+
+		u32 awake_bodies = 0; //counts from the last update_islands
+		u32 sleeping_bodies = 0;
+		u32 islands = 0; //islands the awake bodies formed, including those that just fell asleep
+	};
+
+	island_state& get_island_state(entity_registry& registry);
+
+	//dynamic means integrated, a linear body that is not pinned
+	bool is_awake_body(entity_registry& registry, entity_id entity);
+
+	//union find root with path halving, parents[node] == node for a root
+	u32 find_island_root(std::vector<u32>& parents, u32 node);
+
+	void wake_island(entity_registry& registry, island_state& state, u32 island);
+	void wake_body(entity_registry& registry, entity_id entity); //wakes the island the body sleeps in
+	void wake_all(entity_registry& registry);
+
+	//keeps the touching pairs for update_islands and wakes sleeping bodies hit by a moving one, call before solving the contacts
+	void record_contacts(entity_registry& registry, std::vector<contact_manifold> const& manifolds);
+
+	//builds islands from constraints and recorded contacts, advances the sleep timers and puts rested islands to sleep
+	void update_islands(entity_registry& registry, f32 delta_time, math::vector3_f32 const& wind_force);
+}
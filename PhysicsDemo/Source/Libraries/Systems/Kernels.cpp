@@ -0,0 +1,576 @@
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define JM_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define JM_SIMD_X86 0
+#endif
+
+//gcc and clang only emit wider instructions in functions marked for them, msvc emits any intrinsic anywhere
+//fma is left out on purpose, contracting a multiply and add would round differently from the scalar kernel
+#if JM_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define JM_TARGET_SSE4 __attribute__((target("sse4.1")))
+#define JM_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JM_TARGET_SSE4
+#define JM_TARGET_AVX2
+#endif
+
+//the kernels are written once over a lane type and forced inline into each marked entry point, which lets the lane functions inline there
+//gcc warns that unmarked kernel templates return wide vectors with another abi, but they never exist as calls of their own
+//the pragma does not silence gcc's note on wide vectors passed by value, so kernels take lane vectors by reference
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+namespace jm
+{
+	template <typename Batch>
+	void mark_batch_dirty(entity_registry& registry, entity_id)
+	{
+		registry.ctx().get<Batch>().dirty = true;
+	}
+
+	//the batch is rebuilt when any of the components it views comes, goes or is replaced
+	template <typename Batch, typename... Components>
+	Batch& get_batch(entity_registry& registry)
+	{
+		if (Batch* batch = registry.ctx().find<Batch>())
+		{
+			return *batch;
+		}
+
+		Batch& batch = registry.ctx().emplace<Batch>();
+		(registry.on_construct<Components>().template connect<&mark_batch_dirty<Batch>>(), ...);
+		(registry.on_update<Components>().template connect<&mark_batch_dirty<Batch>>(), ...);
+		(registry.on_destroy<Components>().template connect<&mark_batch_dirty<Batch>>(), ...);
+		return batch;
+	}
+
+	void linear_batch::reset(uSize maxBodies)
+	{
+		const uSize padded = (maxBodies + lanes - 1) / lanes * lanes;
+		if (padded > spatials.size())
+		{
+			spatials.resize(padded, nullptr);
+			bodies.resize(padded, nullptr);
+			for (std::vector<f32>* values : { &position_x, &position_y, &position_z, &velocity_x, &velocity_y, &velocity_z, &force_x, &force_y, &force_z, &inverse_mass, &reach_x, &reach_y, &reach_z })
+			{
+				values->resize(padded, 0.f);
+			}
+		}
+		box_extents.clear();
+		count = 0;
+		box_begin = 0;
+	}
+
+	void linear_batch::push_back(spatial3_component& spatial, linear_body3_component& body, f32 sphereRadius)
+	{
+		spatials[count] = &spatial;
+		bodies[count] = &body;
+		inverse_mass[count] = body.inverse_mass;
+		reach_x[count] = sphereRadius;
+		reach_y[count] = sphereRadius;
+		reach_z[count] = sphereRadius;
+		++count;
+		box_begin = count;
+	}
+
+	void linear_batch::push_back(spatial3_component& spatial, linear_body3_component& body, math::vector3_f32 const& boxExtents)
+	{
+		spatials[count] = &spatial;
+		bodies[count] = &body;
+		inverse_mass[count] = body.inverse_mass;
+		box_extents.push_back(boxExtents);
+		++count;
+	}
+
+	linear_batch& get_linear_batch(entity_registry& registry)
+	{
+		return get_batch<linear_batch, spatial3_component, linear_body3_component, pinned_component, sphere_shape_component, box_shape_component, sleeping_component, constraint_particle_component>(registry);
+	}
+
+	void gather_linear_batch(linear_batch& batch)
+	{
+		for (u32 idx = 0; idx < batch.count; ++idx)
+		{
+			spatial3_component const& spatial = *batch.spatials[idx];
+			linear_body3_component const& body = *batch.bodies[idx];
+			batch.position_x[idx] = spatial.position.x;
+			batch.position_y[idx] = spatial.position.y;
+			batch.position_z[idx] = spatial.position.z;
+			batch.velocity_x[idx] = body.velocity.x;
+			batch.velocity_y[idx] = body.velocity.y;
+			batch.velocity_z[idx] = body.velocity.z;
+			batch.force_x[idx] = body.applied_force.x;
+			batch.force_y[idx] = body.applied_force.y;
+			batch.force_z[idx] = body.applied_force.z;
+		}
+
+		//half the width of the box's world AABB, so a box lying flat rests on the floor instead of on its bounding sphere
+		for (u32 idx = batch.box_begin; idx < batch.count; ++idx)
+		{
+			const math::matrix33_f32 axes = math::quat_to_mat(batch.spatials[idx]->orientation);
+			const math::vector3_f32 reach = glm::abs(axes[0]) * batch.box_extents[idx - batch.box_begin].x +
+				glm::abs(axes[1]) * batch.box_extents[idx - batch.box_begin].y + glm::abs(axes[2]) * batch.box_extents[idx - batch.box_begin].z;
+			batch.reach_x[idx] = reach.x;
+			batch.reach_y[idx] = reach.y;
+			batch.reach_z[idx] = reach.z;
+		}
+	}
+
+	void scatter_linear_batch(linear_batch const& batch)
+	{
+		for (u32 idx = 0; idx < batch.count; ++idx)
+		{
+			batch.spatials[idx]->position = { batch.position_x[idx], batch.position_y[idx], batch.position_z[idx] };
+			batch.bodies[idx]->velocity = { batch.velocity_x[idx], batch.velocity_y[idx], batch.velocity_z[idx] };
+		}
+	}
+
+	void angular_batch::reset(uSize maxBodies)
+	{
+		const uSize padded = (maxBodies + lanes - 1) / lanes * lanes;
+		if (padded > spatials.size())
+		{
+			spatials.resize(padded, nullptr);
+			bodies.resize(padded, nullptr);
+			orientation_w.resize(padded, 1.f); //padding lanes are renormalised too, keep them away from zero
+			for (std::vector<f32>* values : { &orientation_x, &orientation_y, &orientation_z, &velocity_x, &velocity_y, &velocity_z, &torque_x, &torque_y, &torque_z, &inverse_inertia_x, &inverse_inertia_y, &inverse_inertia_z })
+			{
+				values->resize(padded, 0.f);
+			}
+		}
+		count = 0;
+	}
+
+	void angular_batch::push_back(spatial3_component& spatial, rotational_body3_component& body)
+	{
+		spatials[count] = &spatial;
+		bodies[count] = &body;
+		inverse_inertia_x[count] = body.inverse_inertia.x;
+		inverse_inertia_y[count] = body.inverse_inertia.y;
+		inverse_inertia_z[count] = body.inverse_inertia.z;
+		++count;
+	}
+
+	angular_batch& get_angular_batch(entity_registry& registry)
+	{
+		return get_batch<angular_batch, spatial3_component, rotational_body3_component, pinned_component, sleeping_component>(registry);
+	}
+
+	void gather_angular_batch(angular_batch& batch)
+	{
+		for (u32 idx = 0; idx < batch.count; ++idx)
+		{
+			spatial3_component const& spatial = *batch.spatials[idx];
+			rotational_body3_component const& body = *batch.bodies[idx];
+			batch.orientation_w[idx] = spatial.orientation.w;
+			batch.orientation_x[idx] = spatial.orientation.x;
+			batch.orientation_y[idx] = spatial.orientation.y;
+			batch.orientation_z[idx] = spatial.orientation.z;
+			batch.velocity_x[idx] = body.velocity.x;
+			batch.velocity_y[idx] = body.velocity.y;
+			batch.velocity_z[idx] = body.velocity.z;
+			batch.torque_x[idx] = body.applied_torque.x;
+			batch.torque_y[idx] = body.applied_torque.y;
+			batch.torque_z[idx] = body.applied_torque.z;
+		}
+	}
+
+	void scatter_angular_batch(angular_batch const& batch)
+	{
+		for (u32 idx = 0; idx < batch.count; ++idx)
+		{
+			batch.spatials[idx]->orientation = math::quaternion_f32{ batch.orientation_w[idx], batch.orientation_x[idx], batch.orientation_y[idx], batch.orientation_z[idx] };
+			batch.bodies[idx]->velocity = { batch.velocity_x[idx], batch.velocity_y[idx], batch.velocity_z[idx] };
+		}
+	}
+
+	void cull_batch::reset(uSize maxSpheres)
+	{
+		const uSize padded = (maxSpheres + lanes - 1) / lanes * lanes;
+		if (padded > radius.size())
+		{
+			for (std::vector<f32>* values : { &centre_x, &centre_y, &centre_z, &radius })
+			{
+				values->resize(padded, 0.f);
+			}
+			visible.resize(padded, 0);
+		}
+		count = 0;
+	}
+
+	void cull_batch::push_back(math::vector3_f32 const& centre, f32 sphereRadius)
+	{
+		centre_x[count] = centre.x;
+		centre_y[count] = centre.y;
+		centre_z[count] = centre.z;
+		radius[count] = sphereRadius;
+		++count;
+	}
+
+	//one float per lane, the reference every wider lane type has to match
+	struct scalar_lanes
+	{
+		using type = f32;
+		using mask = bool;
+		static constexpr u32 width = 1;
+
+		static type load(f32 const* values) { return *values; }
+		static void store(f32* values, type value) { *values = value; }
+		static type set(f32 value) { return value; }
+		static type add(type a, type b) { return a + b; }
+		static type sub(type a, type b) { return a - b; }
+		static type mul(type a, type b) { return a * b; }
+		static type min(type a, type b) { return a < b ? a : b; } //picks like minps and maxps, so min(0, v) keeps a zero of either sign in v as std::min(v, 0.f) does
+		static type max(type a, type b) { return a > b ? a : b; }
+		static mask less(type a, type b) { return a < b; }
+		static mask greater(type a, type b) { return a > b; }
+		static type select(mask condition, type ifTrue, type ifFalse) { return condition ? ifTrue : ifFalse; }
+		static u32 bits(mask condition) { return condition ? 1u : 0u; } //one bit per lane, the first lane lowest
+		static type rsqrt(type value) { return 1.f / std::sqrt(value); }
+	};
+
+#if JM_SIMD_X86
+	struct sse4_lanes
+	{
+		using type = __m128;
+		using mask = __m128;
+		static constexpr u32 width = 4;
+
+		JM_TARGET_SSE4 static type load(f32 const* values) { return _mm_loadu_ps(values); }
+		JM_TARGET_SSE4 static void store(f32* values, type value) { _mm_storeu_ps(values, value); }
+		JM_TARGET_SSE4 static type set(f32 value) { return _mm_set1_ps(value); }
+		JM_TARGET_SSE4 static type add(type a, type b) { return _mm_add_ps(a, b); }
+		JM_TARGET_SSE4 static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+		JM_TARGET_SSE4 static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+		JM_TARGET_SSE4 static type min(type a, type b) { return _mm_min_ps(a, b); }
+		JM_TARGET_SSE4 static type max(type a, type b) { return _mm_max_ps(a, b); }
+		JM_TARGET_SSE4 static mask less(type a, type b) { return _mm_cmplt_ps(a, b); }
+		JM_TARGET_SSE4 static mask greater(type a, type b) { return _mm_cmpgt_ps(a, b); }
+		JM_TARGET_SSE4 static type select(mask condition, type ifTrue, type ifFalse) { return _mm_blendv_ps(ifFalse, ifTrue, condition); }
+		JM_TARGET_SSE4 static u32 bits(mask condition) { return (u32)_mm_movemask_ps(condition); }
+
+		//12 bit estimate and one newton step, close to full precision for a fraction of a divide and a square root
+		JM_TARGET_SSE4 static type rsqrt(type value)
+		{
+			const type estimate = _mm_rsqrt_ps(value);
+			const type halfValue = _mm_mul_ps(_mm_set1_ps(0.5f), value);
+			return _mm_mul_ps(estimate, _mm_sub_ps(_mm_set1_ps(1.5f), _mm_mul_ps(halfValue, _mm_mul_ps(estimate, estimate))));
+		}
+	};
+
+	struct avx2_lanes
+	{
+		using type = __m256;
+		using mask = __m256;
+		static constexpr u32 width = 8;
+
+		JM_TARGET_AVX2 static type load(f32 const* values) { return _mm256_loadu_ps(values); }
+		JM_TARGET_AVX2 static void store(f32* values, type value) { _mm256_storeu_ps(values, value); }
+		JM_TARGET_AVX2 static type set(f32 value) { return _mm256_set1_ps(value); }
+		JM_TARGET_AVX2 static type add(type a, type b) { return _mm256_add_ps(a, b); }
+		JM_TARGET_AVX2 static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+		JM_TARGET_AVX2 static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+		JM_TARGET_AVX2 static type min(type a, type b) { return _mm256_min_ps(a, b); }
+		JM_TARGET_AVX2 static type max(type a, type b) { return _mm256_max_ps(a, b); }
+		JM_TARGET_AVX2 static mask less(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+		JM_TARGET_AVX2 static mask greater(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+		JM_TARGET_AVX2 static type select(mask condition, type ifTrue, type ifFalse) { return _mm256_blendv_ps(ifFalse, ifTrue, condition); }
+		JM_TARGET_AVX2 static u32 bits(mask condition) { return (u32)_mm256_movemask_ps(condition); }
+
+		JM_TARGET_AVX2 static type rsqrt(type value)
+		{
+			const type estimate = _mm256_rsqrt_ps(value);
+			const type halfValue = _mm256_mul_ps(_mm256_set1_ps(0.5f), value);
+			return _mm256_mul_ps(estimate, _mm256_sub_ps(_mm256_set1_ps(1.5f), _mm256_mul_ps(halfValue, _mm256_mul_ps(estimate, estimate))));
+		}
+	};
+#endif
+
+	//lets the math:: integrators step lanes the way they step glm vectors
+	template <typename L>
+	struct lane_value
+	{
+		typename L::type lanes;
+
+		friend JM_FORCE_INLINE lane_value operator+(lane_value const& a, lane_value const& b) { return { L::add(a.lanes, b.lanes) }; }
+		friend JM_FORCE_INLINE lane_value operator-(lane_value const& a, lane_value const& b) { return { L::sub(a.lanes, b.lanes) }; }
+		friend JM_FORCE_INLINE lane_value operator*(lane_value const& a, f32 b) { return { L::mul(a.lanes, L::set(b)) }; }
+	};
+
+	//applied forces and gravity are constant over a step, only the damping depends on the velocity
+	template <typename L>
+	struct linear_acceleration
+	{
+		lane_value<L> applied;
+		f32 damping;
+
+		JM_FORCE_INLINE lane_value<L> operator()(lane_value<L> const&, lane_value<L> const& velocity) const
+		{
+			return applied - velocity * damping;
+		}
+	};
+
+	//one axis of a lane group
+	template <typename L, typename Integrator>
+	JM_FORCE_INLINE void integrate_linear_axis(f32* position, f32* velocity, f32 const* force, typename L::type const& inverseMass, typename L::type const& reach, f32 acceleration, f32 wallMin, f32 wallMax, linear_step const& step)
+	{
+		using lane = typename L::type;
+		using value = lane_value<L>;
+		const lane zero = L::set(0.f);
+
+		value p{ L::load(position) };
+		value v{ L::load(velocity) };
+		const linear_acceleration<L> pushed{ { L::add(L::set(acceleration), L::mul(L::load(force), inverseMass)) }, step.damping };
+		Integrator::step(p, v, step.delta_time, pushed);
+
+		//walls stop motion into them, otherwise resting bodies build up speed that contacts then pass on
+		//the low wall is applied last so it wins where both hold, like the if ahead of the else it replaces
+		const lane low = L::add(L::set(wallMin), reach);
+		const lane high = L::sub(L::set(wallMax), reach);
+		const typename L::mask below = L::less(p.lanes, low);
+		const typename L::mask above = L::greater(p.lanes, high);
+		p.lanes = L::select(above, high, p.lanes);
+		v.lanes = L::select(above, L::min(zero, v.lanes), v.lanes);
+		p.lanes = L::select(below, low, p.lanes);
+		v.lanes = L::select(below, L::max(zero, v.lanes), v.lanes);
+
+		L::store(position, p.lanes);
+		L::store(velocity, v.lanes);
+	}
+
+	template <typename L, typename Integrator>
+	JM_FORCE_INLINE void integrate_linear_lanes(linear_batch& batch, linear_step const& step)
+	{
+		for (uSize idx = 0; idx < batch.count; idx += L::width)
+		{
+			const typename L::type inverseMass = L::load(&batch.inverse_mass[idx]);
+			integrate_linear_axis<L, Integrator>(&batch.position_x[idx], &batch.velocity_x[idx], &batch.force_x[idx], inverseMass, L::load(&batch.reach_x[idx]), step.acceleration.x, step.wall_min.x, step.wall_max.x, step);
+			integrate_linear_axis<L, Integrator>(&batch.position_y[idx], &batch.velocity_y[idx], &batch.force_y[idx], inverseMass, L::load(&batch.reach_y[idx]), step.acceleration.y, step.wall_min.y, step.wall_max.y, step);
+			integrate_linear_axis<L, Integrator>(&batch.position_z[idx], &batch.velocity_z[idx], &batch.force_z[idx], inverseMass, L::load(&batch.reach_z[idx]), step.acceleration.z, step.wall_min.z, step.wall_max.z, step);
+		}
+	}
+
+	//the world inverse inertia R * diag(I^-1) * R^T is applied as R * (I^-1 * (R^T * torque)), with R built from the quaternion
+	template <typename L>
+	JM_FORCE_INLINE void integrate_angular_lanes(angular_batch& batch, angular_step const& step)
+	{
+		using lane = typename L::type;
+		const lane one = L::set(1.f);
+		const lane two = L::set(2.f);
+		const lane deltaTime = L::set(step.delta_time);
+		const lane halfDeltaTime = L::set(0.5f * step.delta_time);
+		const lane damping = L::set(step.damping);
+
+		for (uSize idx = 0; idx < batch.count; idx += L::width)
+		{
+			lane qw = L::load(&batch.orientation_w[idx]);
+			lane qx = L::load(&batch.orientation_x[idx]);
+			lane qy = L::load(&batch.orientation_y[idx]);
+			lane qz = L::load(&batch.orientation_z[idx]);
+
+			const lane xx = L::mul(qx, qx), yy = L::mul(qy, qy), zz = L::mul(qz, qz);
+			const lane xy = L::mul(qx, qy), xz = L::mul(qx, qz), yz = L::mul(qy, qz);
+			const lane wx = L::mul(qw, qx), wy = L::mul(qw, qy), wz = L::mul(qw, qz);
+			const lane r00 = L::sub(one, L::mul(two, L::add(yy, zz)));
+			const lane r01 = L::mul(two, L::sub(xy, wz));
+			const lane r02 = L::mul(two, L::add(xz, wy));
+			const lane r10 = L::mul(two, L::add(xy, wz));
+			const lane r11 = L::sub(one, L::mul(two, L::add(xx, zz)));
+			const lane r12 = L::mul(two, L::sub(yz, wx));
+			const lane r20 = L::mul(two, L::sub(xz, wy));
+			const lane r21 = L::mul(two, L::add(yz, wx));
+			const lane r22 = L::sub(one, L::mul(two, L::add(xx, yy)));
+
+			const lane tx = L::load(&batch.torque_x[idx]);
+			const lane ty = L::load(&batch.torque_y[idx]);
+			const lane tz = L::load(&batch.torque_z[idx]);
+			const lane bx = L::mul(L::load(&batch.inverse_inertia_x[idx]), L::add(L::add(L::mul(r00, tx), L::mul(r10, ty)), L::mul(r20, tz)));
+			const lane by = L::mul(L::load(&batch.inverse_inertia_y[idx]), L::add(L::add(L::mul(r01, tx), L::mul(r11, ty)), L::mul(r21, tz)));
+			const lane bz = L::mul(L::load(&batch.inverse_inertia_z[idx]), L::add(L::add(L::mul(r02, tx), L::mul(r12, ty)), L::mul(r22, tz)));
+			const lane ax = L::add(L::add(L::mul(r00, bx), L::mul(r01, by)), L::mul(r02, bz));
+			const lane ay = L::add(L::add(L::mul(r10, bx), L::mul(r11, by)), L::mul(r12, bz));
+			const lane az = L::add(L::add(L::mul(r20, bx), L::mul(r21, by)), L::mul(r22, bz));
+
+			const lane vx = L::mul(L::add(L::load(&batch.velocity_x[idx]), L::mul(deltaTime, ax)), damping);
+			const lane vy = L::mul(L::add(L::load(&batch.velocity_y[idx]), L::mul(deltaTime, ay)), damping);
+			const lane vz = L::mul(L::add(L::load(&batch.velocity_z[idx]), L::mul(deltaTime, az)), damping);
+			L::store(&batch.velocity_x[idx], vx);
+			L::store(&batch.velocity_y[idx], vy);
+			L::store(&batch.velocity_z[idx], vz);
+
+			//q += dt * 0.5 * q * (0, w)
+			const lane sw = L::sub(L::sub(L::sub(L::set(0.f), L::mul(qx, vx)), L::mul(qy, vy)), L::mul(qz, vz));
+			const lane sx = L::add(L::mul(qw, vx), L::sub(L::mul(qy, vz), L::mul(qz, vy)));
+			const lane sy = L::add(L::mul(qw, vy), L::sub(L::mul(qz, vx), L::mul(qx, vz)));
+			const lane sz = L::add(L::mul(qw, vz), L::sub(L::mul(qx, vy), L::mul(qy, vx)));
+			qw = L::add(qw, L::mul(halfDeltaTime, sw));
+			qx = L::add(qx, L::mul(halfDeltaTime, sx));
+			qy = L::add(qy, L::mul(halfDeltaTime, sy));
+			qz = L::add(qz, L::mul(halfDeltaTime, sz));
+
+			const lane inverseLength = L::rsqrt(L::add(L::add(L::mul(qw, qw), L::mul(qx, qx)), L::add(L::mul(qy, qy), L::mul(qz, qz))));
+			L::store(&batch.orientation_w[idx], L::mul(qw, inverseLength));
+			L::store(&batch.orientation_x[idx], L::mul(qx, inverseLength));
+			L::store(&batch.orientation_y[idx], L::mul(qy, inverseLength));
+			L::store(&batch.orientation_z[idx], L::mul(qz, inverseLength));
+		}
+	}
+
+	//the signed distance past each plane, kept as its smallest over the planes, adds up in the order the scalar test does
+	template <typename L>
+	JM_FORCE_INLINE uSize cull_spheres_lanes(cull_batch& batch, math::frustum3<f32> const& frustum)
+	{
+		using lane = typename L::type;
+		lane planes[6][4]; //normal x, y, z and offset of each plane in every lane
+		for (uSize p = 0; p < 6; ++p)
+		{
+			math::plane3<f32> const& plane = frustum.planes[p];
+			planes[p][0] = L::set(plane.normal.x);
+			planes[p][1] = L::set(plane.normal.y);
+			planes[p][2] = L::set(plane.normal.z);
+			planes[p][3] = L::set(plane.offset);
+		}
+		const lane zero = L::set(0.f);
+
+		uSize inside = 0;
+		for (uSize idx = 0; idx < batch.count; idx += L::width)
+		{
+			const lane x = L::load(&batch.centre_x[idx]);
+			const lane y = L::load(&batch.centre_y[idx]);
+			const lane z = L::load(&batch.centre_z[idx]);
+			const lane radius = L::load(&batch.radius[idx]);
+
+			lane nearest = L::set(std::numeric_limits<f32>::max());
+			for (lane const (&plane)[4] : planes)
+			{
+				const lane distance = L::add(L::add(L::add(L::add(L::mul(plane[0], x), L::mul(plane[1], y)), L::mul(plane[2], z)), plane[3]), radius);
+				nearest = L::min(nearest, distance);
+			}
+
+			const u32 outside = L::bits(L::less(nearest, zero));
+			for (u32 l = 0; l < L::width; ++l)
+			{
+				const u8 visible = ((outside >> l) & 1u) == 0;
+				batch.visible[idx + l] = visible;
+				inside += idx + l < batch.count ? visible : 0;
+			}
+		}
+		return inside;
+	}
+
+	template <typename Integrator>
+	void integrate_linear_scalar(linear_batch& batch, linear_step const& step)
+	{
+		integrate_linear_lanes<scalar_lanes, Integrator>(batch, step);
+	}
+
+	void integrate_angular_scalar(angular_batch& batch, angular_step const& step)
+	{
+		integrate_angular_lanes<scalar_lanes>(batch, step);
+	}
+
+	uSize cull_spheres_scalar(cull_batch& batch, math::frustum3<f32> const& frustum)
+	{
+		return cull_spheres_lanes<scalar_lanes>(batch, frustum);
+	}
+
+#if JM_SIMD_X86
+	template <typename Integrator>
+	JM_TARGET_SSE4 void integrate_linear_sse4(linear_batch& batch, linear_step const& step)
+	{
+		integrate_linear_lanes<sse4_lanes, Integrator>(batch, step);
+	}
+
+	template <typename Integrator>
+	JM_TARGET_AVX2 void integrate_linear_avx2(linear_batch& batch, linear_step const& step)
+	{
+		integrate_linear_lanes<avx2_lanes, Integrator>(batch, step);
+	}
+
+	JM_TARGET_SSE4 void integrate_angular_sse4(angular_batch& batch, angular_step const& step)
+	{
+		integrate_angular_lanes<sse4_lanes>(batch, step);
+	}
+
+	JM_TARGET_AVX2 void integrate_angular_avx2(angular_batch& batch, angular_step const& step)
+	{
+		integrate_angular_lanes<avx2_lanes>(batch, step);
+	}
+
+	JM_TARGET_SSE4 uSize cull_spheres_sse4(cull_batch& batch, math::frustum3<f32> const& frustum)
+	{
+		return cull_spheres_lanes<sse4_lanes>(batch, frustum);
+	}
+
+	JM_TARGET_AVX2 uSize cull_spheres_avx2(cull_batch& batch, math::frustum3<f32> const& frustum)
+	{
+		return cull_spheres_lanes<avx2_lanes>(batch, frustum);
+	}
+#endif
+
+	template <typename Integrator>
+	void integrate_linear_batch(linear_batch& batch, linear_step const& step, Platform::SimdLevel level)
+	{
+		//never above what the cpu has, a batch asking for more gets the best there is
+		level = std::min(level, Platform::GetSupportedSimdLevel());
+#if JM_SIMD_X86
+		if (level == Platform::SimdLevel::AVX2)
+		{
+			integrate_linear_avx2<Integrator>(batch, step);
+			return;
+		}
+		if (level == Platform::SimdLevel::SSE4)
+		{
+			integrate_linear_sse4<Integrator>(batch, step);
+			return;
+		}
+#endif
+		integrate_linear_scalar<Integrator>(batch, step);
+	}
+
+	template void integrate_linear_batch<math::symplectic_euler>(linear_batch& batch, linear_step const& step, Platform::SimdLevel level);
+	template void integrate_linear_batch<math::position_verlet>(linear_batch& batch, linear_step const& step, Platform::SimdLevel level);
+	template void integrate_linear_batch<math::runge_kutta4>(linear_batch& batch, linear_step const& step, Platform::SimdLevel level);
+
+	void integrate_angular_batch(angular_batch& batch, angular_step const& step, Platform::SimdLevel level)
+	{
+		level = std::min(level, Platform::GetSupportedSimdLevel());
+#if JM_SIMD_X86
+		if (level == Platform::SimdLevel::AVX2)
+		{
+			integrate_angular_avx2(batch, step);
+			return;
+		}
+		if (level == Platform::SimdLevel::SSE4)
+		{
+			integrate_angular_sse4(batch, step);
+			return;
+		}
+#endif
+		integrate_angular_scalar(batch, step);
+	}
+
+	uSize cull_spheres(cull_batch& batch, math::frustum3<f32> const& frustum, Platform::SimdLevel level)
+	{
+		level = std::min(level, Platform::GetSupportedSimdLevel());
+#if JM_SIMD_X86
+		if (level == Platform::SimdLevel::AVX2)
+		{
+			return cull_spheres_avx2(batch, frustum);
+		}
+		if (level == Platform::SimdLevel::SSE4)
+		{
+			return cull_spheres_sse4(batch, frustum);
+		}
+#endif
+		return cull_spheres_scalar(batch, frustum);
+	}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Entity.h"
+#include "Components.h"
+
+#include "Math/Geometry.h"
+
+#include "Platform/CpuFeatures.h"
+
+namespace jm
+{
+	//structure of arrays copy of the spheres and boxes integrate_linear moves, one lane per body
+	//membership is rebuilt when one of the viewed components comes, goes or is replaced, each tick only gathers and scatters
+	//pinning or unpinning a body has to go through registry.patch or replace, writing isPinned in place leaves membership stale
+	//arrays stay padded to whole lane groups so kernels never handle a tail, lanes past count are computed and ignored
+	struct linear_batch
+	{
+		static constexpr u32 lanes = 8;
+
+		std::vector<spatial3_component*> spatials; //component storage is paged, these stay put until their entity loses one
+		std::vector<linear_body3_component*> bodies;
+
+		std::vector<f32> position_x, position_y, position_z;
+		std::vector<f32> velocity_x, velocity_y, velocity_z;
+		std::vector<f32> force_x, force_y, force_z;
+		std::vector<f32> inverse_mass; //only filled on rebuild, mass is const so it only changes with a new body component
+		std::vector<f32> reach_x, reach_y, reach_z; //how far the body extends along each world axis, what the walls stop
+		std::vector<math::vector3_f32> box_extents; //boxes come after every sphere, their reach follows their orientation on each gather
+		u32 count = 0;
+		u32 box_begin = 0; //lane of the first box
+
+		Platform::SimdLevel level = Platform::GetSupportedSimdLevel(); //lowered to compare kernels
+		bool dirty = true;
+
+		void reset(uSize maxBodies); //empties the batch and makes room, the arrays only ever grow
+		void push_back(spatial3_component& spatial, linear_body3_component& body, f32 sphereRadius); //before any box
+		void push_back(spatial3_component& spatial, linear_body3_component& body, math::vector3_f32 const& boxExtents);
+	};
+
+	linear_batch& get_linear_batch(entity_registry& registry);
+
+	void gather_linear_batch(linear_batch& batch);
+	void scatter_linear_batch(linear_batch const& batch);
+
+	//what every body in the batch shares for one step
+	struct linear_step
+	{
+		f32 delta_time;
+		f32 damping; //per second, slows bodies by damping * velocity
+		math::vector3_f32 acceleration; //gravity and wind, forces are added per body
+		math::vector3_f32 wall_min;
+		math::vector3_f32 wall_max;
+	};
+
+	//every level gives bit identical results, the operations are the same and in the same order, only the width differs
+	//instantiated for math::symplectic_euler, math::position_verlet and math::runge_kutta4
+	template <typename Integrator>
+	void integrate_linear_batch(linear_batch& batch, linear_step const& step, Platform::SimdLevel level);
+
+	//structure of arrays copy of the bodies integrate_angular spins, kept like linear_batch and pinned the same way
+	struct angular_batch
+	{
+		static constexpr u32 lanes = 8;
+
+		std::vector<spatial3_component*> spatials;
+		std::vector<rotational_body3_component*> bodies;
+
+		std::vector<f32> orientation_w, orientation_x, orientation_y, orientation_z;
+		std::vector<f32> velocity_x, velocity_y, velocity_z;
+		std::vector<f32> torque_x, torque_y, torque_z;
+		std::vector<f32> inverse_inertia_x, inverse_inertia_y, inverse_inertia_z; //body space, only filled on rebuild like inverse_mass
+		u32 count = 0;
+
+		Platform::SimdLevel level = Platform::GetSupportedSimdLevel();
+		bool dirty = true;
+
+		void reset(uSize maxBodies);
+		void push_back(spatial3_component& spatial, rotational_body3_component& body);
+	};
+
+	angular_batch& get_angular_batch(entity_registry& registry);
+
+	void gather_angular_batch(angular_batch& batch);
+	void scatter_angular_batch(angular_batch const& batch);
+
+	struct angular_step
+	{
+		f32 delta_time;
+		f32 damping; //factor the velocity is scaled by this step
+	};
+
+	//the rotation comes straight from the unit quaternion, so there is no trig and no 3x3 product per body
+	//levels agree to rounding and not to the bit, the vector kernels renormalise with the approximate reciprocal square root
+	void integrate_angular_batch(angular_batch& batch, angular_step const& step, Platform::SimdLevel level);
+
+	//bounding spheres of what is about to be drawn, padded to whole lane groups like the batches
+	struct cull_batch
+	{
+		static constexpr u32 lanes = 8;
+
+		std::vector<f32> centre_x, centre_y, centre_z;
+		std::vector<f32> radius;
+		std::vector<u8> visible; //written by cull_spheres, 1 where the sphere is at least partly inside
+		u32 count = 0;
+
+		Platform::SimdLevel level = Platform::GetSupportedSimdLevel();
+
+		void reset(uSize maxSpheres);
+		void push_back(math::vector3_f32 const& centre, f32 sphereRadius);
+	};
+
+	//a sphere is culled when it is entirely outside one plane, returns how many are not
+	//every level gives bit identical results, and the same as math::intersects(frustum, sphere)
+	uSize cull_spheres(cull_batch& batch, math::frustum3<f32> const& frustum, Platform::SimdLevel level);
+}
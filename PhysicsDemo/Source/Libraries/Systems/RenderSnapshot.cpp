@@ -0,0 +1,216 @@
+#include "RenderSnapshot.h"
+
+#include <algorithm>
+
+namespace jm
+{
+	previous_transforms& get_previous_transforms(entity_registry& registry)
+	{
+		if (previous_transforms* previous = registry.ctx().find<previous_transforms>())
+		{
+			return *previous;
+		}
+		return registry.ctx().emplace<previous_transforms>();
+	}
+
+	template <typename Shape>
+	void store_shape_transforms(entity_registry& registry, std::vector<entity_id>& entities, std::vector<spatial3_component>& transforms)
+	{
+		entities.clear();
+		transforms.clear();
+		for (auto&& [entity, shape, spatial] : registry.view<const Shape, const spatial3_component>().each())
+		{
+			entities.push_back(entity);
+			transforms.push_back(spatial);
+		}
+	}
+
+	void store_previous_transforms(entity_registry& registry)
+	{
+		previous_transforms& previous = get_previous_transforms(registry);
+		store_shape_transforms<sphere_shape_component>(registry, previous.spheres, previous.sphere_transforms);
+		store_shape_transforms<box_shape_component>(registry, previous.boxes, previous.box_transforms);
+
+		previous.links.clear();
+		previous.link_points.clear();
+		for (auto&& [entity, constraint] : registry.view<const constraint_component_rigid>().each())
+		{
+			previous.links.push_back(entity);
+			previous.link_points.push_back(registry.get<spatial3_component>(constraint.massA).position);
+			previous.link_points.push_back(registry.get<spatial3_component>(constraint.massB).position);
+		}
+	}
+
+	template <typename Shape, typename Scale>
+	void capture_shapes(entity_registry& registry, std::vector<entity_id> const& previousEntities, std::vector<spatial3_component> const& previousTransforms, std::vector<render_instance>& instances, Scale&& scale)
+	{
+		instances.clear();
+		for (auto&& [entity, shape, spatial] : registry.view<const Shape, const spatial3_component>().each())
+		{
+			const uSize index = instances.size();
+			const bool stored = index < previousEntities.size() && previousEntities[index] == entity;
+			instances.push_back({ stored ? previousTransforms[index] : spatial, spatial, scale(shape) });
+		}
+	}
+
+	void capture_render_snapshot(entity_registry& registry, render_snapshot& snapshot)
+	{
+		previous_transforms const& previous = get_previous_transforms(registry);
+		capture_shapes<sphere_shape_component>(registry, previous.spheres, previous.sphere_transforms, snapshot.spheres, [](sphere_shape_component const& shape) { return math::vector3_f32{ shape.radius }; });
+		capture_shapes<box_shape_component>(registry, previous.boxes, previous.box_transforms, snapshot.boxes, [](box_shape_component const& shape) { return shape.extents; });
+
+		snapshot.lines.clear();
+		for (auto&& [entity, constraint] : registry.view<const constraint_component_rigid>().each())
+		{
+			const uSize link = snapshot.lines.size() / 2;
+			const bool stored = link < previous.links.size() && previous.links[link] == entity;
+			const math::vector3_f32 a = registry.get<spatial3_component>(constraint.massA).position;
+			const math::vector3_f32 b = registry.get<spatial3_component>(constraint.massB).position;
+			snapshot.lines.push_back({ stored ? previous.link_points[2 * link] : a, a });
+			snapshot.lines.push_back({ stored ? previous.link_points[2 * link + 1] : b, b });
+		}
+
+		snapshot.disks.clear();
+		for (auto&& [entity, shape, spatial] : registry.view<const disk_shape_component, const spatial2_component>().each())
+		{
+			snapshot.disks.push_back(math::isometry_matrix2(spatial.position, spatial.orientation) * math::scale_matrix2(shape.radius));
+		}
+
+		snapshot.rectangles.clear();
+		for (auto&& [entity, shape, spatial] : registry.view<const rectangle_shape_component, const spatial2_component>().each())
+		{
+			snapshot.rectangles.push_back(math::isometry_matrix2(spatial.position, spatial.orientation) * math::scale_matrix2(shape.extents));
+		}
+
+		snapshot.entities = registry.storage<entity_id>().in_use();
+	}
+
+	math::matrix44_f32 get_instance_matrix(render_instance const& instance, f32 alpha)
+	{
+		const spatial3_component drawn = math::interpolate(instance.previous, instance.current, alpha);
+		return math::isometry_matrix3(drawn.position, drawn.orientation) * math::scale_matrix3(instance.scale);
+	}
+
+	math::vector3_f32 get_line_point(render_line_point const& point, f32 alpha)
+	{
+		return math::lerp(alpha, point.previous, point.current);
+	}
+
+	uSize select_sphere_lod(f32 screen_radius)
+	{
+		uSize level = sphere_lods.size() - 1;
+		while (level != 0 && screen_radius < sphere_lods[level].min_screen_radius)
+		{
+			--level;
+		}
+		return level;
+	}
+
+	render_view make_render_view(math::matrix44_f32 const& projection, math::matrix44_f32 const& view)
+	{
+		const math::matrix44_f32 projectionView = projection * view;
+		//clip space w is the last row, the vertical scale of the projection is 1 / tan(fov / 2)
+		return { math::frustum(projectionView), glm::transpose(projectionView)[3], projection[1][1] };
+	}
+
+	f32 get_screen_radius(render_view const& view, math::vector3_f32 const& centre, f32 radius)
+	{
+		//a sphere around the camera fills the screen, the small depth keeps it at the finest level
+		const f32 depth = std::max(dot(math::vector3_f32(view.depth), centre) + view.depth.w, 1e-3f);
+		return radius * view.focal_scale / depth;
+	}
+
+	void build_flat_instances(render_snapshot const& snapshot, render_instances& instances)
+	{
+		instances.flats.clear();
+		instances.flats.insert(instances.flats.end(), snapshot.rectangles.begin(), snapshot.rectangles.end());
+		instances.flats.insert(instances.flats.end(), snapshot.disks.begin(), snapshot.disks.end());
+		instances.rectangles = snapshot.rectangles.size();
+		instances.disks = snapshot.disks.size();
+	}
+
+	void build_render_instances(render_snapshot const& snapshot, f32 alpha, render_instances& instances)
+	{
+		instances.solids.clear();
+		instances.solids.reserve(snapshot.boxes.size() + snapshot.spheres.size());
+		for (render_instance const& instance : snapshot.boxes)
+		{
+			instances.solids.push_back(get_instance_matrix(instance, alpha));
+		}
+		for (render_instance const& instance : snapshot.spheres)
+		{
+			instances.solids.push_back(get_instance_matrix(instance, alpha));
+		}
+		instances.boxes = snapshot.boxes.size();
+		instances.spheres = snapshot.spheres.size();
+		instances.sphere_counts.fill(0);
+		instances.sphere_counts.back() = instances.spheres;
+		instances.culled = 0;
+
+		build_flat_instances(snapshot, instances);
+	}
+
+	void build_render_instances(render_snapshot const& snapshot, f32 alpha, render_view const& view, render_instances& instances)
+	{
+		//boxes are bounded by the sphere through their corners
+		cull_batch& bounds = instances.bounds;
+		bounds.reset(snapshot.boxes.size() + snapshot.spheres.size());
+		for (render_instance const& instance : snapshot.boxes)
+		{
+			bounds.push_back(math::lerp(alpha, instance.previous.position, instance.current.position), length(instance.scale));
+		}
+		for (render_instance const& instance : snapshot.spheres)
+		{
+			bounds.push_back(math::lerp(alpha, instance.previous.position, instance.current.position), instance.scale.x);
+		}
+		const uSize inside = cull_spheres(bounds, view.frustum, bounds.level);
+
+		instances.solids.clear();
+		instances.solids.reserve(inside);
+		uSize index = 0;
+		for (render_instance const& instance : snapshot.boxes)
+		{
+			if (bounds.visible[index++])
+			{
+				instances.solids.push_back(get_instance_matrix(instance, alpha));
+			}
+		}
+		instances.boxes = instances.solids.size();
+
+		//spheres are bucketed by level with a counting sort, levels first and then each matrix straight into its bucket
+		const uSize firstSphere = index;
+		instances.levels.clear();
+		instances.sphere_counts.fill(0);
+		for (; index < bounds.count; ++index)
+		{
+			if (bounds.visible[index])
+			{
+				const math::vector3_f32 centre = { bounds.centre_x[index], bounds.centre_y[index], bounds.centre_z[index] };
+				const uSize level = select_sphere_lod(get_screen_radius(view, centre, bounds.radius[index]));
+				instances.levels.push_back((u8)level);
+				++instances.sphere_counts[level];
+			}
+		}
+		instances.spheres = instances.levels.size();
+
+		std::array<uSize, sphere_lods.size()> next;
+		uSize start = instances.boxes;
+		for (uSize level = 0; level < next.size(); ++level)
+		{
+			next[level] = start;
+			start += instances.sphere_counts[level];
+		}
+		instances.solids.resize(instances.boxes + instances.spheres);
+		uSize drawn = 0;
+		for (uSize sphere = 0; sphere < snapshot.spheres.size(); ++sphere)
+		{
+			if (bounds.visible[firstSphere + sphere])
+			{
+				instances.solids[next[instances.levels[drawn++]]++] = get_instance_matrix(snapshot.spheres[sphere], alpha);
+			}
+		}
+		instances.culled = bounds.count - inside;
+
+		build_flat_instances(snapshot, instances);
+	}
+}
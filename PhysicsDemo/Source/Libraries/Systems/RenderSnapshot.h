@@ -0,0 +1,111 @@
+#pragma once
+
+#include "Entity.h"
+#include "Components.h"
+#include "Kernels.h"
+
+#include <array>
+
+namespace jm
+{
+	struct render_instance
+	{
+		spatial3_component previous; //before the last tick, the same as current for bodies without a stored transform
+		spatial3_component current;
+		math::vector3_f32 scale; //the radius on every axis for spheres, the extents for boxes
+	};
+
+	struct render_line_point
+	{
+		math::vector3_f32 previous;
+		math::vector3_f32 current;
+	};
+
+	//the transforms before the last tick, kept in the registry context
+	//dense and in the order capture_render_snapshot walks spheres, boxes and links, so capturing pairs them up by index
+	//an entry whose entity no longer matches (created, destroyed or moved in its pool since) is drawn at its current transform
+	struct previous_transforms
+	{
+		std::vector<entity_id> spheres;
+		std::vector<spatial3_component> sphere_transforms;
+		std::vector<entity_id> boxes;
+		std::vector<spatial3_component> box_transforms;
+		std::vector<entity_id> links;
+		std::vector<math::vector3_f32> link_points; //two per link, like render_snapshot::lines
+	};
+
+	//call before a tick's collisions so frames can be drawn between ticks
+	void store_previous_transforms(entity_registry& registry);
+
+	//everything a frame draws, copied out of the registry after a tick so drawing never reads the registry
+	//vectors are cleared and refilled, so a snapshot reused every tick stops allocating once it has grown
+	struct render_snapshot
+	{
+		std::vector<render_instance> spheres;
+		std::vector<render_instance> boxes;
+		std::vector<render_line_point> lines; //constraint links as pairs of points
+		std::vector<math::matrix33_f32> disks; //2d bodies are drawn as they are, without interpolation
+		std::vector<math::matrix33_f32> rectangles;
+		uSize entities = 0;
+	};
+
+	//sphere meshes from the coarsest to the finest, each drawn for spheres covering at least min_screen_radius
+	//the radius is a fraction of half the screen height, so 0.01 is about 5 pixels on a 1080 line screen
+	struct sphere_lod
+	{
+		u32 slices;
+		u32 layers;
+		f32 min_screen_radius;
+	};
+
+	inline constexpr std::array<sphere_lod, 5> sphere_lods = { {
+		{ 6, 4, 0.f },
+		{ 10, 7, 0.01f },
+		{ 16, 12, 0.03f },
+		{ 24, 18, 0.08f },
+		{ 32, 24, 0.25f },
+	} };
+
+	//the finest level whose min_screen_radius the radius reaches
+	uSize select_sphere_lod(f32 screen_radius);
+
+	//what building instances needs of the camera
+	struct render_view
+	{
+		math::frustum3<f32> frustum; //planes left default have no normal and keep everything
+		math::vector4_f32 depth; //dotted with a point and 1, its distance in front of the camera
+		f32 focal_scale; //a sphere's screen radius is its radius times this over its depth
+	};
+
+	render_view make_render_view(math::matrix44_f32 const& projection, math::matrix44_f32 const& view);
+	f32 get_screen_radius(render_view const& view, math::vector3_f32 const& centre, f32 radius);
+
+	//model matrices in the order they are drawn, one run per shape and sphere level so each run is a single instanced draw
+	//vectors are cleared and refilled like the snapshot's, so building every frame stops allocating
+	struct render_instances
+	{
+		std::vector<math::matrix44_f32> solids; //boxes, then spheres from the coarsest level to the finest
+		uSize boxes = 0;
+		uSize spheres = 0;
+		std::array<uSize, sphere_lods.size()> sphere_counts{}; //spheres drawn at each level, adding up to spheres
+		std::vector<math::matrix33_f32> flats; //rectangles, then disks
+		uSize rectangles = 0;
+		uSize disks = 0;
+
+		uSize culled = 0; //boxes and spheres left out for being outside the frustum, the drawn ones are in solids
+		cull_batch bounds;
+		std::vector<u8> levels; //the level picked for each drawn sphere, in snapshot order
+	};
+
+	void capture_render_snapshot(entity_registry& registry, render_snapshot& snapshot);
+
+	//the model matrix alpha of the way from the previous transform to the current one
+	math::matrix44_f32 get_instance_matrix(render_instance const& instance, f32 alpha);
+	math::vector3_f32 get_line_point(render_line_point const& point, f32 alpha);
+
+	//every sphere at the finest level
+	void build_render_instances(render_snapshot const& snapshot, f32 alpha, render_instances& instances);
+	//leaves out boxes and spheres whose bounding sphere is entirely outside the frustum, 2d bodies are never culled,
+	//and draws each sphere at the level its screen radius selects
+	void build_render_instances(render_snapshot const& snapshot, f32 alpha, render_view const& view, render_instances& instances);
+}
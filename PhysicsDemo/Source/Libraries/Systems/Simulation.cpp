@@ -2,148 +2,139 @@
 
 
 #include "Components.h"
+#include "Constraints.h"
+#include "Contacts.h"
+#include "Islands.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace jm
 {
-	constexpr f32 Damping = 0.9995f;
+	constexpr f32 LinearDamping = 0.06f; //per second, what scaling velocities by 0.9995 every 120 Hz tick used to take off
+	constexpr f32 AngularDamping = 0.06f;
 	constexpr math::vector3<f32> Gravity = { 0.f, -9.81f, 0.f };
 	constexpr math::vector2<f32> Gravity2 = { Gravity.x, Gravity.y };
 
-	void integrate(entity_registry& registry, f32 delta_time, math::vector3<f32> wind_force, math::vector3<f32> wall_boundaries_min, math::vector3<f32> wall_boundaries_max)
+	template <typename Integrator>
+	void integrate_linear(entity_registry& registry, f32 delta_time, math::vector3<f32> wind_force, math::vector3<f32> wall_boundaries_min, math::vector3<f32> wall_boundaries_max)
 	{
 		{
 			auto lin_sim_view = registry.view<spatial2_component, linear_body2_component>();
 			for (auto&& [entity, spatial, linear] : lin_sim_view.each())
 			{
-				math::vector2_f32 acceleration = Gravity2 + linear.applied_force * linear.inverse_mass;
-				math::euler_integration(linear.velocity, acceleration, delta_time);
-				linear.velocity *= Damping;
-				math::euler_integration(spatial.position, linear.velocity, delta_time);
+				const math::vector2_f32 applied = Gravity2 + linear.applied_force * linear.inverse_mass;
+				Integrator::step(spatial.position, linear.velocity, delta_time, [&](math::vector2_f32 const&, math::vector2_f32 const& velocity)
+					{
+						return applied - velocity * LinearDamping;
+					});
 			}
 		}
 		{	
-			auto lin_sim_view = registry.view<spatial3_component, linear_body3_component, pinned_component, sphere_shape_component>();
-			for (auto&& [entity, spatial, linear, pinned, sphere] : lin_sim_view.each())
+			//gathered into lanes so the kernel can move several bodies per instruction
+			//bodies held by constraints are tagged first and left to the constraint solve
+			update_constraint_store(registry, get_constraint_store(registry));
+			linear_batch& batch = get_linear_batch(registry);
+			if (batch.dirty)
 			{
-				if (!pinned.isPinned)
+				auto lin_sim_view = registry.view<spatial3_component, linear_body3_component, pinned_component, sphere_shape_component>(entt::exclude<sleeping_component, constraint_particle_component>);
+				auto box_sim_view = registry.view<spatial3_component, linear_body3_component, pinned_component, box_shape_component>(entt::exclude<sleeping_component, constraint_particle_component>);
+				batch.reset(lin_sim_view.size_hint() + box_sim_view.size_hint());
+				for (auto&& [entity, spatial, linear, pinned, sphere] : lin_sim_view.each())
 				{
-					math::vector3_f32 acceleration = Gravity + wind_force + linear.applied_force * linear.inverse_mass;
-					math::euler_integration(linear.velocity, acceleration, delta_time);
-					linear.velocity *= Damping;
-					math::euler_integration(spatial.position, linear.velocity, delta_time);
-
-					if (spatial.position.y < wall_boundaries_min.y + sphere.radius)
-					{
-						spatial.position = { spatial.position.x, wall_boundaries_min.y + sphere.radius, spatial.position.z };
-					}
-					else if (spatial.position.y > wall_boundaries_max.y - sphere.radius)
-					{
-						spatial.position = { spatial.position.x, wall_boundaries_max.y - sphere.radius, spatial.position.z };
-					}
-
-					if (spatial.position.x < wall_boundaries_min.x + sphere.radius)
-					{
-						spatial.position = { wall_boundaries_min.x + sphere.radius, spatial.position.y, spatial.position.z };
-					}
-					else if (spatial.position.x > wall_boundaries_max.x - sphere.radius)
-					{
-						spatial.position = { wall_boundaries_max.x - sphere.radius, spatial.position.y, spatial.position.z };
-					}
-
-					if (spatial.position.z < wall_boundaries_min.z + sphere.radius)
+					if (!pinned.isPinned)
 					{
-						spatial.position = { spatial.position.x, spatial.position.y, wall_boundaries_min.z + sphere.radius };
+						batch.push_back(spatial, linear, sphere.radius);
 					}
-					else if (spatial.position.z > wall_boundaries_max.z - sphere.radius)
+				}
+				for (auto&& [entity, spatial, linear, pinned, box] : box_sim_view.each())
+				{
+					if (!pinned.isPinned)
 					{
-						spatial.position = { spatial.position.x, spatial.position.y, wall_boundaries_max.z - sphere.radius };
+						batch.push_back(spatial, linear, box.extents);
 					}
 				}
+				batch.dirty = false;
 			}
+			gather_linear_batch(batch);
+
+			const linear_step step{ delta_time, LinearDamping, Gravity + wind_force, wall_boundaries_min, wall_boundaries_max };
+			integrate_linear_batch<Integrator>(batch, step, batch.level);
+			scatter_linear_batch(batch);
 		}
+	}
+
+	void integrate_angular(entity_registry& registry, f32 delta_time)
+	{
+		const f32 angularDamping = std::exp(-AngularDamping * delta_time);
 		{
 			auto ang_sim_view = registry.view<spatial2_component, rotational_body2_component>();
 			for (auto&& [entity, spatial, angular] : ang_sim_view.each())
 			{
 				f32 acceleration = angular.inverse_inertia * angular.applied_torque;
 				math::euler_integration(angular.velocity, acceleration, delta_time);
-				angular.velocity *= Damping;
+				angular.velocity *= angularDamping;
 				math::euler_integration(spatial.orientation, angular.velocity, delta_time);
 			}
 		}
 		{
-			auto ang_sim_view = registry.view<spatial3_component, rotational_body3_component, pinned_component>();
-			for (auto&& [entity, spatial, angular, pinned] : ang_sim_view.each())
+			angular_batch& batch = get_angular_batch(registry);
+			if (batch.dirty)
 			{
-				if (!pinned.isPinned)
+				auto ang_sim_view = registry.view<spatial3_component, rotational_body3_component, pinned_component>(entt::exclude<sleeping_component>);
+				batch.reset(ang_sim_view.size_hint());
+				for (auto&& [entity, spatial, angular, pinned] : ang_sim_view.each())
 				{
-					const math::matrix33_f32 rotationMatrix = math::rotation_matrix3(spatial.orientation);
-					const math::matrix33_f32 inverse_inertia_world = rotationMatrix * math::diagonal_matrix3(angular.inverse_inertia) * transpose(rotationMatrix);
-					const math::vector3_f32 acceleration = inverse_inertia_world * angular.applied_torque;
-					math::euler_integration(angular.velocity, acceleration, delta_time);
-					angular.velocity *= Damping;
-					const math::quaternion_f32 spin = math::get_spin(spatial.orientation, angular.velocity);
-					math::euler_integration(spatial.orientation, spin, delta_time);
-					spatial.orientation = normalize(spatial.orientation);
+					if (!pinned.isPinned)
+					{
+						batch.push_back(spatial, angular);
+					}
 				}
+				batch.dirty = false;
 			}
+			gather_angular_batch(batch);
+			integrate_angular_batch(batch, { delta_time, angularDamping }, batch.level);
+			scatter_angular_batch(batch);
 		}
-		//{
-		//	auto constraints = registry.view<constraint_component>();
-		//	for (auto&& [entity, constraint] : constraints.each())
-		//	{
-		//		spatial3_component& massAPos = registry.get<spatial3_component>(constraint.massA);
-		//		spatial3_component& massBPos = registry.get<spatial3_component>(constraint.massB);
-		//		for (int i = 0; i < 3; ++i) //relaxation, apply multiple times
-		//		{
-		//			const math::vector3_f32 dist = massAPos.position - massBPos.position;
-		//			const math::vector3_f32 dir = normalize(dist);
-		//			f32 d = length(dist);
-
-		//			f32 difference = std::abs(constraint.linkDistance - d) * 0.95f;
+	}
 
-		//			math::vector3_f32 translate = dir * 0.5f * difference;
+	void relax_constraints(entity_registry& registry, f32 delta_time, math::vector3<f32> wind_force, math::vector3<f32> wall_boundaries_min, math::vector3<f32> wall_boundaries_max)
+	{
+		constraint_store& store = get_constraint_store(registry);
+		update_constraint_store(registry, store);
 
-		//			massAPos.position -= translate;
-		//			massBPos.position += translate;
-		//		}
-		//	}
-		//}
+		gather_particles(registry, store);
+		if (store.movable_particles > 0) //everything pinned or asleep
 		{
-			for (int i = 0; i < 12; ++i) //relaxation, apply multiple times
-			{
-				auto constraints_rigid = registry.view<constraint_component_rigid>();
-				for (auto&& [entity, constraint] : constraints_rigid.each())
-				{
-					spatial3_component& massAPos = registry.get<spatial3_component>(constraint.massA);
-					spatial3_component& massBPos = registry.get<spatial3_component>(constraint.massB);
-					pinned_component& massAPin = registry.get<pinned_component>(constraint.massA);
-					pinned_component& massBPin = registry.get<pinned_component>(constraint.massB);
+			solve_constraints(store, { delta_time, LinearDamping, Gravity + wind_force, wall_boundaries_min, wall_boundaries_max });
+			scatter_particles(registry, store);
+			destroy_broken_constraints(registry, store);
+		}
+	}
 
-					const math::vector3_f32 dist = massAPos.position - massBPos.position;
-					f32 magnitude = length(dist);
-					if (magnitude > (constraint.breakThreshold * constraint.linkDistance))
-					{
-						registry.destroy(entity);
-					}
-					const math::vector3_f32 dir = normalize(dist);
+	void set_island_jobs(entity_registry& registry, Platform::JobSystem* jobs)
+	{
+		get_constraint_store(registry).jobs = jobs;
+		get_contact_cache(registry).jobs = jobs;
+	}
 
-					if (!massBPin.isPinned && !massAPin.isPinned)
-					{
-						const math::vector3_f32 midpoint = (massAPos.position + massBPos.position) / 2.0f;
-						massBPos.position = -(0.5f * dir * constraint.linkDistance) + midpoint;
-						massAPos.position = 0.5f * dir * constraint.linkDistance + midpoint;
-					}
-					else if (massBPin.isPinned)
-					{
-						massAPos.position = dir * constraint.linkDistance + massBPos.position;
-					}
-					else if (massAPin.isPinned)
-					{
-						massBPos.position = -(dir * constraint.linkDistance) + massAPos.position;
-					}
-				}
-			}
-		}
+	template <typename Integrator>
+	void integrate(entity_registry& registry, f32 delta_time, math::vector3<f32> wind_force, math::vector3<f32> wall_boundaries_min, math::vector3<f32> wall_boundaries_max)
+	{
+		integrate_linear<Integrator>(registry, delta_time, wind_force, wall_boundaries_min, wall_boundaries_max);
+		integrate_angular(registry, delta_time);
+		relax_constraints(registry, delta_time, wind_force, wall_boundaries_min, wall_boundaries_max);
+
+		//after the walls have stopped motion into them, the contact solve leaves a body on the floor pushed into it by whatever rests on top
+		update_islands(registry, delta_time, wind_force);
 	}
+
+	template void integrate_linear<math::symplectic_euler>(entity_registry&, f32, math::vector3<f32>, math::vector3<f32>, math::vector3<f32>);
+	template void integrate_linear<math::position_verlet>(entity_registry&, f32, math::vector3<f32>, math::vector3<f32>, math::vector3<f32>);
+	template void integrate_linear<math::runge_kutta4>(entity_registry&, f32, math::vector3<f32>, math::vector3<f32>, math::vector3<f32>);
+
+	template void integrate<math::symplectic_euler>(entity_registry&, f32, math::vector3<f32>, math::vector3<f32>, math::vector3<f32>);
+	template void integrate<math::position_verlet>(entity_registry&, f32, math::vector3<f32>, math::vector3<f32>, math::vector3<f32>);
+	template void integrate<math::runge_kutta4>(entity_registry&, f32, math::vector3<f32>, math::vector3<f32>, math::vector3<f32>);
 }
\ No newline at end of file
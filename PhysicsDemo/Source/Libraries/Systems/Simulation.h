@@ -2,8 +2,28 @@
 
 #include "Entity.h"
 #include "MathTypes.h"
+#include "Math/Physics.h"
+
+namespace jm::Platform
+{
+	class JobSystem;
+}
 
 namespace jm
 {
-	void integrate(entity_registry& registry, f32 delta_time, math::vector3<f32> wind_force, math::vector3<f32> wall_boundaries, math::vector3<f32> wall_boundaries_max);
+	//individual passes, integrate runs them in order
+	//the integrator is one of math::symplectic_euler, math::position_verlet or math::runge_kutta4, angular motion always uses symplectic euler
+	//it only moves free bodies, bodies held by constraints (cloth, ropes) are predicted with symplectic euler inside the xpbd substeps
+	//and take their velocity from the position change, so a higher order integrator would gain them nothing, substeps buy their accuracy
+	template <typename Integrator = math::symplectic_euler>
+	void integrate_linear(entity_registry& registry, f32 delta_time, math::vector3<f32> wind_force, math::vector3<f32> wall_boundaries_min, math::vector3<f32> wall_boundaries_max);
+	void integrate_angular(entity_registry& registry, f32 delta_time);
+	void relax_constraints(entity_registry& registry, f32 delta_time, math::vector3<f32> wind_force, math::vector3<f32> wall_boundaries_min, math::vector3<f32> wall_boundaries_max); //integrates the bodies held by constraints
+
+	//solve independent contact and constraint islands as jobs, nullptr goes back to solving them together
+	void set_island_jobs(entity_registry& registry, Platform::JobSystem* jobs);
+
+	//Integrator applies to integrate_linear only, see above
+	template <typename Integrator = math::symplectic_euler>
+	void integrate(entity_registry& registry, f32 delta_time, math::vector3<f32> wind_force, math::vector3<f32> wall_boundaries_min, math::vector3<f32> wall_boundaries_max);
 }
\ No newline at end of file
@@ -36,9 +36,10 @@ namespace jm
 		auto entity = registry.create();
 		registry.emplace<spatial3_component>(entity, position, orientation);
 		registry.emplace<linear_body3_component>(entity, velocity, mass);
-		registry.emplace<rotational_body3_component>(entity, angular_velocity, math::get_box_inertia(mass, extents));
+		registry.emplace<rotational_body3_component>(entity, angular_velocity, math::get_box_inertia(mass, 2.f * extents)); //extents are half widths
 		registry.emplace<box_shape_component>(entity, extents);
 		registry.emplace<collidable_component>(entity);
+		registry.emplace<pinned_component>(entity, false);
 		return entity;
 	}
 
@@ -71,16 +72,16 @@ namespace jm
 		, f32 linkDistance
 		, f32 breakThreshold
 		, entity_id massA
-		, entity_id massB)
+		, entity_id massB
+		, f32 compliance = 0.f)
 	{
 		auto entity = registry.create();
-		registry.emplace<constraint_component_rigid>(entity, linkDistance, breakThreshold, massA, massB);
+		registry.emplace<constraint_component_rigid>(entity, linkDistance, breakThreshold, massA, massB, compliance);
 		return entity;
 	}
 
 	void CreateBasicWorld(entity_registry& registry)
 	{
-		std::vector<entity_id> spheres;
 		//for (int y = 0; y < 10; ++y)
 		//{
 		//	for (int x = 0; x < 10; ++x)
@@ -101,12 +102,38 @@ namespace jm
 		//	}
 		//}
 		//spheres.clear();
-		for (int z = 0; z < 10; ++z)
+		CreateClothWorld(registry, 10, { 0.f, 8.f, 0.f });
+		CreateRopeWorld(registry, 1, 20, { -5.f, 2.f, -5.f });
+		
+		/*entity_id massHead = CreateSphereEntity(registry, 0.5f, 2.f, { 5, 5, -5 }, math::random::unit_quaternion<f32>(), false);
+		entity_id massPelvis = CreateSphereEntity(registry, 0.1f, 2.f, { 5, 3, -5 }, math::random::unit_quaternion<f32>(), false);
+		CreateConstraintEntity(registry, 2.f, 3.f, massHead, massPelvis);
+		entity_id massLeftElbow = CreateSphereEntity(registry, 0.5f, 2.f, { 5, 5, -5 }, math::random::unit_quaternion<f32>(), false);*/
+
+	}
+
+	void CreateSphereWorld(entity_registry& registry, uSize count, math::vector3_f32 const& boundsMin, math::vector3_f32 const& boundsMax)
+	{
+		for (uSize i = 0; i < count; ++i)
 		{
-			for (int x = 0; x < 10; ++x)
+			math::vector3_f32 position = {
+				math::random::scalar(boundsMin.x, boundsMax.x),
+				math::random::scalar(boundsMin.y, boundsMax.y),
+				math::random::scalar(boundsMin.z, boundsMax.z) };
+			CreateSphereEntity(registry, position, math::random::unit_quaternion<f32>(), false);
+		}
+	}
+
+	void CreateClothWorld(entity_registry& registry, uSize size, math::vector3_f32 const& origin)
+	{
+		std::vector<entity_id> spheres;
+		spheres.reserve(size * size);
+		for (uSize z = 0; z < size; ++z)
+		{
+			for (uSize x = 0; x < size; ++x)
 			{
 				bool pin = x == 0;
-				entity_id mass = CreateSphereEntity(registry, { x, 8, z }, math::random::unit_quaternion<f32>(), pin);
+				entity_id mass = CreateSphereEntity(registry, origin + math::vector3_f32{ x, 0, z }, math::random::unit_quaternion<f32>(), pin);
 
 				if (x != 0)
 				{
@@ -115,29 +142,64 @@ namespace jm
 
 				if (z != 0)
 				{
-					CreateConstraintEntity(registry, 1.f, 10.f, spheres[spheres.size() - 10], mass);
+					CreateConstraintEntity(registry, 1.f, 10.f, spheres[spheres.size() - size], mass);
 				}
 				spheres.push_back(mass);
 			}
 		}
-		spheres.clear();
-		for (int y = 0; y < 20; ++y)
+	}
+
+	void CreateRopeWorld(entity_registry& registry, uSize ropes, uSize length, math::vector3_f32 const& origin, f32 compliance)
+	{
+		for (uSize r = 0; r < ropes; ++r)
 		{
-			bool pin = y == 19;
-			entity_id mass = CreateSphereEntity(registry, { -5, y + 2, -5 }, math::random::unit_quaternion<f32>(), pin);
-			
-			if (y != 0)
+			entity_id last = null_entity_id;
+			for (uSize y = 0; y < length; ++y)
 			{
-				CreateConstraintEntity(registry, 1.f, 3.f, mass, spheres.back());
+				bool pin = y == length - 1;
+				entity_id mass = CreateSphereEntity(registry, origin + math::vector3_f32{ 2 * r, y, 0 }, math::random::unit_quaternion<f32>(), pin);
+
+				if (y != 0)
+				{
+					CreateConstraintEntity(registry, 1.f, 3.f, mass, last, compliance);
+				}
+				last = mass;
 			}
-			spheres.push_back(mass);
 		}
-		
-		/*entity_id massHead = CreateSphereEntity(registry, 0.5f, 2.f, { 5, 5, -5 }, math::random::unit_quaternion<f32>(), false);
-		entity_id massPelvis = CreateSphereEntity(registry, 0.1f, 2.f, { 5, 3, -5 }, math::random::unit_quaternion<f32>(), false);
-		CreateConstraintEntity(registry, 2.f, 3.f, massHead, massPelvis);
-		entity_id massLeftElbow = CreateSphereEntity(registry, 0.5f, 2.f, { 5, 5, -5 }, math::random::unit_quaternion<f32>(), false);*/
+	}
+
+	void CreateMixedWorld(entity_registry& registry, uSize count, math::vector3_f32 const& boundsMin, math::vector3_f32 const& boundsMax)
+	{
+		for (uSize i = 0; i < count; ++i)
+		{
+			math::vector3_f32 position = {
+				math::random::scalar(boundsMin.x, boundsMax.x),
+				math::random::scalar(boundsMin.y, boundsMax.y),
+				math::random::scalar(boundsMin.z, boundsMax.z) };
+			if (i % 2 == 0)
+			{
+				CreateSphereEntity(registry, position, math::random::unit_quaternion<f32>(), false);
+			}
+			else
+			{
+				CreateBoxEntity(registry, position, math::random::unit_quaternion<f32>(), math::vector3_f32{ 0.5f });
+			}
+		}
+	}
 
+	void CreateStackWorld(entity_registry& registry, uSize columns, uSize layers, math::vector3_f32 const& origin)
+	{
+		constexpr f32 radius = 0.5f;
+		for (uSize z = 0; z < columns; ++z)
+		{
+			for (uSize x = 0; x < columns; ++x)
+			{
+				for (uSize y = 0; y < layers; ++y)
+				{
+					const math::vector3_f32 position = origin + math::vector3_f32{ 2 * x, radius + 2 * radius * y, 2 * z };
+					CreateSphereEntity(registry, radius, 2.f, position, math::quaternion_f32(1.f, 0.f, 0.f, 0.f), {}, {}, false);
+				}
+			}
+		}
 	}
 }
-
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Systems/Entity.h"
+#include "Math/MathTypes.h"
+
+namespace jm
+{
+	void CreateBasicWorld(entity_registry& registry);
+
+	//scenes used by the headless runner and benchmarks
+	void CreateSphereWorld(entity_registry& registry, uSize count, math::vector3_f32 const& boundsMin, math::vector3_f32 const& boundsMax);
+	void CreateClothWorld(entity_registry& registry, uSize size, math::vector3_f32 const& origin);
+	void CreateRopeWorld(entity_registry& registry, uSize ropes, uSize length, math::vector3_f32 const& origin, f32 compliance = 0.f); //compliance on every link, zero is rigid
+	void CreateMixedWorld(entity_registry& registry, uSize count, math::vector3_f32 const& boundsMin, math::vector3_f32 const& boundsMax);
+	void CreateStackWorld(entity_registry& registry, uSize columns, uSize layers, math::vector3_f32 const& origin); //columns x columns stacks at rest, origin on the floor
+}
@@ -0,0 +1,355 @@
+#pragma once
+
+#include "VisualDebug.h"
+
+#include "Math/HalfEdgeMesh.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace jm::Visual
+{
+	using index_sequence = std::vector<size_t>;
+
+	inline index_sequence GetSequence(size_t a, size_t b, size_t stepSize = 1)
+	{
+		if (a == b)
+		{
+			return { a };
+		}
+
+		if (a + stepSize == b)
+		{
+			return { a, b };
+		}
+
+		JM_VISUAL_ASSERT(std::gcd(b - a, stepSize) == stepSize);
+
+		index_sequence numbers;
+		for (size_t i = a; i <= b; i += stepSize)
+		{
+			numbers.push_back(i);
+		}
+		return numbers;
+	}
+
+	inline index_sequence GetSequence(size_t a, index_sequence middle, size_t b)
+	{
+		index_sequence sequence = { a, b };
+		sequence.insert(sequence.begin() + 1, middle.begin(), middle.end());
+		return sequence;
+	}
+
+	//the triangles generated meshes are built from, every triangle around a vertex shares it
+	template <size_t Dimension, typename Scalar>
+	class GeometryGraph
+	{
+		static_assert((Dimension == 2) != (Dimension == 3));
+
+		using Vertex = math::vectorN<Dimension, Scalar>;
+		using Tri = math::vector3<size_t>;
+		using Quad = math::vector4<size_t>;
+
+		math::half_edge_mesh<Vertex> Mesh;
+
+	public:
+
+		explicit GeometryGraph(std::vector<Vertex>&& vertices)
+			: Mesh(std::move(vertices))
+		{}
+
+		auto GetTriangleCount() const
+		{
+			return Mesh.triangle_count();
+		}
+
+		std::vector<Vertex> const& GetVertices() const
+		{
+			return Mesh.get_vertices();
+		}
+
+		math::half_edge_mesh<Vertex> const& GetMesh() const
+		{
+			return Mesh;
+		}
+
+		const auto& GetVertex(size_t index) const
+		{
+			return Mesh.get_vertex((u32)index);
+		}
+
+		index_sequence AddVertexSet(std::vector<Vertex> const& vertexSet)
+		{
+			const size_t first = Mesh.add_vertices(vertexSet);
+			return GetSequence(first, first + vertexSet.size() - 1);
+		}
+
+		void AddTriangle(Tri face)
+		{
+			Mesh.add_triangle((u32)face.x, (u32)face.y, (u32)face.z);
+		}
+
+		auto AddQuadrangle(Quad face)
+		{
+			AddTriangle({ face.x, face.y, face.z });
+			AddTriangle({ face.x, face.z, face.w });
+		}
+
+		void AddFan(size_t centre, index_sequence const& outer, bool closed)
+		{
+			JM_VISUAL_ASSERT(outer.size() > 1);
+
+			for (size_t i = 0; i < outer.size() - 1; ++i)
+			{
+				AddTriangle({ centre, outer[i], outer[i + 1] });
+			}
+
+			if (closed)
+			{
+				AddTriangle({ centre, outer[outer.size() - 1], outer[0] });
+			}
+		};
+
+		void AddStrip(index_sequence const& up, index_sequence const& down, bool closed = false)
+		{
+			size_t size = std::min(up.size(), down.size());
+
+			for (size_t i = 0; i < size - 1; ++i)
+			{
+				AddQuadrangle({ up[i], down[i], down[i + 1], up[i + 1] });
+			}
+
+			if (up.size() > size)
+			{
+				JM_VISUAL_ASSERT(!closed, "Doesn't make sense with uneven strip");
+				
+				AddFan(down[size - 1], index_sequence{ up.data() + size - 1, up.data() + up.size() }, false);
+			}
+			else if (down.size() > size)
+			{
+				JM_VISUAL_ASSERT(!closed, "Doesn't make sense with uneven strip");
+
+				AddFan(up[size - 1], index_sequence{ down.data() + size - 1, down.data() + down.size() }, false);
+			}
+			else if (closed)
+			{
+				AddQuadrangle({ up[size - 1], down[size - 1], down[0], up[0] });
+			}
+		};
+	};
+
+	template <size_t Dimension>
+	using GeometryGraph_f32 = GeometryGraph<Dimension, f32>;
+
+	template <size_t Dimension, typename Scalar>
+	std::vector<math::vectorN<Dimension, Scalar>> GetLinearInterpolants(math::vectorN<Dimension, Scalar> const& a
+		, math::vectorN<Dimension, Scalar> const& b, size_t sections, bool return_ends = false)
+	{
+		if (sections == 0)
+		{
+			if (return_ends)
+			{
+				return { a,b };
+			}
+			else
+			{
+				return {};
+			}
+		}
+
+		std::vector<math::vectorN<Dimension, Scalar>> vertices;
+
+		if (return_ends)
+		{
+			vertices.push_back(a);
+		}
+
+		math::vectorN<Dimension, Scalar> v = b - a;
+		math::vectorN<Dimension, Scalar> dir = normalize(v);
+		Scalar deltaDisp = length(v) / (sections + 1);
+		for (u32 i = 1; i <= sections; ++i)
+		{
+			vertices.push_back(a + dir * (i * deltaDisp));
+		}
+
+		if (return_ends)
+		{
+			vertices.push_back(b);
+		}
+		return vertices;
+	}
+
+	template <size_t Dimension, typename Scalar>
+	std::vector<math::vectorN<Dimension, Scalar>> GetArcedInterpolants(math::vectorN<Dimension, Scalar> const& a
+		, math::vectorN<Dimension, Scalar> const& b, size_t sections, bool return_ends = false)
+	{
+		if (sections == 0)
+		{
+			if (return_ends)
+			{
+				return { a,b };
+			}
+			else
+			{
+				return {};
+			}
+		}
+
+		Scalar angle = math::angle<Dimension, Scalar>(a, b);
+		if (std::abs(angle) > std::numeric_limits<Scalar>::epsilon())
+		{
+			std::vector<math::vectorN<Dimension, Scalar>> vertices;
+
+			if (return_ends)
+			{
+				vertices.push_back(a);
+			}
+
+			Scalar deltaAlpha = math::one<Scalar>() / (sections + 1);
+			for (u32 i = 1; i <= sections; ++i)
+			{
+				const Scalar t = i * deltaAlpha;
+				const Scalar s = math::one<Scalar>() - t;
+				const Scalar aScale = std::sin(s * angle) / std::sin(angle);
+				const Scalar bScale = std::sin(t * angle) / std::sin(angle);
+
+				vertices.push_back(aScale * a + bScale * b);
+			}
+
+			if (return_ends)
+			{
+				vertices.push_back(b);
+			}
+			return vertices;
+		}
+		else
+		{
+			return GetLinearInterpolants<Dimension, Scalar>(a, b, sections, return_ends);
+		}
+	}
+
+	//splits every side into subdivisions sections and fills each triangle with rows of smaller ones
+	//a side is split once and shared, reversed, with the triangle across it
+	template <size_t Dimension>
+	GeometryGraph_f32<Dimension> Subdivide(GeometryGraph_f32<Dimension> const& geometry, size_t subdivisions, bool arced)
+	{
+		JM_VISUAL_ASSERT(subdivisions >= 2);
+
+		auto const& mesh = geometry.GetMesh();
+
+		auto vertices = geometry.GetVertices();
+		GeometryGraph_f32<Dimension> newGeometry(std::move(vertices));
+
+		auto interpolate = [&newGeometry, arced](size_t start, size_t end, size_t sections)
+		{
+			auto first = newGeometry.GetVertex(start);
+			auto second = newGeometry.GetVertex(end);
+			if (arced)
+			{
+				return newGeometry.AddVertexSet(GetArcedInterpolants<Dimension, f32>(first, second, sections));
+			}
+			else
+			{
+				return newGeometry.AddVertexSet(GetLinearInterpolants<Dimension, f32>(first, second, sections));
+			}
+		};
+
+		//the vertices inside each side in the order its half edge walks it
+		std::vector<index_sequence> sideVertices(mesh.half_edge_count());
+		for (u32 side = 0; side < mesh.half_edge_count(); ++side)
+		{
+			if (!sideVertices[side].empty())
+			{
+				continue;
+			}
+
+			sideVertices[side] = interpolate(mesh.start(side), mesh.end(side), subdivisions - 1);
+			const u32 twin = mesh.twin(side);
+			if (twin != mesh.invalid)
+			{
+				sideVertices[twin].assign(sideVertices[side].rbegin(), sideVertices[side].rend());
+			}
+		}
+
+		for (u32 triangle = 0; triangle < mesh.triangle_count(); ++triangle)
+		{
+			const auto face = mesh.get_triangle(triangle);
+			auto a = geometry.GetVertex(face[0]);
+			auto b = geometry.GetVertex(face[1]);
+			auto c = geometry.GetVertex(face[2]);
+			auto aAngle = math::angle<Dimension, f32>(b - a, c - a);
+			auto bAngle = math::angle<Dimension, f32>(c - b, a - b);
+			auto cAngle = math::pi<f32>() - aAngle - bAngle;
+
+			//rows run from the corner with the largest angle to the side across it
+			u32 corner = 0;
+			if (aAngle >= bAngle)
+			{
+				corner = cAngle >= aAngle ? 2 : 0;
+			}
+			else
+			{
+				corner = cAngle >= bAngle ? 2 : 1;
+			}
+			const size_t centre = face[corner];
+
+			//the sides leaving the centre to its left and coming back from its right, and the base between them
+			const u32 leftSide = 3 * triangle + corner;
+			const u32 baseSide = 3 * triangle + (corner + 1) % 3;
+			const u32 rightSide = 3 * triangle + (corner + 2) % 3;
+
+			auto const& leftVertices = sideVertices[leftSide];
+			const index_sequence rightVertices(sideVertices[rightSide].rbegin(), sideVertices[rightSide].rend());
+
+			//peak triangle
+			newGeometry.AddTriangle({ centre, leftVertices[0], rightVertices[0] });
+
+			//middle triangles
+			index_sequence lastVertices = { leftVertices[0], rightVertices[0] };
+			for (size_t i = 1; i < subdivisions - 1; ++i)
+			{
+				index_sequence currentVertices = GetSequence(leftVertices[i], interpolate(leftVertices[i], rightVertices[i], i), rightVertices[i]);
+
+				newGeometry.AddStrip(lastVertices, currentVertices, false);
+
+				lastVertices = currentVertices;
+			}
+
+			//base triangles
+			index_sequence currentVertices = GetSequence(mesh.start(baseSide), sideVertices[baseSide], mesh.end(baseSide));
+
+			newGeometry.AddStrip(lastVertices, currentVertices, false);
+		}
+
+		return newGeometry;
+	}
+
+	inline GeometryGraph_f32<3> CubeGeometry(f32 diameter)
+	{
+		const float extent = diameter * 0.5f;
+
+		std::vector<math::vector3<f32>> vertices{
+			{-extent, -extent, -extent},
+			{extent, -extent, -extent},
+			{extent, extent, -extent},
+			{-extent, extent, -extent},
+			{-extent, extent, extent},
+			{extent, extent, extent},
+			{extent, -extent, extent},
+			{-extent, -extent, extent}
+		};
+
+		GeometryGraph_f32<3> cubeGraph(std::move(vertices));
+
+		cubeGraph.AddQuadrangle({ 3, 2, 1, 0 }); //bottom
+		cubeGraph.AddQuadrangle({ 7, 6, 5, 4 }); //top
+		cubeGraph.AddQuadrangle({ 1, 2, 5, 6 }); //front
+		cubeGraph.AddQuadrangle({ 2, 3, 4, 5 }); //right
+		cubeGraph.AddQuadrangle({ 0, 7, 4, 3 }); //back
+		cubeGraph.AddQuadrangle({ 0, 1, 6, 7 }); //left
+
+		return cubeGraph;
+	}
+}
@@ -27,6 +27,13 @@ namespace jm::Visual
 		}
 	};
 
+	//triangles sharing their vertices, three indices per triangle counting from the first vertex
+	struct IndexedBuffer
+	{
+		RawBuffer vertices;
+		std::vector<u32> indices;
+	};
+
 	class InputLayout
 	{
 	public:
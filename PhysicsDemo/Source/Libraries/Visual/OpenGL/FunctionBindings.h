@@ -45,8 +45,10 @@
 	GLE(void,			DeleteVertexArrays,			GLsizei n, const GLuint *arrays) \
 	GLE(void,			DetachShader,				GLuint program, GLuint shader) \
 	GLE(void,			DisableVertexAttribArray,	GLuint index) \
+	GLE(void,			DrawArraysInstanced,		GLenum mode, GLint first, GLsizei count, GLsizei instancecount) \
 	GLE(void,			DrawBuffers,				GLsizei n, const GLenum *bufs) \
 	GLE(void,			DrawElementsBaseVertex,		GLenum mode, GLsizei count, GLenum type, GLvoid *indices, GLint basevertex) \
+	GLE(void,			DrawElementsInstancedBaseVertex,	GLenum mode, GLsizei count, GLenum type, const GLvoid *indices, GLsizei instancecount, GLint basevertex) \
 	GLE(void,			DrawTransformFeedback,		GLenum mode, GLuint feedbackbuffer) \
 	GLE(void,			EnableVertexAttribArray,	GLuint index) \
 	GLE(void,			EndTransformFeedback,		void) \
@@ -59,6 +61,7 @@
 	GLE(void,			GenVertexArrays,			GLsizei n, GLuint *arrays) \
 	GLE(void,			GenerateMipmap,				GLenum target) \
 	GLE(void,			GenerateTextureMipmap,		GLuint texture) \
+	GLE(void,			GetActiveUniform,			GLuint program, GLuint index, GLsizei bufSize, GLsizei *length, GLint *size, GLenum *type, GLchar *name) \
 	GLE(GLint,			GetAttribLocation,			GLuint program, const GLchar *name) \
 	GLE(void,			GetProgramInfoLog,			GLuint program, GLsizei maxLength, GLsizei *length, GLchar *infoLog) \
 	GLE(void,			GetProgramiv,				GLuint program, GLenum pname, GLint *params) \
@@ -67,6 +70,7 @@
 	GLE(const GLubyte*,	GetStringi,					GLenum name, GLuint index) \
 	GLE(GLint,			GetUniformLocation,			GLuint program, const GLchar *name) \
 	GLE(void,			LinkProgram,				GLuint program) \
+	GLE(void*,			MapBufferRange,				GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) \
 	GLE(void,			RenderbufferStorage,		GLenum target, GLenum internalformat, GLsizei width, GLsizei height) \
 	GLE(void,			ShaderSource,				GLuint shader, GLsizei count, const GLchar **string, const GLint *length) \
 	GLE(void,			TransformFeedbackVaryings,	GLuint program, GLsizei count, const GLchar **varyings, GLenum bufferMode) \
@@ -79,8 +83,10 @@
 	GLE(void,			Uniform4f,					GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3) \
 	GLE(void,			UniformMatrix3fv,			GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) \
 	GLE(void,			UniformMatrix4fv,			GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) \
+	GLE(GLboolean,		UnmapBuffer,				GLenum target) \
 	GLE(void,			UseProgram,					GLuint program) \
 	GLE(void,			VertexAttribBinding,		GLuint attribindex, GLuint bindingindex) \
+	GLE(void,			VertexAttribDivisor,		GLuint index, GLuint divisor) \
 	GLE(void,			VertexAttribFormat,			GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset) \
 	GLE(void,			VertexAttribPointer,		GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid * pointer)
 
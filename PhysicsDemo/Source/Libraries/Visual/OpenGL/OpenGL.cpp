@@ -13,6 +13,9 @@ PFNWGLSWAPINTERVALEXTPROC wglSwapIntervalEXT;
 
 #include "MeshData.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace jm::OpenGL
 {
 	typedef PROC WINAPI wglGetProcAddressproc(LPCSTR lpszProc);
@@ -157,10 +160,6 @@ namespace jm::OpenGL
 		}
 	}
 
-#else
-	void CheckError() {}
-	void CheckFrameBuffer() {}
-
 #endif
 
 	bool FormatPixelBuffer(HDC deviceContext)
@@ -274,6 +273,21 @@ namespace jm::OpenGL
 		glDeleteVertexArrays(1, &VAO);
 	}
 
+	void PointVertexAttributes(Visual::InputLayout const& inputLayout)
+	{
+		GLsizei stride = (GLsizei)(inputLayout.elementSize * sizeof(float));
+
+		for (u32 a = 0; a < inputLayout.attributes.size(); ++a)
+		{
+			auto attribute = inputLayout.attributes[a];
+			JM_VISUAL_ASSERT(1 <= attribute.size && attribute.size <= 4);
+			void* ptrOffset = (void*)(attribute.offset * sizeof(float));
+			glVertexAttribPointer(a, attribute.size, GL_FLOAT, GL_FALSE, stride, ptrOffset);
+			glEnableVertexAttribArray(a);
+			OpenGL::CheckError();
+		}
+	}
+
 	InputBufferHandle Memory::createInputBuffer(
 		InputLayoutHandle inputLayoutHandle,
 		const byte_list& inputData)
@@ -294,20 +308,7 @@ namespace jm::OpenGL
 		OpenGL::CheckError();
 
 		VAOStates[VAO].VBO.push_back(VBO);
-		Visual::InputLayout& inputLayout = VAOStates[VAO].layout;
-
-		GLsizei stride = (GLsizei)(inputLayout.elementSize * sizeof(float));
-
-		for (u32 a = 0; a < inputLayout.attributes.size(); ++a)
-		{
-			auto attribute = inputLayout.attributes[a];
-			JM_VISUAL_ASSERT(1 <= attribute.size && attribute.size <= 4);
-			void* ptrOffset = (void*)(attribute.offset * sizeof(float));
-			glVertexAttribPointer(a, attribute.size, GL_FLOAT, GL_FALSE, stride, ptrOffset);
-			glEnableVertexAttribArray(a);
-			OpenGL::CheckError();
-		}
-
+		PointVertexAttributes(VAOStates[VAO].layout);
 
 		glBufferData(GL_ARRAY_BUFFER, inputData.size(), inputData.data(), GL_STATIC_DRAW);
 
@@ -331,7 +332,244 @@ namespace jm::OpenGL
 		bufferHandle = 0;
 		*findResult = NULL;
 		vbos.erase(findResult);
+		if (VAOStates[VAO].instanceVBO == VBO)
+		{
+			VAOStates[VAO].instanceVBO = 0;
+		}
+		if (VAOStates[VAO].streamVBO == VBO)
+		{
+			VAOStates[VAO].streamVBO = 0;
+		}
+		if (VAOStates[VAO].indexVBO == VBO)
+		{
+			VAOStates[VAO].indexVBO = 0;
+		}
 
 		glDeleteBuffers(1, &VBO);
 	}
+
+	void PointInstanceAttributes(Visual::InputLayout const& layout, Visual::InputLayout const& instanceLayout, uSize firstInstance)
+	{
+		GLsizei stride = (GLsizei)(instanceLayout.elementSize * sizeof(float));
+
+		for (u32 a = 0; a < instanceLayout.attributes.size(); ++a)
+		{
+			auto attribute = instanceLayout.attributes[a];
+			JM_VISUAL_ASSERT(1 <= attribute.size && attribute.size <= 4);
+			void* ptrOffset = (void*)(firstInstance * stride + attribute.offset * sizeof(float));
+			glVertexAttribPointer((GLuint)layout.attributes.size() + a, attribute.size, GL_FLOAT, GL_FALSE, stride, ptrOffset);
+		}
+	}
+
+	InputBufferHandle Memory::createInstanceBuffer(
+		InputLayoutHandle inputLayoutHandle,
+		const Visual::InputLayout& instanceLayout)
+	{
+		GLuint VAO = static_cast<GLuint>(inputLayoutHandle);
+		JM_VISUAL_ASSERT(std::cmp_equal(VAO, inputLayoutHandle)); //check casting safety
+		JM_VISUAL_ASSERT(VAOStates.contains(VAO));
+
+		LayoutState& layoutState = VAOStates[VAO];
+		JM_VISUAL_ASSERT(layoutState.instanceVBO == 0, "Layout already has an instance buffer!");
+
+		GLuint VBO{};
+		glGenBuffers(1, &VBO);
+		InputBufferHandle newHandle{ VBO };
+		JM_VISUAL_ASSERT(std::cmp_equal(VBO, newHandle)); //check casting safety
+
+		glBindVertexArray(VAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+		OpenGL::CheckError();
+
+		layoutState.VBO.push_back(VBO);
+		layoutState.instanceLayout = instanceLayout;
+		layoutState.instanceVBO = VBO;
+
+		PointInstanceAttributes(layoutState.layout, instanceLayout, 0);
+		for (u32 a = 0; a < instanceLayout.attributes.size(); ++a)
+		{
+			GLuint index = (GLuint)layoutState.layout.attributes.size() + a;
+			glVertexAttribDivisor(index, 1);
+			glEnableVertexAttribArray(index);
+			OpenGL::CheckError();
+		}
+
+		glBufferData(GL_ARRAY_BUFFER, 0, nullptr, GL_STREAM_DRAW);
+
+		OpenGL::CheckError();
+		return newHandle;
+	}
+
+	void Memory::updateInstanceBuffer(InputLayoutHandle inputLayoutHandle, const void* instanceData, uSize bytes)
+	{
+		GLuint VAO = static_cast<GLuint>(inputLayoutHandle);
+		JM_VISUAL_ASSERT(std::cmp_equal(VAO, inputLayoutHandle)); //check casting safety
+		JM_VISUAL_ASSERT(VAOStates.contains(VAO));
+
+		LayoutState& layoutState = VAOStates[VAO];
+		JM_VISUAL_ASSERT(layoutState.instanceVBO != 0, "Layout has no instance buffer!");
+
+		glBindBuffer(GL_ARRAY_BUFFER, layoutState.instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, bytes, instanceData, GL_STREAM_DRAW);
+
+		OpenGL::CheckError();
+	}
+
+	void Memory::selectInstances(InputLayoutHandle inputLayoutHandle, uSize firstInstance)
+	{
+		GLuint VAO = static_cast<GLuint>(inputLayoutHandle);
+		JM_VISUAL_ASSERT(std::cmp_equal(VAO, inputLayoutHandle)); //check casting safety
+		JM_VISUAL_ASSERT(VAOStates.contains(VAO));
+
+		LayoutState& layoutState = VAOStates[VAO];
+		JM_VISUAL_ASSERT(layoutState.instanceVBO != 0, "Layout has no instance buffer!");
+
+		//attribute pointers read the buffer bound when they are set, not the one bound at draw time
+		glBindBuffer(GL_ARRAY_BUFFER, layoutState.instanceVBO);
+		PointInstanceAttributes(layoutState.layout, layoutState.instanceLayout, firstInstance);
+
+		OpenGL::CheckError();
+	}
+
+	InputBufferHandle Memory::createStreamBuffer(InputLayoutHandle inputLayoutHandle, uSize capacityBytes)
+	{
+		GLuint VAO = static_cast<GLuint>(inputLayoutHandle);
+		JM_VISUAL_ASSERT(std::cmp_equal(VAO, inputLayoutHandle)); //check casting safety
+		JM_VISUAL_ASSERT(VAOStates.contains(VAO));
+
+		LayoutState& layoutState = VAOStates[VAO];
+		JM_VISUAL_ASSERT(layoutState.streamVBO == 0, "Layout already has a stream buffer!");
+
+		GLuint VBO{};
+		glGenBuffers(1, &VBO);
+		InputBufferHandle newHandle{ VBO };
+		JM_VISUAL_ASSERT(std::cmp_equal(VBO, newHandle)); //check casting safety
+
+		glBindVertexArray(VAO);
+
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+		OpenGL::CheckError();
+
+		layoutState.VBO.push_back(VBO);
+		layoutState.streamVBO = VBO;
+		layoutState.streamCapacity = capacityBytes;
+		layoutState.streamOffset = 0;
+		PointVertexAttributes(layoutState.layout);
+
+		glBufferData(GL_ARRAY_BUFFER, capacityBytes, nullptr, GL_STREAM_DRAW);
+
+		OpenGL::CheckError();
+		return newHandle;
+	}
+
+	void* Memory::mapStream(InputLayoutHandle inputLayoutHandle, uSize vertexCount, GLint& firstVertex)
+	{
+		GLuint VAO = static_cast<GLuint>(inputLayoutHandle);
+		JM_VISUAL_ASSERT(std::cmp_equal(VAO, inputLayoutHandle)); //check casting safety
+		JM_VISUAL_ASSERT(VAOStates.contains(VAO));
+
+		LayoutState& layoutState = VAOStates[VAO];
+		JM_VISUAL_ASSERT(layoutState.streamVBO != 0, "Layout has no stream buffer!");
+		JM_VISUAL_ASSERT(vertexCount != 0, "Mapping an empty range!");
+
+		const uSize stride = layoutState.layout.elementSize * sizeof(float);
+		const uSize bytes = vertexCount * stride;
+
+		glBindBuffer(GL_ARRAY_BUFFER, layoutState.streamVBO);
+
+		if (bytes > layoutState.streamCapacity)
+		{
+			layoutState.streamCapacity = std::max(bytes, 2 * layoutState.streamCapacity);
+			glBufferData(GL_ARRAY_BUFFER, layoutState.streamCapacity, nullptr, GL_STREAM_DRAW);
+			layoutState.streamOffset = 0;
+		}
+		else if (layoutState.streamOffset + bytes > layoutState.streamCapacity)
+		{
+			//orphan the storage, the driver keeps it for draws still reading it and hands back fresh storage without waiting
+			glBufferData(GL_ARRAY_BUFFER, layoutState.streamCapacity, nullptr, GL_STREAM_DRAW);
+			layoutState.streamOffset = 0;
+		}
+
+		//nothing written since the storage was orphaned is overwritten, so the range needs no synchronisation
+		void* data = glMapBufferRange(GL_ARRAY_BUFFER, (GLintptr)layoutState.streamOffset, (GLsizeiptr)bytes,
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+		JM_VISUAL_ASSERT(data, "Could not map the stream buffer!");
+
+		firstVertex = (GLint)(layoutState.streamOffset / stride);
+		layoutState.streamOffset += bytes;
+
+		OpenGL::CheckError();
+		return data;
+	}
+
+	void Memory::unmapStream(InputLayoutHandle inputLayoutHandle)
+	{
+		GLuint VAO = static_cast<GLuint>(inputLayoutHandle);
+		JM_VISUAL_ASSERT(std::cmp_equal(VAO, inputLayoutHandle)); //check casting safety
+		JM_VISUAL_ASSERT(VAOStates.contains(VAO));
+
+		glBindBuffer(GL_ARRAY_BUFFER, VAOStates[VAO].streamVBO);
+		JM_VISUAL_VERIFY(glUnmapBuffer(GL_ARRAY_BUFFER), "Stream buffer contents were lost while mapped!");
+
+		OpenGL::CheckError();
+	}
+
+	InputBufferHandle Memory::createIndexBuffer(InputLayoutHandle inputLayoutHandle, const std::vector<u32>& indices)
+	{
+		GLuint VAO = static_cast<GLuint>(inputLayoutHandle);
+		JM_VISUAL_ASSERT(std::cmp_equal(VAO, inputLayoutHandle)); //check casting safety
+		JM_VISUAL_ASSERT(VAOStates.contains(VAO));
+
+		LayoutState& layoutState = VAOStates[VAO];
+		JM_VISUAL_ASSERT(layoutState.indexVBO == 0, "Layout already has an index buffer!");
+
+		GLuint VBO{};
+		glGenBuffers(1, &VBO);
+		InputBufferHandle newHandle{ VBO };
+		JM_VISUAL_ASSERT(std::cmp_equal(VBO, newHandle)); //check casting safety
+
+		//the element buffer binding is part of the vertex array, so it is bound with it for every draw
+		glBindVertexArray(VAO);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, VBO);
+
+		OpenGL::CheckError();
+
+		layoutState.VBO.push_back(VBO);
+		layoutState.indexVBO = VBO;
+
+		const bool narrow = std::ranges::all_of(indices, [](u32 index) { return index <= std::numeric_limits<u16>::max(); });
+		if (narrow)
+		{
+			std::vector<u16> narrowIndices(indices.begin(), indices.end());
+			layoutState.indexType = GL_UNSIGNED_SHORT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, narrowIndices.size() * sizeof(u16), narrowIndices.data(), GL_STATIC_DRAW);
+		}
+		else
+		{
+			layoutState.indexType = GL_UNSIGNED_INT;
+			glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(u32), indices.data(), GL_STATIC_DRAW);
+		}
+
+		OpenGL::CheckError();
+		return newHandle;
+	}
+
+	void Memory::drawIndexed(InputLayoutHandle inputLayoutHandle, GLenum mode, uSize firstIndex, uSize indexCount, GLint baseVertex, uSize instanceCount)
+	{
+		GLuint VAO = static_cast<GLuint>(inputLayoutHandle);
+		JM_VISUAL_ASSERT(std::cmp_equal(VAO, inputLayoutHandle)); //check casting safety
+		JM_VISUAL_ASSERT(VAOStates.contains(VAO));
+
+		LayoutState& layoutState = VAOStates[VAO];
+		JM_VISUAL_ASSERT(layoutState.indexVBO != 0, "Layout has no index buffer!");
+
+		const uSize indexSize = layoutState.indexType == GL_UNSIGNED_SHORT ? sizeof(u16) : sizeof(u32);
+		glDrawElementsInstancedBaseVertex(mode, (GLsizei)indexCount, layoutState.indexType, (const void*)(firstIndex * indexSize), (GLsizei)instanceCount, baseVertex);
+
+		OpenGL::CheckError();
+	}
 }
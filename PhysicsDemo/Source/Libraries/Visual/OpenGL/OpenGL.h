@@ -4,6 +4,7 @@
 #include "Platform/OS.h"
 #include "Platform/Window.h"
 
+#include "VisualDebug.h"
 #include "MeshData.h"
 
 #include "FunctionBindings.h" //TODO: should be hidden
@@ -14,8 +15,14 @@
 
 namespace jm::OpenGL
 {
+#if JM_DEBUG
 	void CheckError();
 	void CheckFrameBuffer();
+#else
+	//inline so release builds pay nothing for the checks left around every call
+	inline void CheckError() {}
+	inline void CheckFrameBuffer() {}
+#endif
 
 	class Rasterizer
 	{
@@ -60,12 +67,42 @@ namespace jm::OpenGL
 			const byte_list& inputData);
 		void destroyInputBuffer(InputLayoutHandle inputLayoutHandle, InputBufferHandle& bufferHandle);
 
+		//per instance attributes, numbered after the layout's own and advanced once per instance, one buffer per layout
+		InputBufferHandle createInstanceBuffer(
+			InputLayoutHandle inputLayoutHandle,
+			const Visual::InputLayout& instanceLayout);
+		//replaces every instance, orphaning the old storage so draws still reading it do not stall the upload
+		void updateInstanceBuffer(InputLayoutHandle inputLayoutHandle, const void* instanceData, uSize bytes);
+		//starts the instance attributes at firstInstance for the next instanced draw, the layout must be bound
+		void selectInstances(InputLayoutHandle inputLayoutHandle, uSize firstInstance);
+
+		//a vertex buffer rewritten every frame, one per layout, written as a ring that is orphaned when it wraps
+		//its storage doubles when a frame needs more than it holds and is otherwise reused, so memory stays bounded
+		InputBufferHandle createStreamBuffer(InputLayoutHandle inputLayoutHandle, uSize capacityBytes);
+		//room for vertexCount vertices after the last ones written, firstVertex is where they start for the draw
+		//the GPU may still be drawing from earlier ranges, so only the returned range may be written, until unmapStream
+		void* mapStream(InputLayoutHandle inputLayoutHandle, uSize vertexCount, GLint& firstVertex);
+		void unmapStream(InputLayoutHandle inputLayoutHandle);
+
+		//triangle indices into the layout's vertex buffer, one buffer per layout, stored as u16 when every index fits
+		InputBufferHandle createIndexBuffer(InputLayoutHandle inputLayoutHandle, const std::vector<u32>& indices);
+		//draws indexCount indices from firstIndex for instanceCount instances, each index counting from baseVertex
+		//the layout must be bound
+		void drawIndexed(InputLayoutHandle inputLayoutHandle, GLenum mode, uSize firstIndex, uSize indexCount, GLint baseVertex, uSize instanceCount);
+
 	private:
 
 		struct LayoutState
 		{
 			Visual::InputLayout layout;
 			std::vector<GLuint> VBO{};
+			Visual::InputLayout instanceLayout{};
+			GLuint instanceVBO = 0;
+			GLuint streamVBO = 0;
+			uSize streamCapacity = 0; //bytes
+			uSize streamOffset = 0; //bytes written since the storage was last orphaned
+			GLuint indexVBO = 0;
+			GLenum indexType = GL_UNSIGNED_INT;
 		};
 
 		std::map<GLuint, LayoutState> VAOStates;
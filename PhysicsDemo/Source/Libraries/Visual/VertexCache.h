@@ -0,0 +1,144 @@
+#pragma once
+
+#include "VisualDebug.h"
+
+#include "Platform/PlatformCore.h"
+
+#include <vector>
+
+namespace jm::Visual
+{
+	//reorders triangles so their vertices are still in a post transform cache of cacheSize entries when they are reused (tipsify)
+	//the generators in VisualGeometry.cpp already apply it, the triangles and their winding are unchanged
+	inline void OptimizeVertexCache(std::vector<u32>& indices, size_t vertexCount, size_t cacheSize = 16)
+	{
+		JM_VISUAL_ASSERT(indices.size() % 3 == 0);
+
+		//the triangles around each vertex, packed one vertex after another
+		std::vector<size_t> firstTriangle(vertexCount + 1, 0);
+		for (u32 index : indices)
+		{
+			JM_VISUAL_ASSERT(index < vertexCount);
+			++firstTriangle[index + 1];
+		}
+		for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			firstTriangle[vertex + 1] += firstTriangle[vertex];
+		}
+		std::vector<size_t> vertexTriangles(indices.size());
+		{
+			std::vector<size_t> next(firstTriangle.begin(), firstTriangle.end() - 1);
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				vertexTriangles[next[indices[i]]++] = i / 3;
+			}
+		}
+
+		std::vector<size_t> liveTriangles(vertexCount);
+		for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			liveTriangles[vertex] = firstTriangle[vertex + 1] - firstTriangle[vertex];
+		}
+		std::vector<size_t> cacheTime(vertexCount, 0);
+		std::vector<bool> emitted(indices.size() / 3, false);
+		std::vector<u32> deadEnds;
+		std::vector<u32> candidates;
+		std::vector<u32> reordered;
+		reordered.reserve(indices.size());
+
+		//a vertex is in the cache while fewer than cacheSize vertices have entered it since
+		size_t time = cacheSize + 1;
+		size_t cursor = 0;
+		size_t fanning = 0;
+		while (fanning != vertexCount)
+		{
+			//emit every triangle left around the fanning vertex
+			candidates.clear();
+			for (size_t t = firstTriangle[fanning]; t < firstTriangle[fanning + 1]; ++t)
+			{
+				const size_t triangle = vertexTriangles[t];
+				if (emitted[triangle])
+				{
+					continue;
+				}
+				emitted[triangle] = true;
+
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const u32 vertex = indices[3 * triangle + corner];
+					reordered.push_back(vertex);
+					deadEnds.push_back(vertex);
+					candidates.push_back(vertex);
+					--liveTriangles[vertex];
+					if (time - cacheTime[vertex] > cacheSize)
+					{
+						cacheTime[vertex] = time++;
+					}
+				}
+			}
+
+			//fan around the oldest candidate that is still cached once its own triangles are emitted
+			fanning = vertexCount;
+			size_t bestPriority = 0;
+			for (u32 vertex : candidates)
+			{
+				if (liveTriangles[vertex] == 0)
+				{
+					continue;
+				}
+				const size_t age = time - cacheTime[vertex];
+				const size_t priority = age + 2 * liveTriangles[vertex] <= cacheSize ? age : 0;
+				if (fanning == vertexCount || priority > bestPriority)
+				{
+					fanning = vertex;
+					bestPriority = priority;
+				}
+			}
+
+			//otherwise the latest vertex emitted that has triangles left, then the next one in index order
+			while (fanning == vertexCount && !deadEnds.empty())
+			{
+				const u32 vertex = deadEnds.back();
+				deadEnds.pop_back();
+				if (liveTriangles[vertex] != 0)
+				{
+					fanning = vertex;
+				}
+			}
+			while (fanning == vertexCount && cursor < vertexCount)
+			{
+				if (liveTriangles[cursor] != 0)
+				{
+					fanning = cursor;
+				}
+				++cursor;
+			}
+		}
+
+		JM_VISUAL_ASSERT(reordered.size() == indices.size());
+		indices = std::move(reordered);
+	}
+
+	//vertices transformed per triangle drawn through a first in first out cache of cacheSize entries, 3 when nothing is reused
+	inline f32 GetAverageCacheMissRatio(std::vector<u32> const& indices, size_t vertexCount, size_t cacheSize = 16)
+	{
+		if (indices.empty())
+		{
+			return 0.f;
+		}
+
+		//same clock as OptimizeVertexCache, a vertex is cached while fewer than cacheSize misses have happened since its own
+		std::vector<size_t> cacheTime(vertexCount, 0);
+		size_t time = cacheSize + 1;
+		size_t misses = 0;
+		for (u32 vertex : indices)
+		{
+			if (time - cacheTime[vertex] > cacheSize)
+			{
+				cacheTime[vertex] = time++;
+				++misses;
+			}
+		}
+		return static_cast<f32>(misses) / static_cast<f32>(indices.size() / 3);
+	}
+}
@@ -4,6 +4,8 @@
 
 #include "RenderingContext.h"
 
+#include <algorithm>
+
 namespace jm::Visual
 {
 	GLuint CompileShader(GLenum shaderType, const GLchar* sourceString)
@@ -73,6 +75,8 @@ namespace jm::Visual
 		glDeleteShader(vertexShader);
 		OpenGL::CheckError();
 
+		ReflectUniforms();
+
 		MakeActive();
 	}
 
@@ -88,6 +92,8 @@ namespace jm::Visual
 		glDeleteShader(fragmentShader);
 		OpenGL::CheckError();
 
+		ReflectUniforms();
+
 		MakeActive();
 	}
 
@@ -102,46 +108,84 @@ namespace jm::Visual
 		OpenGL::CheckError();
 	}
 
-	GLint LocateUniform(GLuint program, const GLchar* uniformName)
+	void ShaderProgram::ReflectUniforms()
 	{
-		GLint location = glGetUniformLocation(program, uniformName);
-		JM_VISUAL_ASSERT(location != -1, "No uniform location %s found!", uniformName);
+		GLint uniformCount = 0;
+		glGetProgramiv(programHandle, GL_ACTIVE_UNIFORMS, &uniformCount);
+		GLint maxNameLength = 0;
+		glGetProgramiv(programHandle, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+		std::vector<GLchar> name(std::max(maxNameLength, 1));
+		activeUniforms.reserve(uniformCount);
+		for (GLint u = 0; u < uniformCount; ++u)
+		{
+			GLsizei nameLength = 0;
+			GLint size = 0;
+			GLenum type = GL_NONE;
+			glGetActiveUniform(programHandle, (GLuint)u, (GLsizei)name.size(), &nameLength, &size, &type, name.data());
+
+			std::string uniformName(name.data(), nameLength);
+			if (uniformName.ends_with("[0]"))
+			{
+				uniformName.resize(uniformName.size() - 3);
+			}
+
+			//uniforms in blocks have no location and are set through their buffer
+			GLint location = glGetUniformLocation(programHandle, name.data());
+			if (location != -1)
+			{
+				activeUniforms.push_back({ std::move(uniformName), location, type });
+			}
+		}
 		OpenGL::CheckError();
-		return location;
 	}
 
-	void ShaderProgram::SetUniform(const GLchar* uniformName, GLfloat uniformValue) const
+	GLint ShaderProgram::FindUniform(const GLchar* uniformName, GLenum type) const
+	{
+		for (ActiveUniform const& uniform : activeUniforms)
+		{
+			if (uniform.name == uniformName)
+			{
+				JM_VISUAL_ASSERT(uniform.type == type, "Uniform %s is set with the wrong type!", uniformName);
+				return uniform.location;
+			}
+		}
+		JM_VISUAL_HALT("No uniform location %s found!", uniformName);
+		return -1;
+	}
+
+	void ShaderProgram::SetUniform(UniformHandle<GLfloat> uniform, GLfloat uniformValue) const
 	{
-		glUniform1f(LocateUniform(programHandle, uniformName), uniformValue);
+		glUniform1f(uniform.location, uniformValue);
 	}
 
-	void ShaderProgram::SetUniform(const GLchar* uniformName, GLint uniformValue) const
+	void ShaderProgram::SetUniform(UniformHandle<GLint> uniform, GLint uniformValue) const
 	{
-		glUniform1i(LocateUniform(programHandle, uniformName), uniformValue);
+		glUniform1i(uniform.location, uniformValue);
 	}
 
-	void ShaderProgram::SetUniform(const GLchar* uniformName, GLuint uniformValue) const
+	void ShaderProgram::SetUniform(UniformHandle<GLuint> uniform, GLuint uniformValue) const
 	{
-		glUniform1ui(LocateUniform(programHandle, uniformName), uniformValue);
+		glUniform1ui(uniform.location, uniformValue);
 	}
 
-	void ShaderProgram::SetUniform(const GLchar* uniformName, math::vector2<GLint> const& uniformValue) const
+	void ShaderProgram::SetUniform(UniformHandle<math::vector2<GLint>> uniform, math::vector2<GLint> const& uniformValue) const
 	{
-		glUniform2i(LocateUniform(programHandle, uniformName), uniformValue.x, uniformValue.y);
+		glUniform2i(uniform.location, uniformValue.x, uniformValue.y);
 	}
 
-	void ShaderProgram::SetUniform(const GLchar* uniformName, math::vector3<GLfloat> const& uniformValue) const
+	void ShaderProgram::SetUniform(UniformHandle<math::vector3<GLfloat>> uniform, math::vector3<GLfloat> const& uniformValue) const
 	{
-		glUniform3f(LocateUniform(programHandle, uniformName), uniformValue.x, uniformValue.y, uniformValue.z);
+		glUniform3f(uniform.location, uniformValue.x, uniformValue.y, uniformValue.z);
 	}
 
-	void ShaderProgram::SetUniform(const GLchar* uniformName, math::matrix33<GLfloat> const& uniformValue) const
+	void ShaderProgram::SetUniform(UniformHandle<math::matrix33<GLfloat>> uniform, math::matrix33<GLfloat> const& uniformValue) const
 	{
-		glUniformMatrix3fv(LocateUniform(programHandle, uniformName), 1, GL_FALSE, reinterpret_cast<const GLfloat*>(&uniformValue));
+		glUniformMatrix3fv(uniform.location, 1, GL_FALSE, reinterpret_cast<const GLfloat*>(&uniformValue));
 	}
 
-	void ShaderProgram::SetUniform(const GLchar* uniformName, math::matrix44<GLfloat> const& uniformValue) const
+	void ShaderProgram::SetUniform(UniformHandle<math::matrix44<GLfloat>> uniform, math::matrix44<GLfloat> const& uniformValue) const
 	{
-		glUniformMatrix4fv(LocateUniform(programHandle, uniformName), 1, GL_FALSE, reinterpret_cast<const GLfloat*>(&uniformValue));
+		glUniformMatrix4fv(uniform.location, 1, GL_FALSE, reinterpret_cast<const GLfloat*>(&uniformValue));
 	}
-}
\ No newline at end of file
+}
@@ -7,6 +7,7 @@
 #include "Platform/PlatformCore.h"
 #include "Platform/Timer.h"
 
+#include <string>
 #include <vector>
 
 namespace jm
@@ -31,6 +32,31 @@ namespace jm
 
 namespace jm::Visual
 {
+	//the GL type a uniform must be declared with to be set from T
+	template <typename T>
+	inline constexpr GLenum UniformType = GL_NONE;
+	template <>
+	inline constexpr GLenum UniformType<GLfloat> = GL_FLOAT;
+	template <>
+	inline constexpr GLenum UniformType<GLint> = GL_INT;
+	template <>
+	inline constexpr GLenum UniformType<GLuint> = GL_UNSIGNED_INT;
+	template <>
+	inline constexpr GLenum UniformType<math::vector2<GLint>> = GL_INT_VEC2;
+	template <>
+	inline constexpr GLenum UniformType<math::vector3<GLfloat>> = GL_FLOAT_VEC3;
+	template <>
+	inline constexpr GLenum UniformType<math::matrix33<GLfloat>> = GL_FLOAT_MAT3;
+	template <>
+	inline constexpr GLenum UniformType<math::matrix44<GLfloat>> = GL_FLOAT_MAT4;
+
+	//a uniform's location, looked up once from the program's reflected uniforms and only settable with a T
+	template <typename T>
+	struct UniformHandle
+	{
+		GLint location = -1; //GetUniform halts on a name the program does not use, release builds keep -1 and GL ignores the set
+	};
+
 	struct ShaderProgram
 	{
 		ShaderProgram(cstring vertexSource, std::vector<const GLchar*> varyingParameters);
@@ -39,16 +65,37 @@ namespace jm::Visual
 
 		void MakeActive() const;
 
-		void SetUniform(const GLchar* uniformName, GLfloat uniformValue) const;
-		void SetUniform(const GLchar* uniformName, GLint uniformValue) const;
-		void SetUniform(const GLchar* uniformName, GLuint uniformValue) const;
-		void SetUniform(const GLchar* uniformName, math::vector2<GLint> const& uniformValue) const;
-		void SetUniform(const GLchar* uniformName, math::vector3<GLfloat> const& uniformValue) const;
-		void SetUniform(const GLchar* uniformName, math::matrix33<GLfloat> const& uniformValue) const;
-		void SetUniform(const GLchar* uniformName, math::matrix44<GLfloat> const& uniformValue) const;
+		//resolves by name against the uniforms reflected at link time, hold the handle rather than calling this per draw
+		//the program has to use the uniform, a missing or unused one halts
+		template <typename T>
+		UniformHandle<T> GetUniform(const GLchar* uniformName) const
+		{
+			static_assert(UniformType<T> != GL_NONE, "No uniform type for T!");
+			return { FindUniform(uniformName, UniformType<T>) };
+		}
+
+		//the program must be active
+		void SetUniform(UniformHandle<GLfloat> uniform, GLfloat uniformValue) const;
+		void SetUniform(UniformHandle<GLint> uniform, GLint uniformValue) const;
+		void SetUniform(UniformHandle<GLuint> uniform, GLuint uniformValue) const;
+		void SetUniform(UniformHandle<math::vector2<GLint>> uniform, math::vector2<GLint> const& uniformValue) const;
+		void SetUniform(UniformHandle<math::vector3<GLfloat>> uniform, math::vector3<GLfloat> const& uniformValue) const;
+		void SetUniform(UniformHandle<math::matrix33<GLfloat>> uniform, math::matrix33<GLfloat> const& uniformValue) const;
+		void SetUniform(UniformHandle<math::matrix44<GLfloat>> uniform, math::matrix44<GLfloat> const& uniformValue) const;
 
 	private:
 
+		struct ActiveUniform
+		{
+			std::string name; //without the [0] GL appends to arrays
+			GLint location;
+			GLenum type;
+		};
+
+		void ReflectUniforms();
+		GLint FindUniform(const GLchar* uniformName, GLenum type) const;
+
 		const GLuint programHandle;
+		std::vector<ActiveUniform> activeUniforms;
 	};
-}
\ No newline at end of file
+}